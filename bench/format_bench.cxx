@@ -0,0 +1,86 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Caller-side cost of the stringstream path compared to eager and deferred formatting
+
+#include <string>
+#include <ut/format.hxx>
+#include <log.hxx>
+
+#include "harness.hxx"
+
+namespace bench
+{
+	static const ::std::size_t g_iterations = 200000;
+
+	static scenario g_format{ "format", [](::std::vector<result>& p_results)
+	{
+		const ::std::string t_name{ "request_handler" };
+
+		p_results.push_back(measure("format/stringstream", g_iterations, [&](::std::size_t p_i)
+		{
+			LOG_I() << "Handled request " << p_i << " in " << 0.125 * p_i << "ms by " << t_name;
+		}));
+
+		p_results.push_back(measure("format/eager_sprintf", g_iterations, [&](::std::size_t p_i)
+		{
+			LOG_I() << ut::sprintf("Handled request %s in %sms by %s", p_i, 0.125 * p_i, t_name);
+		}));
+
+		p_results.push_back(measure("format/deferred", g_iterations, [&](::std::size_t p_i)
+		{
+			LOG_I_FMT("Handled request %s in %sms by %s", p_i, 0.125 * p_i, t_name);
+		}));
+	}};
+
+	// Messages shorter than LIBLOG_INLINE_MESSAGE_SIZE are expected to cause no allocations at all
+	static scenario g_allocations{ "allocations", [](::std::vector<result>& p_results)
+	{
+		p_results.push_back(measure("allocations/small_message", g_iterations, [](::std::size_t p_i)
+		{
+			LOG_I() << "Small message " << p_i << " with a double " << 3.5 << " and a char " << 'x';
+		}));
+
+		p_results.push_back(measure("allocations/large_message", g_iterations, [](::std::size_t p_i)
+		{
+			LOG_I() << ::std::string(LIBLOG_INLINE_MESSAGE_SIZE + 1, 'x') << p_i;
+		}));
+	}};
+
+	// Tags are interned once per call site, a disabled tag skips the whole statement
+	static scenario g_tags{ "tags", [](::std::vector<result>& p_results)
+	{
+		p_results.push_back(measure("tags/enabled", g_iterations, [](::std::size_t p_i)
+		{
+			LOG_I_TAG("bench") << "Tagged message " << p_i;
+		}));
+
+		p_results.push_back(measure("tags/runtime", g_iterations, [](::std::size_t p_i)
+		{
+			LOG_I() << lg::tag("bench") << "Tagged message " << p_i;
+		}));
+
+		// Nothing reaches the target, so there is no worker to wait for
+		lg::disable_tag("bench_off");
+
+		const auto t_begin = clock_type::now();
+
+		for(::std::size_t t_i = 0; t_i < g_iterations; ++t_i)
+			LOG_I_TAG("bench_off") << "Tagged message " << t_i;
+
+		const auto t_ns = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(clock_type::now() - t_begin).count();
+		p_results.push_back(result{ "tags/disabled", g_iterations, static_cast<double>(t_ns) / g_iterations, 0.0 });
+	}};
+}
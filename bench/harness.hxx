@@ -0,0 +1,227 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <log.hxx>
+
+namespace bench
+{
+	using clock_type = ::std::chrono::steady_clock;
+
+	// Result of a single benchmark case
+	struct result
+	{
+		::std::string m_Name;			//< Name of the benchmark case
+		::std::size_t m_Iterations;		//< Number of measured calls
+		double m_NsPerCall;				//< Average caller-side cost of one call
+		double m_AllocsPerCall;			//< Average number of heap allocations per call on the calling thread
+		double m_Throughput{0.0};		//< Entries per second, if measured
+		double m_P50{0.0};				//< Latency percentiles of single calls in nanoseconds, if measured
+		double m_P99{0.0};
+		double m_P999{0.0};
+		::std::vector<::std::pair<::std::string, double>> m_Extra{ };	//< Scenario specific values
+	};
+
+	// Number of heap allocations performed by the calling thread so far
+	auto allocations()
+		-> ::std::size_t;
+
+	// Log target that only counts the entries it receives
+	class counting_target
+		: public lg::log_target
+	{
+		public:
+			counting_target()
+				: log_target(lg::severity_level::debug)
+			{
+			}
+
+		public:
+			virtual void write(const lg::log_entry&) override
+			{
+				m_Count.fetch_add(1, ::std::memory_order_relaxed);
+			}
+
+		public:
+			auto count() const
+				-> ::std::size_t
+			{
+				return m_Count.load(::std::memory_order_relaxed);
+			}
+
+			// Block until given number of entries were received in total
+			auto wait_for(::std::size_t p_count) const
+				-> void
+			{
+				while(count() < p_count)
+					::std::this_thread::yield();
+			}
+
+		private:
+			::std::atomic<::std::size_t> m_Count{0};
+	};
+
+	// Target all benchmark cases log to
+	auto target()
+		-> counting_target&;
+
+	// Measure caller-side cost of given logging function. The function is called
+	// in chunks. Between chunks, the harness waits for the worker thread to catch up,
+	// which is not part of the measurement.
+	template< typename F >
+	auto measure(const ::std::string& p_name, ::std::size_t p_iterations, F&& p_func)
+		-> result
+	{
+		const ::std::size_t t_chunk = 4096;
+		clock_type::duration t_total{ };
+		::std::size_t t_allocations{ };
+
+		for(::std::size_t t_done = 0; t_done < p_iterations; t_done += t_chunk)
+		{
+			const auto t_expected = target().count() + t_chunk;
+			const auto t_allocBegin = allocations();
+			const auto t_begin = clock_type::now();
+
+			for(::std::size_t t_i = 0; t_i < t_chunk; ++t_i)
+				p_func(t_done + t_i);
+
+			t_total += clock_type::now() - t_begin;
+			t_allocations += allocations() - t_allocBegin;
+			target().wait_for(t_expected);
+		}
+
+		const auto t_iterations = ((p_iterations + t_chunk - 1) / t_chunk) * t_chunk;
+		const auto t_ns = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(t_total).count();
+
+		return {
+			p_name,
+			t_iterations,
+			static_cast<double>(t_ns) / t_iterations,
+			static_cast<double>(t_allocations) / t_iterations
+		};
+	}
+
+	// Measure the cost of every single call of given logging function and report
+	// latency percentiles. Like measure(), the worker thread is allowed to catch up
+	// between chunks. Clock reads are included in the numbers.
+	template< typename F >
+	auto measure_latency(const ::std::string& p_name, ::std::size_t p_iterations, F&& p_func)
+		-> result
+	{
+		const ::std::size_t t_chunk = 4096;
+		const auto t_iterations = ((p_iterations + t_chunk - 1) / t_chunk) * t_chunk;
+		
+		// Reserved up front, so that storing samples does not allocate
+		::std::vector<::std::int64_t> t_samples(t_iterations);
+		::std::int64_t t_total{ };
+		
+		for(::std::size_t t_done = 0; t_done < t_iterations; t_done += t_chunk)
+		{
+			const auto t_expected = target().count() + t_chunk;
+			
+			for(::std::size_t t_i = 0; t_i < t_chunk; ++t_i)
+			{
+				const auto t_begin = clock_type::now();
+				p_func(t_done + t_i);
+				const auto t_ns = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(clock_type::now() - t_begin).count();
+				
+				t_samples[t_done + t_i] = t_ns;
+				t_total += t_ns;
+			}
+			
+			target().wait_for(t_expected);
+		}
+		
+		::std::sort(t_samples.begin(), t_samples.end());
+		
+		const auto t_percentile = [&t_samples](double p_p)
+		{
+			return static_cast<double>(t_samples[static_cast<::std::size_t>(p_p * (t_samples.size() - 1))]);
+		};
+		
+		result t_result{ p_name, t_iterations, static_cast<double>(t_total) / t_iterations, 0.0 };
+		t_result.m_P50 = t_percentile(0.5);
+		t_result.m_P99 = t_percentile(0.99);
+		t_result.m_P999 = t_percentile(0.999);
+		t_result.m_Extra.emplace_back("max_ns", static_cast<double>(t_samples.back()));
+		
+		return t_result;
+	}
+	
+	// Measure end-to-end throughput: given number of producer threads each call given
+	// logging function, and the clock stops once the benchmark target received all entries.
+	template< typename F >
+	auto measure_throughput(const ::std::string& p_name, ::std::size_t p_producers, ::std::size_t p_perProducer, F&& p_func)
+		-> result
+	{
+		const auto t_expected = target().count() + p_producers * p_perProducer;
+		
+		::std::atomic<bool> t_go{false};
+		::std::atomic<::std::int64_t> t_callerNs{0};
+		::std::vector<::std::thread> t_threads{ };
+		
+		for(::std::size_t t_p = 0; t_p < p_producers; ++t_p)
+		{
+			t_threads.emplace_back([&]()
+			{
+				while(!t_go.load())
+					::std::this_thread::yield();
+					
+				const auto t_begin = clock_type::now();
+				
+				for(::std::size_t t_i = 0; t_i < p_perProducer; ++t_i)
+					p_func(t_i);
+					
+				t_callerNs += ::std::chrono::duration_cast<::std::chrono::nanoseconds>(clock_type::now() - t_begin).count();
+			});
+		}
+		
+		const auto t_begin = clock_type::now();
+		t_go.store(true);
+		
+		for(auto& t_thread : t_threads)
+			t_thread.join();
+			
+		target().wait_for(t_expected);
+		
+		const auto t_seconds = ::std::chrono::duration<double>(clock_type::now() - t_begin).count();
+		const auto t_iterations = p_producers * p_perProducer;
+		
+		result t_result{ p_name, t_iterations, static_cast<double>(t_callerNs.load()) / t_iterations, 0.0 };
+		t_result.m_Throughput = t_iterations / t_seconds;
+		t_result.m_Extra.emplace_back("producers", static_cast<double>(p_producers));
+		
+		return t_result;
+	}
+
+	using scenario_type = ::std::function<void(::std::vector<result>&)>;
+
+	// Registers a benchmark scenario at static initialization time
+	struct scenario
+	{
+		scenario(const ::std::string& p_name, scenario_type p_func);
+	};
+}
@@ -0,0 +1,180 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// log_bench: Measures the cost of the liblog hot paths.
+// Usage: log_bench [--json] [scenario filter]
+// With --json, results are written to standard output as a JSON document,
+// which allows comparing library versions.
+
+#include <map>
+#include <new>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <log.hxx>
+
+#include "harness.hxx"
+
+namespace bench
+{
+	thread_local ::std::size_t t_allocations{0};
+
+	auto allocations()
+		-> ::std::size_t
+	{
+		return t_allocations;
+	}
+
+	auto scenarios()
+		-> ::std::map<::std::string, scenario_type>&
+	{
+		static ::std::map<::std::string, scenario_type> t_scenarios{ };
+		return t_scenarios;
+	}
+
+	scenario::scenario(const ::std::string& p_name, scenario_type p_func)
+	{
+		scenarios()[p_name] = ::std::move(p_func);
+	}
+
+	auto target()
+		-> counting_target&
+	{
+		static counting_target t_target{ };
+		return t_target;
+	}
+}
+
+// Count all heap allocations of the calling thread
+void* operator new(::std::size_t p_size)
+{
+	++bench::t_allocations;
+
+	if(void* t_ptr = ::std::malloc(p_size ? p_size : 1))
+		return t_ptr;
+
+	throw ::std::bad_alloc{ };
+}
+
+void operator delete(void* p_ptr) noexcept
+{
+	::std::free(p_ptr);
+}
+
+void operator delete(void* p_ptr, ::std::size_t) noexcept
+{
+	::std::free(p_ptr);
+}
+
+namespace
+{
+	// Names only contain plain characters, but quotes and backslashes are escaped anyway
+	auto json_string(const ::std::string& p_str)
+		-> ::std::string
+	{
+		::std::string t_str{ "\"" };
+		
+		for(const auto t_c : p_str)
+		{
+			if(t_c == '"' || t_c == '\\')
+				t_str.push_back('\\');
+				
+			t_str.push_back(t_c);
+		}
+		
+		t_str.push_back('"');
+		return t_str;
+	}
+
+	auto print_json(const ::std::vector<bench::result>& p_results)
+		-> void
+	{
+		::std::printf("{\n\t\"library\": \"liblog\",\n\t\"timestamp\": %lld,\n\t\"results\": [\n",
+			static_cast<long long>(::std::time(nullptr)));
+			
+		for(::std::size_t t_i = 0; t_i < p_results.size(); ++t_i)
+		{
+			const auto& t_result = p_results[t_i];
+		
+			::std::printf("\t\t{ \"name\": %s, \"iterations\": %zu, \"ns_per_call\": %.2f, \"allocs_per_call\": %.3f, "
+				"\"throughput\": %.1f, \"p50_ns\": %.1f, \"p99_ns\": %.1f, \"p999_ns\": %.1f",
+				json_string(t_result.m_Name).c_str(), t_result.m_Iterations, t_result.m_NsPerCall, t_result.m_AllocsPerCall,
+				t_result.m_Throughput, t_result.m_P50, t_result.m_P99, t_result.m_P999);
+				
+			for(const auto& t_extra : t_result.m_Extra)
+				::std::printf(", %s: %.2f", json_string(t_extra.first).c_str(), t_extra.second);
+				
+			::std::printf(" }%s\n", (t_i + 1 < p_results.size()) ? "," : "");
+		}
+		
+		::std::printf("\t]\n}\n");
+	}
+	
+	auto print_table(const ::std::vector<bench::result>& p_results)
+		-> void
+	{
+		for(const auto& t_result : p_results)
+		{
+			::std::printf("%-40s %10zu iterations %12.1f ns/call %8.2f allocs/call",
+				t_result.m_Name.c_str(), t_result.m_Iterations, t_result.m_NsPerCall, t_result.m_AllocsPerCall);
+				
+			if(t_result.m_Throughput > 0.0)
+				::std::printf(" %12.0f entries/s", t_result.m_Throughput);
+				
+			if(t_result.m_P50 > 0.0)
+				::std::printf(" p50 %.0f p99 %.0f p99.9 %.0f ns", t_result.m_P50, t_result.m_P99, t_result.m_P999);
+				
+			for(const auto& t_extra : t_result.m_Extra)
+				::std::printf(" %s=%.2f", t_extra.first.c_str(), t_extra.second);
+				
+			::std::printf("\n");
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	::std::string t_filter{ };
+	bool t_json{false};
+	
+	for(int t_i = 1; t_i < argc; ++t_i)
+	{
+		if(::std::strcmp(argv[t_i], "--json") == 0)
+			t_json = true;
+		else t_filter = argv[t_i];
+	}
+
+	lg::logger::add_target(&bench::target());
+
+	// Use ring buffers to keep lock contention out of the caller-side measurements
+	lg::logger::use_ring_buffers(1 << 14, lg::overflow_policy::block);
+
+	::std::vector<bench::result> t_results{ };
+
+	for(auto& t_scenario : bench::scenarios())
+	{
+		if(t_scenario.first.find(t_filter) != ::std::string::npos)
+			t_scenario.second(t_results);
+	}
+
+	lg::logger::shutdown();
+
+	if(t_json)
+		print_json(t_results);
+	else print_table(t_results);
+
+	return 0;
+}
@@ -0,0 +1,546 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Cost of the formatters and throughput of the file, network and UNIX datagram targets.
+// Targets are fed prepared batches directly, so the logger itself is not part of these numbers.
+// The burst scenario shows how lane backlogs grow if entries arrive faster than a target writes them.
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <log.hxx>
+
+#if !defined(_WIN32)
+#	include <unistd.h>
+#	include <netinet/in.h>
+#	include <arpa/inet.h>
+#	include <sys/un.h>
+#	include <sys/socket.h>
+#endif
+
+#include "harness.hxx"
+
+namespace bench
+{
+	namespace
+	{
+		const ::std::size_t g_entries = 50000;
+		const ::std::size_t g_batchSize = 256;
+	
+		// Tagged entries with a typical mix of text and numbers. They are rendered and timestamped
+		// up front, so that the benchmarks only measure the targets.
+		class prepared_batch
+		{
+			public:
+				prepared_batch(::std::size_t p_count)
+				{
+					m_Entries.reserve(p_count);
+					
+					for(::std::size_t t_i = 0; t_i < p_count; ++t_i)
+					{
+						m_Entries.push_back(lg::log_entry(LOG_SITE_BASE(info, bright_white, false))
+							<< lg::tag("bench") << "Target benchmark entry " << t_i << " with a double " << 0.25 * t_i);
+						
+						m_Entries.back().prepare();
+					}
+					
+					for(const auto& t_entry : m_Entries)
+						m_Pointers.push_back(&t_entry);
+				}
+				
+			public:
+				auto size() const
+					-> ::std::size_t
+				{
+					return m_Entries.size();
+				}
+				
+				auto span(::std::size_t p_offset, ::std::size_t p_count) const
+					-> lg::entry_span
+				{
+					return { m_Pointers.data() + p_offset, ::std::min(p_count, m_Pointers.size() - p_offset) };
+				}
+				
+			private:
+				::std::vector<lg::log_entry> m_Entries;
+				::std::vector<const lg::log_entry*> m_Pointers;
+		};
+		
+		auto batch()
+			-> const prepared_batch&
+		{
+			static const prepared_batch t_batch{ g_entries };
+			return t_batch;
+		}
+		
+		// Feed all prepared entries to given target in batches
+		auto feed(const ::std::string& p_name, lg::log_target& p_target)
+			-> result
+		{
+			const auto& t_batch = batch();
+			const auto t_begin = clock_type::now();
+			
+			for(::std::size_t t_i = 0; t_i < t_batch.size(); t_i += g_batchSize)
+				p_target.write_batch(t_batch.span(t_i, g_batchSize));
+				
+			const auto t_seconds = ::std::chrono::duration<double>(clock_type::now() - t_begin).count();
+			
+			result t_result{ p_name, t_batch.size(), t_seconds * 1e9 / t_batch.size(), 0.0 };
+			t_result.m_Throughput = t_batch.size() / t_seconds;
+			return t_result;
+		}
+		
+		auto add_rate(result& p_result, double p_bytes)
+			-> void
+		{
+			const auto t_seconds = p_result.m_Iterations / p_result.m_Throughput;
+			p_result.m_Extra.emplace_back("mb_per_s", p_bytes / t_seconds / (1024.0 * 1024.0));
+		}
+		
+		auto file_size(const ::std::string& p_path)
+			-> double
+		{
+			::std::FILE* t_file = ::std::fopen(p_path.c_str(), "rb");
+			
+			if(t_file == nullptr)
+				return 0.0;
+				
+			::std::fseek(t_file, 0, SEEK_END);
+			const auto t_size = ::std::ftell(t_file);
+			::std::fclose(t_file);
+			
+			return static_cast<double>(t_size);
+		}
+	}
+	
+	// Layout equivalent to the default formatter, parsed at compile time
+	constexpr char g_pattern[] = "[%T] %C%L%R| %m%F";
+
+	static scenario g_formatters{ "formatters", [](::std::vector<result>& p_results)
+	{
+		const auto t_run = [&p_results](const ::std::string& p_name, auto p_formatter)
+		{
+			const auto& t_batch = batch();
+			lg::internal::buffer_stream t_buffer{ };
+			::std::size_t t_bytes{ };
+			
+			const auto t_begin = clock_type::now();
+			
+			for(::std::size_t t_i = 0; t_i < t_batch.size(); ++t_i)
+			{
+				t_buffer.clear_buffer();
+				p_formatter(t_buffer, t_batch.span(t_i, 1)[0]);
+				t_bytes += t_buffer.size();
+			}
+			
+			const auto t_seconds = ::std::chrono::duration<double>(clock_type::now() - t_begin).count();
+			
+			result t_result{ p_name, t_batch.size(), t_seconds * 1e9 / t_batch.size(), 0.0 };
+			t_result.m_Throughput = t_batch.size() / t_seconds;
+			t_result.m_Extra.emplace_back("bytes_per_entry", static_cast<double>(t_bytes) / t_batch.size());
+			p_results.push_back(t_result);
+		};
+		
+		t_run("formatters/default", lg::default_formatter{ });
+		t_run("formatters/default_microseconds", lg::default_formatter{ lg::time_precision::microseconds });
+		t_run("formatters/clang", lg::clang_formatter{ });
+		t_run("formatters/json", lg::json_formatter{ });
+		t_run("formatters/pattern", lg::pattern_formatter<g_pattern>{ });
+		t_run("formatters/pattern_microseconds", lg::pattern_formatter<g_pattern>{ lg::time_precision::microseconds });
+	}};
+	
+	static scenario g_file{ "file", [](::std::vector<result>& p_results)
+	{
+		const ::std::string t_path{ "log_bench_file.log" };
+		
+		{
+			lg::file_target<> t_target{ lg::severity_level::debug, t_path, false };
+			p_results.push_back(feed("file/file_target", t_target));
+		}
+		
+		add_rate(p_results.back(), file_size(t_path));
+		p_results.back().m_Extra.emplace_back("bytes_per_entry", file_size(t_path) / p_results.back().m_Iterations);
+		::std::remove(t_path.c_str());
+		
+		// Binary records keep more information than the text, the size includes the index
+		const ::std::string t_index{ t_path + ".idx" };
+		
+		{
+			lg::binary_file_target t_target{ lg::severity_level::debug, t_path };
+			p_results.push_back(feed("file/binary_file_target", t_target));
+		}
+		
+		const auto t_binary = file_size(t_path) + file_size(t_index);
+		add_rate(p_results.back(), t_binary);
+		p_results.back().m_Extra.emplace_back("bytes_per_entry", t_binary / p_results.back().m_Iterations);
+		::std::remove(t_path.c_str());
+		::std::remove(t_index.c_str());
+		
+		// Compression runs on a helper thread, the stats are taken once all blocks were written
+		lg::compression_stats t_stats{ };
+		
+		{
+			lg::compressed_file_target<> t_target{ lg::severity_level::debug, t_path };
+			p_results.push_back(feed("file/compressed_file_target", t_target));
+			t_target.flush();
+			t_stats = t_target.stats();
+		}
+		
+		add_rate(p_results.back(), file_size(t_path));
+		p_results.back().m_Extra.emplace_back("bytes_per_entry", file_size(t_path) / p_results.back().m_Iterations);
+		p_results.back().m_Extra.emplace_back("ratio", t_stats.ratio());
+		p_results.back().m_Extra.emplace_back("compress_mb_per_s", t_stats.throughput() / (1024.0 * 1024.0));
+		::std::remove(t_path.c_str());
+		
+#if !defined(_WIN32)
+		const ::std::string t_segment{ t_path + ".000000" };
+		
+		{
+			lg::mmap_file_target<> t_target{ lg::severity_level::debug, t_path };
+			p_results.push_back(feed("file/mmap_file_target", t_target));
+		}
+		
+		add_rate(p_results.back(), file_size(t_segment));
+		::std::remove(t_segment.c_str());
+#endif
+	}};
+	
+#if !defined(_WIN32)
+	namespace
+	{
+		// Loopback server that accepts one connection and counts the received bytes
+		class loopback_sink
+		{
+			public:
+				loopback_sink()
+				{
+					m_Listener = ::socket(AF_INET, SOCK_STREAM, 0);
+					
+					sockaddr_in t_addr{ };
+					t_addr.sin_family = AF_INET;
+					t_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+					t_addr.sin_port = 0;
+					
+					socklen_t t_len = sizeof(t_addr);
+					::bind(m_Listener, reinterpret_cast<sockaddr*>(&t_addr), sizeof(t_addr));
+					::listen(m_Listener, 1);
+					::getsockname(m_Listener, reinterpret_cast<sockaddr*>(&t_addr), &t_len);
+					
+					m_Port = ::std::to_string(ntohs(t_addr.sin_port));
+					
+					m_Thread = ::std::thread{ [this]()
+					{
+						const int t_conn = ::accept(m_Listener, nullptr, nullptr);
+						char t_buffer[64 * 1024];
+						
+						while(true)
+						{
+							const auto t_read = ::read(t_conn, t_buffer, sizeof(t_buffer));
+							
+							if(t_read <= 0)
+								break;
+								
+							m_Bytes += static_cast<::std::size_t>(t_read);
+						}
+						
+						::close(t_conn);
+					}};
+				}
+				
+				~loopback_sink()
+				{
+					if(m_Thread.joinable())
+						m_Thread.join();
+						
+					::close(m_Listener);
+				}
+				
+			public:
+				auto port() const
+					-> const ::std::string&
+				{
+					return m_Port;
+				}
+				
+				// Wait until the connection was closed and return number of received bytes
+				auto finish()
+					-> double
+				{
+					m_Thread.join();
+					return static_cast<double>(m_Bytes.load());
+				}
+				
+			private:
+				int m_Listener{-1};
+				::std::string m_Port;
+				::std::atomic<::std::size_t> m_Bytes{0};
+				::std::thread m_Thread;
+		};
+		
+		// Receiver bound to a UNIX datagram socket that counts the received datagrams and bytes
+		class unix_sink
+		{
+			public:
+				unix_sink(const ::std::string& p_path)
+					: m_Path{p_path}
+				{
+					::unlink(p_path.c_str());
+					m_Socket = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+					
+					sockaddr_un t_addr{ };
+					t_addr.sun_family = AF_UNIX;
+					::std::strncpy(t_addr.sun_path, p_path.c_str(), sizeof(t_addr.sun_path) - 1);
+					
+					::bind(m_Socket, reinterpret_cast<sockaddr*>(&t_addr), sizeof(t_addr));
+					
+					m_Thread = ::std::thread{ [this]()
+					{
+						::std::vector<char> t_buffer(1u << 20);
+						
+						while(true)
+						{
+							const auto t_read = ::recv(m_Socket, t_buffer.data(), t_buffer.size(), 0);
+							
+							if(t_read <= 0)
+								break;
+								
+							m_Bytes += static_cast<::std::size_t>(t_read);
+							++m_Datagrams;
+						}
+					}};
+				}
+				
+				~unix_sink()
+				{
+					// Wakes up the receiving thread
+					::shutdown(m_Socket, SHUT_RDWR);
+					m_Thread.join();
+					
+					::close(m_Socket);
+					::unlink(m_Path.c_str());
+				}
+				
+			public:
+				// Wait until given number of datagrams arrived and return number of received bytes
+				auto finish(::std::uint64_t p_datagrams)
+					-> double
+				{
+					while(m_Datagrams.load() < p_datagrams)
+						::std::this_thread::yield();
+						
+					return static_cast<double>(m_Bytes.load());
+				}
+				
+			private:
+				::std::string m_Path;
+				int m_Socket{-1};
+				::std::atomic<::std::size_t> m_Bytes{0};
+				::std::atomic<::std::uint64_t> m_Datagrams{0};
+				::std::thread m_Thread;
+		};
+	}
+	
+	static scenario g_network{ "network", [](::std::vector<result>& p_results)
+	{
+		const auto t_blocking = [&p_results](const ::std::string& p_name, const lg::protocol_options& p_protocol)
+		{
+			loopback_sink t_sink{ };
+			
+			{
+				lg::network_target t_target{ lg::severity_level::debug, "127.0.0.1", t_sink.port(), "bench", p_protocol };
+				p_results.push_back(feed(p_name, t_target));
+			}
+			
+			add_rate(p_results.back(), t_sink.finish());
+		};
+		
+		const auto t_async = [&p_results](const ::std::string& p_name, const lg::protocol_options& p_protocol)
+		{
+			loopback_sink t_sink{ };
+			
+			lg::async_network_options t_options{ };
+			t_options.m_Protocol = p_protocol;
+			t_options.m_MaxBufferedBytes = 64u << 20;
+			t_options.m_ShutdownTimeout = ::std::chrono::seconds{10};
+			
+			{
+				lg::async_network_target t_target{ lg::severity_level::debug, "127.0.0.1", t_sink.port(), "bench", t_options };
+				
+				while(!t_target.connected())
+					::std::this_thread::yield();
+			
+				// Measure until everything was handed to the socket
+				const auto t_begin = clock_type::now();
+				const auto t_fed = feed(p_name, t_target);
+				
+				while(t_target.buffered() > 0)
+					::std::this_thread::yield();
+					
+				const auto t_seconds = ::std::chrono::duration<double>(clock_type::now() - t_begin).count();
+					
+				p_results.push_back(t_fed);
+				p_results.back().m_Throughput = t_fed.m_Iterations / t_seconds;
+				p_results.back().m_Extra.emplace_back("dropped", static_cast<double>(t_target.dropped()));
+			}
+			
+			add_rate(p_results.back(), t_sink.finish());
+		};
+		
+		lg::protocol_options t_v1{ };
+		
+		lg::protocol_options t_v2{ };
+		t_v2.m_Version = lg::protocol_version::v2;
+		
+		lg::protocol_options t_v2Compressed{ t_v2 };
+		t_v2Compressed.m_Compress = true;
+		
+		t_blocking("network/network_target_v1", t_v1);
+		t_blocking("network/network_target_v2", t_v2);
+		t_blocking("network/network_target_v2_compressed", t_v2Compressed);
+		t_async("network/async_network_target_v2", t_v2);
+		t_async("network/async_network_target_v2_compressed", t_v2Compressed);
+	}};
+	
+	static scenario g_unix{ "unix", [](::std::vector<result>& p_results)
+	{
+		// A non-blocking target drops whatever the receiver has no room for
+		const auto t_run = [&p_results](const ::std::string& p_name, lg::protocol_version p_version, bool p_nonBlocking)
+		{
+			unix_sink t_sink{ "log_bench.sock" };
+			
+			lg::unix_datagram_options t_options{ };
+			t_options.m_Protocol.m_Version = p_version;
+			t_options.m_NonBlocking = p_nonBlocking;
+			
+			lg::unix_datagram_target t_target{ lg::severity_level::debug, "log_bench.sock", "bench", t_options };
+			p_results.push_back(feed(p_name, t_target));
+			
+			add_rate(p_results.back(), t_sink.finish(t_target.sent()));
+			p_results.back().m_Extra.emplace_back("datagrams", static_cast<double>(t_target.sent()));
+			p_results.back().m_Extra.emplace_back("dropped", static_cast<double>(t_target.dropped()));
+		};
+		
+		t_run("unix/unix_datagram_target_v1", lg::protocol_version::v1, false);
+		t_run("unix/unix_datagram_target_v2", lg::protocol_version::v2, false);
+		t_run("unix/unix_datagram_target_v2_nonblocking", lg::protocol_version::v2, true);
+	}};
+#endif
+	
+	namespace
+	{
+		// Target that spends a fixed amount of time on every entry while enabled
+		class throttled_target
+			: public lg::log_target
+		{
+			public:
+				throttled_target()
+					: log_target(lg::severity_level::debug)
+				{
+				}
+				
+			public:
+				virtual void write(const lg::log_entry&) override
+				{
+					if(!m_Enabled.load())
+						return;
+						
+					const auto t_end = clock_type::now() + ::std::chrono::microseconds{2};
+					
+					while(clock_type::now() < t_end);
+				}
+				
+			public:
+				auto enable(bool p_enabled)
+					-> void
+				{
+					m_Enabled.store(p_enabled);
+				}
+				
+			private:
+				::std::atomic<bool> m_Enabled{false};
+		};
+	}
+	
+	static scenario g_burst{ "burst", [](::std::vector<result>& p_results)
+	{
+		static throttled_target t_target{ };
+		
+		lg::logger::add_target(&t_target, "burst");
+		t_target.enable(true);
+		
+		const ::std::size_t t_count = 200000;
+		const auto t_expected = target().count() + t_count;
+		
+		// Sample the backlog of the throttled lane while the burst is processed
+		::std::atomic<bool> t_done{false};
+		::std::size_t t_peak{0};
+		
+		::std::thread t_monitor{ [&]()
+		{
+			while(!t_done.load())
+			{
+				for(const auto& t_lane : lg::logger::lanes())
+				{
+					if(t_lane.m_Name == "burst")
+						t_peak = ::std::max(t_peak, t_lane.m_Backlog);
+				}
+				
+				::std::this_thread::sleep_for(::std::chrono::milliseconds{1});
+			}
+		}};
+		
+		const auto t_begin = clock_type::now();
+		
+		for(::std::size_t t_i = 0; t_i < t_count; ++t_i)
+			LOG_I() << "Burst entry " << t_i;
+			
+		const auto t_produced = clock_type::now();
+		
+		// The burst is over once the throttled lane caught up
+		target().wait_for(t_expected);
+		
+		while(true)
+		{
+			const auto t_lanes = lg::logger::lanes();
+			
+			const auto t_it = ::std::find_if(t_lanes.begin(), t_lanes.end(), [](const lg::lane_info& p_lane)
+			{
+				return p_lane.m_Name == "burst";
+			});
+			
+			if(t_it == t_lanes.end() || t_it->m_Backlog == 0)
+				break;
+				
+			::std::this_thread::sleep_for(::std::chrono::milliseconds{1});
+		}
+		
+		const auto t_end = clock_type::now();
+		
+		t_done.store(true);
+		t_monitor.join();
+		t_target.enable(false);
+		
+		const auto t_producerSeconds = ::std::chrono::duration<double>(t_produced - t_begin).count();
+		const auto t_drainSeconds = ::std::chrono::duration<double>(t_end - t_produced).count();
+		
+		result t_result{ "burst/throttled_lane", t_count, t_producerSeconds * 1e9 / t_count, 0.0 };
+		t_result.m_Throughput = t_count / ::std::chrono::duration<double>(t_end - t_begin).count();
+		t_result.m_Extra.emplace_back("peak_backlog", static_cast<double>(t_peak));
+		t_result.m_Extra.emplace_back("drain_ms", t_drainSeconds * 1000.0);
+		p_results.push_back(t_result);
+	}};
+}
@@ -0,0 +1,55 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// End-to-end throughput with several producer threads and the distribution of caller latencies
+
+#include <string>
+#include <log.hxx>
+
+#include "harness.hxx"
+
+namespace bench
+{
+	static scenario g_throughput{ "throughput", [](::std::vector<result>& p_results)
+	{
+		const ::std::size_t t_perProducer = 100000;
+	
+		for(const ::std::size_t t_producers : { 1u, 2u, 4u, 8u })
+		{
+			p_results.push_back(measure_throughput("throughput/producers_" + ::std::to_string(t_producers), t_producers, t_perProducer, [](::std::size_t p_i)
+			{
+				LOG_I() << "Throughput entry " << p_i << " with a double " << 0.5 * p_i;
+			}));
+		}
+	}};
+	
+	static scenario g_latency{ "latency", [](::std::vector<result>& p_results)
+	{
+		const ::std::size_t t_iterations = 200000;
+		
+		const auto t_func = [](::std::size_t p_i)
+		{
+			LOG_I() << "Latency entry " << p_i;
+		};
+	
+		p_results.push_back(measure_latency("latency/ring_buffer", t_iterations, t_func));
+		
+		lg::logger::use_shared_queue();
+		p_results.push_back(measure_latency("latency/shared_queue", t_iterations, t_func));
+		
+		// Restore the mode all other scenarios expect
+		lg::logger::use_ring_buffers(1 << 14, lg::overflow_policy::block);
+	}};
+}
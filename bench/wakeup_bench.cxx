@@ -0,0 +1,139 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Idle CPU cost of the worker thread wakeup strategies and the time from creating an
+// entry until a log target receives it. Every strategy is measured on a channel of its own,
+// so that the other scenarios' settings do not interfere.
+
+#include <ctime>
+#include <string>
+#include <vector>
+#include <thread>
+#include <log.hxx>
+
+#include "harness.hxx"
+
+namespace bench
+{
+	namespace
+	{
+		const ::std::size_t g_latencyEntries = 2000;
+		const auto g_latencyPause = ::std::chrono::microseconds{ 50 };
+		const auto g_idleTime = ::std::chrono::milliseconds{ 500 };
+	
+		// Records the time every entry took from creation until it was written
+		class latency_target
+			: public lg::log_target
+		{
+			public:
+				latency_target()
+					: log_target(lg::severity_level::debug)
+				{
+					m_Samples.reserve(g_latencyEntries);
+				}
+				
+			public:
+				virtual void write(const lg::log_entry& p_entry) override
+				{
+					m_Samples.push_back(lg::timestamp::now().nanoseconds() - p_entry.time_point().nanoseconds());
+					m_Count.fetch_add(1, ::std::memory_order_release);
+				}
+				
+			public:
+				auto wait_for(::std::size_t p_count) const
+					-> void
+				{
+					while(m_Count.load(::std::memory_order_acquire) < p_count)
+						::std::this_thread::yield();
+				}
+				
+				// Only to be called once all entries were received
+				auto samples()
+					-> ::std::vector<::std::int64_t>&
+				{
+					return m_Samples;
+				}
+				
+			private:
+				::std::vector<::std::int64_t> m_Samples;
+				::std::atomic<::std::size_t> m_Count{0};
+		};
+		
+		auto measure_wakeup(const ::std::string& p_name, const lg::wakeup_options& p_options)
+			-> result
+		{
+			latency_target t_target{ };
+			
+			const auto t_channel = lg::channel::get("bench_wakeup_" + p_name);
+			t_channel.add_target(&t_target);
+			t_channel.set_wakeup(p_options);
+			
+			// Process CPU time spent while nothing is logged, which is mostly worker thread wakeups
+			::std::this_thread::sleep_for(::std::chrono::milliseconds{ 50 });
+			
+			const auto t_cpuBegin = ::std::clock();
+			::std::this_thread::sleep_for(g_idleTime);
+			const auto t_cpu = static_cast<double>(::std::clock() - t_cpuBegin) / CLOCKS_PER_SEC;
+			
+			// Entries trickle in, so that every one of them has to wake up the worker thread
+			::std::int64_t t_callerNs{ };
+			
+			for(::std::size_t t_i = 0; t_i < g_latencyEntries; ++t_i)
+			{
+				const auto t_begin = clock_type::now();
+				LOG_I_CH(t_channel) << "Wakeup entry " << t_i;
+				t_callerNs += ::std::chrono::duration_cast<::std::chrono::nanoseconds>(clock_type::now() - t_begin).count();
+				
+				::std::this_thread::sleep_for(g_latencyPause);
+			}
+			
+			t_target.wait_for(g_latencyEntries);
+			t_channel.shutdown();
+			
+			auto& t_samples = t_target.samples();
+			::std::sort(t_samples.begin(), t_samples.end());
+			
+			const auto t_percentile = [&t_samples](double p_p)
+			{
+				return static_cast<double>(t_samples[static_cast<::std::size_t>(p_p * (t_samples.size() - 1))]);
+			};
+			
+			result t_result{ "wakeup/" + p_name, g_latencyEntries, static_cast<double>(t_callerNs) / g_latencyEntries, 0.0 };
+			t_result.m_P50 = t_percentile(0.5);
+			t_result.m_P99 = t_percentile(0.99);
+			t_result.m_P999 = t_percentile(0.999);
+			t_result.m_Extra.emplace_back("idle_cpu_percent", 100.0 * t_cpu / ::std::chrono::duration<double>(g_idleTime).count());
+			
+			return t_result;
+		}
+	}
+	
+	// Latency percentiles of this scenario are enqueue-to-write times, not caller-side costs
+	static scenario g_wakeup{ "wakeup", [](::std::vector<result>& p_results)
+	{
+		lg::wakeup_options t_options{ };
+		
+		t_options.m_Strategy = lg::wakeup_strategy::park;
+		p_results.push_back(measure_wakeup("park", t_options));
+		
+		t_options.m_Strategy = lg::wakeup_strategy::spin;
+		p_results.push_back(measure_wakeup("spin", t_options));
+		
+		t_options.m_Strategy = lg::wakeup_strategy::batch;
+		t_options.m_BatchSize = 64;
+		t_options.m_BatchDelay = ::std::chrono::microseconds{ 500 };
+		p_results.push_back(measure_wakeup("batch", t_options));
+	}};
+}
@@ -1,9 +1,22 @@
 #pragma once
 
 #include "log/logger.hxx"
+#include "log/channel.hxx"
 #include "log/default_formatter.hxx"
 #include "log/clang_formatter.hxx"
+#include "log/json_formatter.hxx"
+#include "log/pattern_formatter.hxx"
 #include "log/console_target.hxx"
 #include "log/file_target.hxx"
+#include "log/mmap_file_target.hxx"
 #include "log/network_target.hxx"
+#include "log/async_network_target.hxx"
+#include "log/unix_datagram_target.hxx"
+#include "log/flight_recorder_target.hxx"
+#include "log/compressed_file_target.hxx"
+#include "log/binary_file_target.hxx"
+#include "log/binary_log_reader.hxx"
+#include "log/protocol_decoder.hxx"
 #include "log/tag.hxx"
+#include "log/tag_registry.hxx"
+#include "log/field.hxx"
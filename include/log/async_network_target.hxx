@@ -0,0 +1,111 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "log_target.hxx"
+#include "log_entry.hxx"
+#include "ring_buffer.hxx"
+#include "network_protocol.hxx"
+
+namespace lg
+{
+	// Settings of an asynchronous network target
+	struct async_network_options
+	{
+		::std::size_t m_MaxBufferedBytes{8u << 20};				//< Maximum number of bytes waiting to be sent, kept in memory
+		::std::size_t m_ChunkSize{64u << 10};					//< Packets are coalesced into chunks of this size
+		::std::size_t m_MaxSendBytes{1u << 20};					//< Maximum number of bytes handed to a single scatter-gather write
+		overflow_policy m_Overflow{overflow_policy::drop_newest};	//< What to do if memory and spill file are full
+		::std::string m_SpillPath{ };							//< File chunks are spilled to if memory is full. Empty disables spilling.
+		::std::uint64_t m_MaxSpillBytes{256u << 20};			//< Maximum size of the spill file contents
+		::std::chrono::milliseconds m_BackoffInitial{100};		//< Delay before the first reconnection attempt
+		::std::chrono::milliseconds m_BackoffMax{30000};		//< Upper bound for the exponentially growing reconnection delay
+		::std::chrono::milliseconds m_ShutdownTimeout{1000};	//< Time the destructor waits for buffered data to be sent
+		protocol_options m_Protocol{ };							//< Wire protocol version and compression
+	};
+	
+	namespace internal
+	{
+		struct async_network_data;
+	}
+
+	// Log target sending entries to a remote server over TCP, using the same protocol
+	// as network_target. Packets are coalesced into large chunks, which are sent by a
+	// background thread using scatter-gather writes, so a slow or unreachable server
+	// never stalls the logger. Lost connections are re-established automatically using
+	// exponential backoff. Chunks that were not completely acknowledged by the socket
+	// are sent again after reconnecting, so entries may be duplicated but never torn.
+	class async_network_target
+		: public log_target
+	{
+		public:
+			// Construct new target. Connecting happens in the background, so this never throws
+			// because the server is unreachable.
+			async_network_target(
+				severity_level p_lvl,
+				const ::std::string& p_host,
+				const ::std::string& p_port,
+				const ::std::string& p_src = ::std::string{},
+				const async_network_options& p_options = async_network_options{ }
+			);
+			
+			~async_network_target();
+
+			async_network_target(const async_network_target&) = delete;
+			async_network_target(async_network_target&&) = delete;
+
+			async_network_target& operator=(const async_network_target&) = delete;
+			async_network_target& operator=(async_network_target&&) = delete;
+
+		public:
+			virtual void write(const log_entry& entry) override;
+			virtual void write_batch(entry_span entries) override;
+			
+			// Wait until everything buffered was sent, for at most the shutdown timeout.
+			// Does not wait while the connection is down.
+			virtual void flush() override;
+			
+		public:
+			// Whether there currently is a connection to the server
+			auto connected() const
+				-> bool;
+				
+			// Number of entries that were discarded due to the overflow policy
+			auto dropped() const
+				-> ::std::uint64_t;
+				
+			// Number of bytes waiting to be sent, both in memory and in the spill file
+			auto buffered() const
+				-> ::std::uint64_t;
+				
+			// Number of times the connection was re-established after it was lost
+			auto reconnects() const
+				-> ::std::uint64_t;
+
+		private:
+			internal::protocol_encoder m_Encoder;			// Encodes entries using the configured protocol version
+			::std::string m_Packets;						// Buffer the packets of a batch are encoded into
+			::std::vector<internal::frame_info> m_Frames;	// Packets or frames contained in m_Packets
+			::std::unique_ptr<internal::async_network_data> m_Data;
+	};
+}
@@ -0,0 +1,89 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "log_target.hxx"
+#include "log_entry.hxx"
+#include "flush_policy.hxx"
+#include "network_protocol.hxx"
+#include "binary_index.hxx"
+#include "file_sync.hxx"
+
+namespace lg
+{
+	// Settings of a binary file target
+	struct binary_file_options
+	{
+		::std::size_t m_BlockSize{64u << 10};	//< A block is finished once its uncompressed records reach this size
+		bool m_Compress{true};					//< Whether to compress blocks
+		::std::string m_Source{ };				//< Source string stored with every block, e.g. the host name
+	};
+
+	// Log target that writes entries as compact binary records instead of text, see
+	// binary_index.hxx for the file format. Records keep the full timestamp, thread id,
+	// source location, tag and structured fields. Blocks of records are described by an
+	// index file, which lets readers skip blocks that can not match a query by time, level or tag.
+	// Blocks are finished whenever the flush policy asks for a flush, so larger flush
+	// intervals result in fewer, larger blocks.
+	class binary_file_target
+		: public log_target
+	{
+		public:
+			// Construct new target appending to the data file at given path and its index "<path>.idx"
+			binary_file_target(severity_level p_lvl, const ::std::string& p_path, const binary_file_options& p_options = binary_file_options{ }, flush_policy p_policy = flush_policy::per_batch());
+			
+			// Finishes the current block
+			~binary_file_target();
+			
+			binary_file_target(const binary_file_target&) = delete;
+			binary_file_target& operator=(const binary_file_target&) = delete;
+			
+		public:
+			virtual void write(const log_entry& entry) override;
+			virtual void write_batch(entry_span entries) override;
+			
+			// Finish the current block and wait until data and index reached the storage device
+			virtual void flush() override;
+			
+			// Number of flushes that could not make data or index durable, either because
+			// syncing or a preceding write failed
+			auto sync_failures() const
+				-> ::std::uint64_t;
+			
+		private:
+			// Write current block and its index record
+			auto finish_block()
+				-> void;
+			
+		private:
+			binary_file_options m_Options;
+			flush_policy m_Policy;							// Decides when to finish a block and flush the streams
+			internal::protocol_encoder m_Encoder;			// Collects the records of the current block
+			internal::block_index m_Block;					// Summary of the current block
+			internal::output_file m_Data;					// Data file
+			internal::output_file m_Index;					// Index file
+			::std::uint64_t m_Offset{0};					// Size of the data file
+			::std::string m_Buffer;							// Buffer the current block and its index record are encoded into
+			::std::vector<internal::frame_info> m_Frames;
+			::std::atomic<::std::uint64_t> m_SyncFailures{0};	// Number of failed flushes
+	};
+}
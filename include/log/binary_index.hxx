@@ -0,0 +1,106 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*	BINARY LOG FORMAT:
+ *
+ *	A binary log consists of a data file and an index file named "<path>.idx".
+ *	The data file is a sequence of protocol v2 frames, see network_protocol.hxx, which
+ *	log_decode can read as well. Every frame forms one block.
+ *
+ *	Index file:
+ *	[u8 x4]		Magic ("LGIX")
+ *	[u8]		Version (0x1)
+ *	...			Index records, one per block, in the order of the blocks
+ *
+ *	Index record:
+ *	[u32]		Length of the remaining record
+ *	[u64]		Offset of the block in the data file
+ *	[u32]		Length of the block
+ *	[varint]	Number of records in the block
+ *	[u64]		Earliest timestamp of the block in nanoseconds since epoch
+ *	[u64]		Latest timestamp of the block in nanoseconds since epoch
+ *	[u8]		Level bitmap. Bit N is set if the block contains a record of level N.
+ *	[u8]		Flags. Bit 0: The block contains more distinct tags than are listed.
+ *	[varint]	Number of listed tags
+ *	...			Tags, each as [varint] length followed by the payload. Untagged records
+ *				are listed as the empty tag.
+ *
+ *	Varints are unsigned LEB128. All other integers are big endian.
+ *
+ *	A block is indexed after it was written. Blocks at the end of the data file might thus
+ *	lack an index record after a crash, which readers make up for by scanning the frames.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+
+#include "severity_level.hxx"
+#include "timestamp.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		constexpr ::std::uint8_t index_magic_0 = 0x4C;
+		constexpr ::std::uint8_t index_magic_1 = 0x47;
+		constexpr ::std::uint8_t index_magic_2 = 0x49;
+		constexpr ::std::uint8_t index_magic_3 = 0x58;
+		constexpr ::std::uint8_t index_version = 0x1;
+		constexpr ::std::size_t index_header_size = 5;
+		constexpr ::std::uint8_t index_flag_more_tags = 0x1;
+		
+		// Number of distinct tags listed per block. Blocks with more tags have to be read for every tag query.
+		constexpr ::std::size_t max_indexed_tags = 16;
+	
+		// Summary of a single block of a binary log
+		struct block_index
+		{
+			::std::uint64_t m_Offset{0};		//< Offset of the block in the data file
+			::std::uint32_t m_Length{0};		//< Length of the block in bytes
+			::std::uint64_t m_Records{0};		//< Number of records in the block
+			::std::int64_t m_First{::std::numeric_limits<::std::int64_t>::max()};	//< Earliest timestamp in nanoseconds
+			::std::int64_t m_Last{::std::numeric_limits<::std::int64_t>::min()};	//< Latest timestamp in nanoseconds
+			::std::uint8_t m_Levels{0};			//< Bit N is set if a record of level N is contained
+			bool m_MoreTags{false};				//< Whether there are tags that are not listed
+			::std::vector<::std::string> m_Tags{ };	//< Distinct tags of all records
+			
+			// Account for a record with given properties
+			auto add(severity_level p_lvl, timestamp p_time, const ::std::string& p_tag)
+				-> void;
+				
+			// Reset to the summary of an empty block
+			auto clear()
+				-> void;
+		};
+		
+		// Append the index file header to given buffer
+		auto encode_index_header(::std::string& p_out)
+			-> void;
+		
+		// Append index record describing given block to given buffer
+		auto encode_index(::std::string& p_out, const block_index& p_index)
+			-> void;
+			
+		// Decode the index record at the start of given data. Returns the number of bytes consumed,
+		// or zero if the record is incomplete. Throws std::runtime_error if the record is malformed.
+		auto decode_index(const char* p_data, ::std::size_t p_len, block_index& p_index)
+			-> ::std::size_t;
+	}
+}
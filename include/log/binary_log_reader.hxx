@@ -0,0 +1,92 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <fstream>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+#include "severity_level.hxx"
+#include "timestamp.hxx"
+#include "protocol_decoder.hxx"
+#include "binary_index.hxx"
+
+namespace lg
+{
+	// Filter applied to the records of a binary log
+	struct log_query
+	{
+		severity_level m_Level{severity_level::debug};	//< Least severe level of matching records
+		::std::vector<::std::string> m_Tags{ };			//< Tags of matching records. Empty matches all records.
+		timestamp m_Since{::std::numeric_limits<::std::int64_t>::min()};	//< Earliest timestamp of matching records
+		timestamp m_Until{::std::numeric_limits<::std::int64_t>::max()};	//< Latest timestamp of matching records
+		
+		auto matches(const decoded_record& p_record) const
+			-> bool;
+	};
+	
+	// Amount of work done by a query
+	struct query_stats
+	{
+		::std::size_t m_Blocks{0};			//< Number of indexed blocks
+		::std::size_t m_BlocksRead{0};		//< Number of indexed blocks that could contain matching records
+		::std::uint64_t m_BytesRead{0};		//< Number of bytes read from the data file
+		::std::uint64_t m_Unindexed{0};		//< Number of bytes that were read because the index did not cover them
+		::std::uint64_t m_Matches{0};		//< Number of matching records
+	};
+
+	// Reads binary logs written by binary_file_target. Queries only read the blocks whose
+	// index record says they could contain matching records.
+	class binary_log_reader
+	{
+		public:
+			// Open binary log with given data file path. Without an index file, queries scan the whole data file.
+			// Throws std::runtime_error if the data file can not be opened or the index file is malformed.
+			explicit binary_log_reader(const ::std::string& p_path);
+			
+		public:
+			// Call given function for every record matching given query, in the order they were written.
+			// Throws std::runtime_error if a block is malformed.
+			auto query(const log_query& p_query, const ::std::function<void(const decoded_record&)>& p_fn)
+				-> query_stats;
+				
+			// Index records of all blocks
+			auto blocks() const
+				-> const ::std::vector<internal::block_index>&;
+				
+		private:
+			auto load_index(const ::std::string& p_path)
+				-> void;
+				
+			// Whether given block could contain records matching given query
+			auto may_match(const internal::block_index& p_block, const log_query& p_query) const
+				-> bool;
+				
+			// Decode the frames contained in given range of the data file
+			auto scan(::std::uint64_t p_begin, ::std::uint64_t p_end, const log_query& p_query, const ::std::function<void(const decoded_record&)>& p_fn, query_stats& p_stats)
+				-> void;
+				
+		private:
+			::std::ifstream m_Data;							//< Data file stream
+			::std::uint64_t m_Size{0};						//< Size of the data file
+			::std::vector<internal::block_index> m_Blocks;	//< Index records, ordered by offset
+			::std::vector<char> m_Buffer;					//< Buffer data is read into
+	};
+}
@@ -0,0 +1,136 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <condition_variable>
+
+#include "lz_codec.hxx"
+#include "file_sync.hxx"
+
+namespace lg
+{
+	// Settings of a compressed file target
+	struct compressed_file_options
+	{
+		::std::size_t m_BlockSize{128u << 10};					//< Uncompressed size at which a block is handed to the compressor threads
+		unsigned m_Level{internal::lz_default_level};			//< Compression level, see lz_codec.hxx
+		::std::size_t m_Threads{1};							//< Number of compressor threads
+		::std::size_t m_MaxPending{4};							//< Maximum number of blocks waiting to be compressed or written
+	};
+	
+	// Counters of a compressed file target
+	struct compression_stats
+	{
+		::std::uint64_t m_Blocks{0};			//< Number of blocks written
+		::std::uint64_t m_RawBytes{0};			//< Uncompressed size of all written blocks
+		::std::uint64_t m_CompressedBytes{0};	//< Compressed size of all written blocks
+		::std::uint64_t m_Nanoseconds{0};		//< Time spent compressing, summed over all compressor threads
+		
+		// Uncompressed size divided by compressed size
+		auto ratio() const
+			-> double
+		{
+			return m_CompressedBytes ? static_cast<double>(m_RawBytes) / m_CompressedBytes : 0.0;
+		}
+		
+		// Uncompressed bytes compressed per second by a single compressor thread
+		auto throughput() const
+			-> double
+		{
+			return m_Nanoseconds ? m_RawBytes * 1e9 / m_Nanoseconds : 0.0;
+		}
+	};
+
+	namespace internal
+	{
+		// Compresses blocks on a set of helper threads and appends them to a file in the order
+		// they were submitted. Every block becomes an independent LZ4 frame, so the file is
+		// a plain concatenation of frames that can be decompressed starting at any block.
+		class block_compressor
+		{
+			public:
+				// Start compressor threads appending to the file at given path
+				block_compressor(const ::std::string& p_path, const compressed_file_options& p_options);
+				
+				// Writes all submitted blocks and stops the compressor threads
+				~block_compressor();
+				
+				block_compressor(const block_compressor&) = delete;
+				block_compressor& operator=(const block_compressor&) = delete;
+				
+			public:
+				// Hand given block to the compressor threads. The block is swapped with a recycled,
+				// empty buffer. Blocks if the maximum number of pending blocks is reached.
+				auto submit(::std::string& p_block)
+					-> void;
+					
+				// Wait until all submitted blocks were written and reached the storage device.
+				// Returns false if that failed, or if any write since the last sync failed.
+				auto sync()
+					-> bool;
+					
+				auto stats() const
+					-> compression_stats;
+				
+			private:
+				struct job
+				{
+					::std::string m_Raw;			//< Uncompressed block
+					::std::string m_Compressed;		//< Compressed frame
+					bool m_Done{false};				//< Whether the frame is ready to be written
+				};
+				
+				using job_ptr = ::std::unique_ptr<job>;
+				
+			private:
+				// Compressor thread function
+				auto do_work()
+					-> void;
+					
+				// Write finished blocks at the front of the pending list. Only one thread writes at a time.
+				auto write_ready(::std::unique_lock<::std::mutex>& p_lock)
+					-> void;
+				
+			private:
+				compressed_file_options m_Options;
+				output_file m_File;								//< Output file, only used by the current writer
+				
+				::std::mutex m_Mtx;								//< Guards the job lists and flags
+				::std::condition_variable m_WorkCv;				//< Wakes up compressor threads
+				::std::condition_variable m_DoneCv;				//< Wakes up threads waiting for blocks to be written
+				::std::deque<job_ptr> m_Pending;				//< Submitted blocks not yet written, in submission order
+				::std::deque<job*> m_Queue;						//< Submitted blocks not yet taken by a compressor thread
+				::std::vector<job_ptr> m_Free;					//< Written jobs kept to reuse their buffers
+				bool m_Writing{false};							//< Whether a thread is currently writing blocks
+				bool m_ShouldStop{false};						//< Whether the compressor threads are requested to stop
+				::std::vector<::std::thread> m_Workers;
+				
+				::std::atomic<::std::uint64_t> m_Blocks{0};
+				::std::atomic<::std::uint64_t> m_RawBytes{0};
+				::std::atomic<::std::uint64_t> m_CompressedBytes{0};
+				::std::atomic<::std::uint64_t> m_Nanoseconds{0};
+		};
+	}
+}
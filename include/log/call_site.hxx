@@ -0,0 +1,35 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <ut/console_color.hxx>
+
+#include "severity_level.hxx"
+
+namespace lg
+{
+	// Static metadata of a single LOG_* statement. Every macro invocation emits
+	// exactly one constant instance of this, which log entries refer to by pointer.
+	struct call_site
+	{
+		const char* m_File;				//< Source file, as given by __FILE__
+		::std::size_t m_Line;			//< Source line
+		severity_level m_Level;			//< Initial severity level of entries
+		ut::console_color m_Color;		//< Initial color of entries
+		bool m_IsBare;					//< Whether entries are bare
+	};
+}
@@ -0,0 +1,156 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ut/observer_ptr.hxx>
+
+#include "logger.hxx"
+
+namespace lg
+{
+	// Handle of a logger instance. Every channel has its own queue, worker thread,
+	// log targets and threshold, so that a busy channel does not delay the entries of others.
+	// Channels are identified by name and live until the end of the program.
+	// The channel with the empty name is the default logger used by the LOG_* macros.
+	class channel
+	{
+		public:
+			// Handle of the default logger
+			channel();
+			
+		public:
+			// Retrieve channel with given name, creating it on first use. The options
+			// are only used when the channel is created.
+			static auto get(const ::std::string& p_name, const channel_options& p_options = channel_options{ })
+				-> channel;
+			
+		public:
+			// Add log target to this channel. See logger::add_target.
+			// If the dispatch pool is shared, lane names refer to the lanes of the pool.
+			auto add_target(ut::observer_ptr<log_target> p_target, const ::std::string& p_lane = ::std::string{ }, const lane_options& p_options = lane_options{ }) const
+				-> void;
+				
+			// Remove log target from this channel. See logger::remove_target.
+			auto remove_target(ut::observer_ptr<log_target> p_target) const
+				-> bool;
+				
+			// Let a new log target take the place of one of this channel. See logger::replace_target.
+			auto replace_target(ut::observer_ptr<log_target> p_old, ut::observer_ptr<log_target> p_new) const
+				-> bool;
+				
+			// Change the most verbose severity level accepted by the channel. Takes effect immediately.
+			auto set_threshold(severity_level p_lvl) const
+				-> void;
+				
+			auto threshold() const
+				-> severity_level;
+				
+			// Whether an entry of given severity level would reach at least one log target of this channel
+			auto enabled(severity_level p_lvl) const
+				-> bool
+			{
+				return static_cast<int>(p_lvl) <= LIBLOG_MIN_LEVEL
+					&& static_cast<int>(p_lvl) <= m_Logger->m_Verbosity.load(::std::memory_order_relaxed);
+			}
+			
+			// Let producer threads use ring buffers for this channel. See logger::use_ring_buffers.
+			auto use_ring_buffers(::std::size_t p_capacity = 1024, overflow_policy p_policy = overflow_policy::block) const
+				-> void;
+				
+			// Change how the worker thread of this channel waits for new entries
+			auto set_wakeup(const wakeup_options& p_options) const
+				-> void;
+				
+			auto deduplicate(bool p_enable) const
+				-> void;
+				
+			// Wait until the entries of this channel enqueued so far were written and flushed. See logger::flush.
+			auto flush(::std::chrono::milliseconds p_timeout = ::std::chrono::seconds{5}) const
+				-> bool;
+				
+			// See logger::use_sync_delivery
+			auto use_sync_delivery(severity_level p_lvl, ::std::chrono::milliseconds p_timeout = ::std::chrono::seconds{5}) const
+				-> void;
+				
+			auto use_async_delivery() const
+				-> void;
+				
+			auto self_report(::std::chrono::milliseconds p_interval) const
+				-> void;
+				
+			auto lanes() const
+				-> ::std::vector<lane_info>;
+				
+			auto stats() const
+				-> logger_stats;
+				
+			// Write all remaining entries and stop the worker thread of this channel
+			auto shutdown() const
+				-> void;
+				
+			auto name() const
+				-> const ::std::string&;
+				
+			// Logger instance entries are inserted into
+			auto instance() const
+				-> logger&
+			{
+				return *m_Logger;
+			}
+			
+		private:
+			explicit channel(logger& p_logger);
+			
+		private:
+			logger* m_Logger;
+	};
+}
+
+
+// Log Macros - channels. The channel expression is evaluated more than once and thus should
+// be a variable of type lg::channel, which is cheap to copy.
+#define LOG_CH_BASE( _ch, _level, _clr ) !(_ch).enabled(::NS()::severity_level::_level) ? (void)0 : (_ch).instance() += ::NS()::log_entry(LOG_SITE_BASE(_level, _clr, false))
+
+#define LOG_F_CH( _ch ) LOG_CH_BASE(_ch, fatal,		bright_red)
+#define LOG_E_CH( _ch ) LOG_CH_BASE(_ch, error,		bright_red)
+#define LOG_W_CH( _ch ) LOG_CH_BASE(_ch, warning,	bright_yellow)
+#define LOG_I_CH( _ch ) LOG_CH_BASE(_ch, info,		bright_white)
+#define LOG_D_CH( _ch ) LOG_CH_BASE(_ch, debug,		bright_cyan)
+
+#define LOG_F_CH_TAG( _ch, _tag ) LOG_TAG_BASE((_ch).enabled(::NS()::severity_level::fatal), fatal, LOG_F_CH(_ch), _tag)
+#define LOG_E_CH_TAG( _ch, _tag ) LOG_TAG_BASE((_ch).enabled(::NS()::severity_level::error), error, LOG_E_CH(_ch), _tag)
+#define LOG_W_CH_TAG( _ch, _tag ) LOG_TAG_BASE((_ch).enabled(::NS()::severity_level::warning), warning, LOG_W_CH(_ch), _tag)
+#define LOG_I_CH_TAG( _ch, _tag ) LOG_TAG_BASE((_ch).enabled(::NS()::severity_level::info), info, LOG_I_CH(_ch), _tag)
+#define LOG_D_CH_TAG( _ch, _tag ) LOG_TAG_BASE((_ch).enabled(::NS()::severity_level::debug), debug, LOG_D_CH(_ch), _tag)
+
+#define LOG_F_CH_FMT( _ch, _fmtstr, ... ) LOG_FMT_BASE( LOG_F_CH(_ch), _fmtstr, __VA_ARGS__ )
+#define LOG_E_CH_FMT( _ch, _fmtstr, ... ) LOG_FMT_BASE( LOG_E_CH(_ch), _fmtstr, __VA_ARGS__ )
+#define LOG_W_CH_FMT( _ch, _fmtstr, ... ) LOG_FMT_BASE( LOG_W_CH(_ch), _fmtstr, __VA_ARGS__ )
+#define LOG_I_CH_FMT( _ch, _fmtstr, ... ) LOG_FMT_BASE( LOG_I_CH(_ch), _fmtstr, __VA_ARGS__ )
+#define LOG_D_CH_FMT( _ch, _fmtstr, ... ) LOG_FMT_BASE( LOG_D_CH(_ch), _fmtstr, __VA_ARGS__ )
+
+#define LOG_F_CH_IF( _ch, _expr ) LOG_IF_BASE( (_expr), LOG_F_CH(_ch) )
+#define LOG_E_CH_IF( _ch, _expr ) LOG_IF_BASE( (_expr), LOG_E_CH(_ch) )
+#define LOG_W_CH_IF( _ch, _expr ) LOG_IF_BASE( (_expr), LOG_W_CH(_ch) )
+#define LOG_I_CH_IF( _ch, _expr ) LOG_IF_BASE( (_expr), LOG_I_CH(_ch) )
+#define LOG_D_CH_IF( _ch, _expr ) LOG_IF_BASE( (_expr), LOG_D_CH(_ch) )
+
+#define LOG_CH_LOCK( _ch ) MACRO_WRAP_BASE((_ch).instance().lock();)
+#define LOG_CH_UNLOCK( _ch ) MACRO_WRAP_BASE((_ch).instance().unlock();)
+// ---
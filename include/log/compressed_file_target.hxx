@@ -0,0 +1,143 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+
+#include "default_formatter.hxx"
+#include "log_target.hxx"
+#include "log_entry.hxx"
+#include "flush_policy.hxx"
+#include "message_buffer.hxx"
+#include "block_compressor.hxx"
+
+namespace lg
+{
+	// Log target that gathers formatted entries into blocks and compresses them on helper
+	// threads, so that the logger thread only pays for formatting. The file is a sequence of
+	// independent LZ4 frames, one per block, which is appended to if the file already exists.
+	// It can be decompressed using "lz4 -d" or, starting at any block, using the log_unpack tool.
+	// Partial blocks are submitted whenever the flush policy asks for a flush.
+	template< typename Tformat = default_formatter >
+	class compressed_file_target
+		: public log_target
+	{
+		static_assert(internal::is_formatter<Tformat>::value, "Tformat is not a valid log formatter!");
+
+		public:
+			// Construct new compressed file target with given severity threshold, path and settings.
+			// By default, partial blocks are submitted once per second, which keeps blocks large.
+			compressed_file_target(severity_level p_lvl, const ::std::string& p_path, const compressed_file_options& p_options = compressed_file_options{ }, flush_policy p_policy = flush_policy::interval(::std::chrono::seconds{1}))
+				:	log_target(p_lvl),
+					m_BlockSize{p_options.m_BlockSize},
+					m_Policy{p_policy},
+					m_Compressor{p_path, p_options}
+			{
+				m_Block.reserve(m_BlockSize);
+			}
+			
+			compressed_file_target(severity_level p_lvl, const ::std::string& p_path, const compressed_file_options& p_options, flush_policy p_policy, const Tformat& p_fmt)
+				:	log_target(p_lvl),
+					m_Formatter{p_fmt},
+					m_BlockSize{p_options.m_BlockSize},
+					m_Policy{p_policy},
+					m_Compressor{p_path, p_options}
+			{
+				m_Block.reserve(m_BlockSize);
+			}
+			
+			// Submits the current block. The compressor writes it before stopping.
+			~compressed_file_target()
+			{
+				submit_block();
+			}
+
+		public:
+			virtual void write(const log_entry& entry) override
+			{
+				const log_entry* t_entry = &entry;
+				write_batch(entry_span{ &t_entry, 1 });
+			}
+			
+			// Format whole batch into one buffer, which is moved into the current block
+			// whenever the block is full, so that blocks always end with a complete entry
+			virtual void write_batch(entry_span entries) override
+			{
+				m_Buffer.clear_buffer();
+				
+				for(const auto& t_entry : entries)
+				{
+					m_Formatter(m_Buffer, t_entry);
+					
+					if(m_Block.size() + m_Buffer.size() >= m_BlockSize)
+					{
+						m_Block.append(m_Buffer.data(), m_Buffer.size());
+						m_Buffer.clear_buffer();
+						submit_block();
+					}
+				}
+				
+				m_Block.append(m_Buffer.data(), m_Buffer.size());
+				
+				if(m_Policy.should_flush(entries))
+					submit_block();
+			}
+			
+			// Submit the current block and wait until all blocks reached the storage device
+			virtual void flush() override
+			{
+				submit_block();
+				
+				if(!m_Compressor.sync())
+					m_SyncFailures.fetch_add(1, ::std::memory_order_relaxed);
+			}
+			
+			// Number of flushes that could not make the file contents durable, either because
+			// syncing or a preceding write failed
+			auto sync_failures() const
+				-> ::std::uint64_t
+			{
+				return m_SyncFailures.load(::std::memory_order_relaxed);
+			}
+			
+			// Compression ratio and throughput of all blocks written so far
+			auto stats() const
+				-> compression_stats
+			{
+				return m_Compressor.stats();
+			}
+			
+		private:
+			auto submit_block()
+				-> void
+			{
+				if(!m_Block.empty())
+					m_Compressor.submit(m_Block);
+			}
+
+		private:
+			Tformat m_Formatter;					// Formatter used by this target
+			::std::size_t m_BlockSize;				// Size at which the current block is submitted
+			flush_policy m_Policy;					// Decides when to submit partial blocks
+			::std::string m_Block;					// Formatted entries of the current block
+			internal::buffer_stream m_Buffer;		// Buffer the current batch is formatted into
+			internal::block_compressor m_Compressor;
+			::std::atomic<::std::uint64_t> m_SyncFailures{0};	// Number of failed flushes
+	};
+}
@@ -15,9 +15,13 @@
 
 #pragma once
 
+#include <iostream>
+
 #include "default_formatter.hxx"
 #include "log_target.hxx"
 #include "log_entry.hxx"
+#include "flush_policy.hxx"
+#include "message_buffer.hxx"
 
 namespace lg
 {
@@ -38,8 +42,8 @@ namespace lg
 			
 			// Construct new console target with given severity threshold and
 			// formatter instance
-			console_target(severity_level p_lvl, const Tformat& p_fmt)
-				: log_target(p_lvl), m_Formatter{p_fmt}
+			console_target(severity_level p_lvl, const Tformat& p_fmt, flush_policy p_policy = flush_policy::per_batch())
+				: log_target(p_lvl), m_Formatter{p_fmt}, m_Policy{p_policy}
 			{
 			}
 
@@ -48,11 +52,32 @@ namespace lg
 			// TODO maybe write errors to cerr instead. This could be checked here.
 			virtual void write(const log_entry& entry) override
 			{
-				// Format and write entry to console output stream
-				m_Formatter(std::cout, entry);
+				const log_entry* t_entry = &entry;
+				write_batch(entry_span{ &t_entry, 1 });
+			}
+			
+			// Format whole batch into one buffer and write it to the console output stream at once
+			virtual void write_batch(entry_span entries) override
+			{
+				m_Buffer.clear_buffer();
+			
+				for(const auto& t_entry : entries)
+					m_Formatter(m_Buffer, t_entry);
+					
+				std::cout.write(m_Buffer.data(), m_Buffer.size());
+				
+				if(m_Policy.should_flush(entries))
+					std::cout.flush();
+			}
+			
+			virtual void flush() override
+			{
+				std::cout.flush();
 			}
 
 		private:
-			Tformat m_Formatter;
+			Tformat m_Formatter;						// Formatter used by this target
+			flush_policy m_Policy{flush_policy::per_batch()};	// Decides when to flush the output stream
+			internal::buffer_stream m_Buffer;			// Buffer the current batch is formatted into
 	};
 }
@@ -0,0 +1,91 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "log_entry.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		// Collapses runs of identical consecutive entries into the first one, followed by
+		// a summary saying how often it was repeated. Entries are identical if they stem
+		// from the same call site and have equal level, tag, message and fields.
+		// Only used by the worker thread, except for removed().
+		class dedup_filter
+		{
+			using queue_type = ::std::vector<log_entry>;
+			using clock_type = ::std::chrono::steady_clock;
+
+			public:
+				// Summaries of runs that last longer than this are emitted periodically
+				static constexpr ::std::chrono::seconds max_run_age{1};
+
+			public:
+				// Remove repetitions from given queue. Summaries of runs that ended are inserted
+				// in place of the entry that ended them.
+				auto apply(queue_type& p_queue)
+					-> void;
+
+				// Append summary of the current run to given queue, if it got older than max_run_age,
+				// or regardless of its age if requested.
+				auto flush(queue_type& p_queue, bool p_force)
+					-> void;
+
+				// Whether repetitions were removed that still have to be summarized
+				auto active() const
+					-> bool
+				{
+					return m_Repeats > 0;
+				}
+
+				// Number of entries removed so far
+				auto removed() const
+					-> ::std::uint64_t
+				{
+					return m_Removed.load(::std::memory_order_relaxed);
+				}
+
+			private:
+				auto is_repetition(const log_entry& p_entry) const
+					-> bool;
+
+				auto remember(const log_entry& p_entry)
+					-> void;
+
+				auto summary()
+					-> log_entry;
+
+			private:
+				const call_site* m_Site{nullptr};		//< Call site of the last entry, null if there is none
+				severity_level m_Level{ };
+				tag_id m_Tag{0};
+				::std::string m_Message{ };
+				::std::string m_Fields{ };				//< Binary representation of the fields
+				::std::size_t m_Repeats{0};				//< Number of repetitions in the current run
+				clock_type::time_point m_RunBegin{ };	//< Time the first repetition of the current run was removed
+				::std::atomic<::std::uint64_t> m_Removed{0};	//< Read by statistics snapshots
+				queue_type m_Output{ };					//< Reused storage of the filtered queue
+		};
+	}
+}
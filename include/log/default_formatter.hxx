@@ -18,13 +18,27 @@
 #include <string>
 #include <ostream>
 
+#include "timestamp.hxx"
+
 namespace lg
 {
 	class log_entry;
 
 	class default_formatter
 	{
+		public:
+			default_formatter() = default;
+			
+			// Construct formatter that prints timestamps with given sub-second precision
+			default_formatter(time_precision p_precision)
+				: m_Precision{p_precision}
+			{
+			}
+	
 		public:
 			void operator()(std::ostream&, const log_entry&);
+			
+		protected:
+			time_precision m_Precision{time_precision::seconds};
 	};
 }
@@ -0,0 +1,347 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <array>
+#include <tuple>
+#include <cstring>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include <ut/format.hxx>
+#include <ut/type_traits.hxx>
+
+// Size of the inline buffer used to capture the format string and its arguments.
+// Format calls that do not fit are formatted right away on the calling thread.
+#ifndef LIBLOG_DEFERRED_BUFFER_SIZE
+#	define LIBLOG_DEFERRED_BUFFER_SIZE 128
+#endif
+
+namespace lg
+{
+	namespace internal
+	{
+		template< bool... Bs >
+		struct bool_pack;
+
+		template< bool... Bs >
+		using all_of = ::std::is_same<bool_pack<true, Bs...>, bool_pack<Bs..., true>>;
+
+		// Argument types whose contents are copied into the capture buffer
+		template< typename T >
+		using is_captured_string = ut::disjunction<
+										::std::is_same<T, char*>,
+										::std::is_same<T, const char*>,
+										::std::is_same<T, ::std::string>
+									>;
+
+		// Argument types that are captured by value
+		template< typename T >
+		using is_captured_value = ::std::integral_constant<bool,
+										(::std::is_arithmetic<T>::value || ::std::is_enum<T>::value || ::std::is_pointer<T>::value)
+										&& !is_captured_string<T>::value
+									>;
+
+		template< typename T >
+		using is_capturable = ut::disjunction<is_captured_string<T>, is_captured_value<T>>;
+
+		// Type an argument is restored as on the worker thread
+		template< typename T >
+		using restored_type = ::std::conditional_t<is_captured_string<T>::value, ::std::string, T>;
+
+		// Determines whether a call to format() with given format string and argument
+		// types can be deferred. The format string is copied along with the arguments,
+		// since nothing guarantees that it outlives the log entry. It thus may be of any
+		// string type, but all arguments have to be capturable.
+		template< typename Tfmt, typename... Ts >
+		using is_deferrable = ::std::integral_constant<bool,
+										is_captured_string<::std::decay_t<Tfmt>>::value
+										&& all_of<is_capturable<::std::decay_t<Ts>>::value...>::value
+									>;
+									
+		inline auto format_string(const char* p_fmt)
+			-> const char*
+		{
+			return p_fmt;
+		}
+		
+		inline auto format_string(const ::std::string& p_fmt)
+			-> const char*
+		{
+			return p_fmt.c_str();
+		}
+
+		// Serializes arguments into a fixed-size byte buffer
+		class argument_writer
+		{
+			public:
+				argument_writer(unsigned char* p_begin, unsigned char* p_end)
+					: m_Cur{p_begin}, m_End{p_end}
+				{
+				}
+
+			public:
+				template< typename T >
+				auto write(const T& p_val)
+					-> ::std::enable_if_t<is_captured_value<T>::value>
+				{
+					write_raw(&p_val, sizeof(T));
+				}
+
+				auto write(const ::std::string& p_str)
+					-> void
+				{
+					write_string(p_str.data(), p_str.length());
+				}
+
+				auto write(const char* p_str)
+					-> void
+				{
+					if(p_str == nullptr)
+						write_string("(null)", 6);
+					else write_string(p_str, ::std::strlen(p_str));
+				}
+
+				// Copy format string including its terminator, so that it can be used right from the buffer
+				auto write_format(const char* p_fmt)
+					-> void
+				{
+					// A null format is left to the eager path, which reports it
+					if(p_fmt == nullptr)
+						m_Overflow = true;
+					else write_raw(p_fmt, ::std::strlen(p_fmt) + 1);
+				}
+
+			public:
+				// Whether the buffer was too small for all arguments
+				auto overflow() const
+					-> bool
+				{
+					return m_Overflow;
+				}
+
+				auto position() const
+					-> const unsigned char*
+				{
+					return m_Cur;
+				}
+
+			private:
+				auto write_string(const char* p_str, ::std::size_t p_len)
+					-> void
+				{
+					write_raw(&p_len, sizeof(p_len));
+					write_raw(p_str, p_len);
+				}
+
+				auto write_raw(const void* p_data, ::std::size_t p_len)
+					-> void
+				{
+					if(m_Overflow || static_cast<::std::size_t>(m_End - m_Cur) < p_len)
+					{
+						m_Overflow = true;
+						return;
+					}
+
+					::std::memcpy(m_Cur, p_data, p_len);
+					m_Cur += p_len;
+				}
+
+			private:
+				unsigned char* m_Cur;
+				unsigned char* m_End;
+				bool m_Overflow{false};
+		};
+
+		// Restores arguments written by argument_writer
+		class argument_reader
+		{
+			public:
+				argument_reader(const unsigned char* p_begin)
+					: m_Cur{p_begin}
+				{
+				}
+
+			public:
+				template< typename T >
+				auto read()
+					-> ::std::enable_if_t<is_captured_value<T>::value, T>
+				{
+					T t_val;
+					read_raw(&t_val, sizeof(T));
+					return t_val;
+				}
+
+				template< typename T >
+				auto read()
+					-> ::std::enable_if_t<is_captured_string<T>::value, ::std::string>
+				{
+					::std::size_t t_len{ };
+					read_raw(&t_len, sizeof(t_len));
+
+					::std::string t_str(reinterpret_cast<const char*>(m_Cur), t_len);
+					m_Cur += t_len;
+					return t_str;
+				}
+
+			private:
+				auto read_raw(void* p_data, ::std::size_t p_len)
+					-> void
+				{
+					::std::memcpy(p_data, m_Cur, p_len);
+					m_Cur += p_len;
+				}
+
+			private:
+				const unsigned char* m_Cur;
+		};
+
+		template< typename Ttuple, ::std::size_t... Is >
+		auto apply_format(const char* p_fmt, const Ttuple& p_args, ::std::index_sequence<Is...>)
+			-> ::std::string
+		{
+			return ut::sprintf(p_fmt, ::std::get<Is>(p_args)...);
+		}
+
+		// Restore captured format string and arguments and format them. This is what runs on the worker thread.
+		template< typename... Ts >
+		auto render_arguments(const unsigned char* p_buffer)
+			-> ::std::string
+		{
+			const auto t_fmt = reinterpret_cast<const char*>(p_buffer);
+			argument_reader t_reader{ p_buffer + ::std::strlen(t_fmt) + 1 };
+
+			// Braced initialization guarantees left-to-right evaluation
+			const ::std::tuple<restored_type<Ts>...> t_args{ t_reader.template read<Ts>()... };
+
+			return apply_format(t_fmt, t_args, ::std::index_sequence_for<Ts...>{});
+		}
+	}
+
+	// A format string together with its captured arguments. Formatting is
+	// deferred until the text is actually needed, which usually happens on the
+	// logger worker thread.
+	class deferred_format
+	{
+		using render_type = ::std::string(*)(const unsigned char*);
+		using buffer_type = ::std::array<unsigned char, LIBLOG_DEFERRED_BUFFER_SIZE>;
+
+		public:
+			deferred_format() = default;
+
+			deferred_format(const deferred_format&) = default;
+			deferred_format(deferred_format&&) = default;
+
+			deferred_format& operator=(const deferred_format&) = default;
+			deferred_format& operator=(deferred_format&&) = default;
+
+		public:
+			// Capture given format string and arguments. Both are copied.
+			template< typename... Ts >
+			static auto capture(const char* p_fmt, Ts&&... p_args)
+				-> deferred_format
+			{
+				deferred_format t_fmt{ };
+				internal::argument_writer t_writer{ t_fmt.m_Arguments.data(), t_fmt.m_Arguments.data() + t_fmt.m_Arguments.size() };
+				
+				t_writer.write_format(p_fmt);
+
+				// Expansion trick to write all arguments in order
+				using expand = int[];
+				(void)expand{ 0, (t_writer.write(p_args), 0)... };
+
+				if(t_writer.overflow())
+				{
+					// Format string and arguments did not fit into the inline buffer. Format them right away.
+					t_fmt.m_Text = ut::sprintf(p_fmt, ::std::forward<Ts>(p_args)...);
+				}
+				else t_fmt.m_Render = &internal::render_arguments<::std::decay_t<Ts>...>;
+
+				return t_fmt;
+			}
+
+			// Format already rendered text. Used when formatting can not be deferred.
+			static auto text(::std::string p_str)
+				-> deferred_format
+			{
+				deferred_format t_fmt{ };
+				t_fmt.m_Text = ::std::move(p_str);
+				return t_fmt;
+			}
+
+		public:
+			// Format captured arguments
+			auto str() const
+				-> ::std::string
+			{
+				if(m_Render != nullptr)
+					return m_Render(m_Arguments.data());
+				else return m_Text;
+			}
+
+			// Whether this object holds arguments that still have to be formatted
+			auto deferred() const
+				-> bool
+			{
+				return m_Render != nullptr;
+			}
+
+			auto empty() const
+				-> bool
+			{
+				return m_Render == nullptr && m_Text.empty();
+			}
+
+		private:
+			render_type m_Render{nullptr};		//< Type-erased function restoring and formatting the arguments
+			buffer_type m_Arguments;			//< Captured format string, followed by the arguments
+			::std::string m_Text{ };			//< Formatted text, if formatting could not be deferred
+	};
+
+	namespace internal
+	{
+		template< typename Tfmt, typename... Ts >
+		auto format_impl(::std::true_type, Tfmt&& p_fmt, Ts&&... p_args)
+			-> deferred_format
+		{
+			return deferred_format::capture(format_string(p_fmt), ::std::forward<Ts>(p_args)...);
+		}
+
+		template< typename Tfmt, typename... Ts >
+		auto format_impl(::std::false_type, Tfmt&& p_fmt, Ts&&... p_args)
+			-> deferred_format
+		{
+			return deferred_format::text(ut::sprintf(::std::forward<Tfmt>(p_fmt), ::std::forward<Ts>(p_args)...));
+		}
+	}
+
+	// Create a format object that can be streamed into a log entry.
+	// Formatting is deferred to the worker thread if all arguments are arithmetic,
+	// enumerations, pointers or strings, and fit into the capture buffer along with
+	// the format string. The format string and string arguments are copied. In all
+	// other cases the text is formatted right away.
+	template< typename Tfmt, typename... Ts >
+	auto format(Tfmt&& p_fmt, Ts&&... p_args)
+		-> deferred_format
+	{
+		return internal::format_impl(
+			internal::is_deferrable<Tfmt, Ts...>{},
+			::std::forward<Tfmt>(p_fmt),
+			::std::forward<Ts>(p_args)...
+		);
+	}
+}
@@ -0,0 +1,300 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <ut/observer_ptr.hxx>
+
+#include "log_entry.hxx"
+#include "log_target.hxx"
+#include "ring_buffer.hxx"
+#include "logger_stats.hxx"
+#include "rcu_snapshot.hxx"
+
+namespace lg
+{
+	// Settings of a dispatch lane
+	struct lane_options
+	{
+		::std::size_t m_MaxBacklog{65536};					//< Maximum number of entries waiting for the lane. Zero means unlimited.
+		overflow_policy m_Policy{overflow_policy::block};	//< What to do with new entries if the backlog is full
+	};
+
+	// Information about a single dispatch lane
+	struct lane_info
+	{
+		::std::string m_Name;				//< Name of the lane
+		::std::size_t m_Targets;			//< Number of log targets served by the lane
+		::std::size_t m_Backlog;			//< Number of entries not yet written by the lane
+		::std::uint64_t m_Dispatched;		//< Number of entries the lane has written so far
+		::std::uint64_t m_Dropped;			//< Number of entries discarded due to a full backlog
+		::std::chrono::nanoseconds m_Lag;	//< Age of the oldest entry not yet written
+	};
+
+	namespace internal
+	{
+		// Completion of a flush request, shared by the requesting thread and all lanes the
+		// request was published to. Complete once every one of them wrote the preceding
+		// entries and flushed the targets of the requesting logger.
+		class flush_barrier
+		{
+			public:
+				flush_barrier() = default;
+				
+				flush_barrier(const flush_barrier&) = delete;
+				flush_barrier& operator=(const flush_barrier&) = delete;
+				
+			public:
+				// Let the barrier wait for given number of lanes. Called once it was published.
+				auto expect(::std::size_t p_lanes)
+					-> void;
+					
+				// Signal that a lane is done
+				auto arrive()
+					-> void;
+					
+				// Block until complete or given time elapsed. Returns whether the barrier completed.
+				auto wait_for(::std::chrono::nanoseconds p_timeout)
+					-> bool;
+					
+			private:
+				::std::mutex m_Mtx;
+				::std::condition_variable m_Cv;
+				::std::size_t m_Remaining{0};	//< Number of lanes that did not arrive yet
+				bool m_Published{false};		//< Whether the number of lanes is known
+		};
+		
+		using barrier_ptr = ::std::shared_ptr<flush_barrier>;
+	
+		// Entries collected by the worker thread in one go. Batches are immutable once
+		// published, which allows all lanes to read them concurrently.
+		struct entry_batch
+		{
+			::std::vector<log_entry> m_Entries;
+			::std::vector<const log_entry*> m_Pointers;
+			::std::uint64_t m_Owner{0};		//< Id of the logger that published the batch
+			::std::vector<barrier_ptr> m_Barriers;	//< Flush requests completed by writing this batch. Such batches are never dropped.
+		};
+		
+		using batch_ptr = ::std::shared_ptr<const entry_batch>;
+		
+		// Keeps the storage of batches all lanes are done with, so that the worker thread
+		// can reuse it instead of allocating new storage for every batch. Batches are
+		// cleared by the lane releasing them last.
+		class batch_pool
+		{
+			// Number of batches kept for reuse
+			static constexpr ::std::size_t max_batches = 4;
+			
+			// Batches with more room than this are freed, in order to give memory back after bursts
+			static constexpr ::std::size_t max_capacity = 65536;
+		
+			public:
+				batch_pool() = default;
+				
+				batch_pool(const batch_pool&) = delete;
+				batch_pool& operator=(const batch_pool&) = delete;
+				
+			public:
+				// Retrieve empty batch, reusing released storage if possible
+				auto acquire()
+					-> ::std::unique_ptr<entry_batch>;
+					
+				// Share given batch with the lanes. It is returned to this pool once all of them released it.
+				auto share(::std::unique_ptr<entry_batch> p_batch)
+					-> batch_ptr;
+					
+				// Block until every shared batch was released by all lanes
+				auto wait_released()
+					-> void;
+					
+			private:
+				auto release(entry_batch* p_batch)
+					-> void;
+					
+			private:
+				::std::mutex m_Mtx;
+				::std::condition_variable m_ReleaseCv;
+				::std::size_t m_Shared{0};		//< Number of batches still referenced by a lane
+				::std::vector<::std::unique_ptr<entry_batch>> m_Free;
+		};
+	
+		// Group of log targets served by its own thread. Every lane keeps a queue of
+		// references to shared batches, which are released once all lanes wrote them.
+		// A slow target thus only delays the targets of its own lane.
+		// After writing a batch that carries flush requests, the lane flushes all
+		// targets of the publishing logger before signalling them.
+		// Lanes can be shared by several loggers. Every target only receives the batches
+		// of the logger it was added to.
+		// The target list is an immutable snapshot, which the lane thread reads without
+		// locking. Changing it never waits for a batch to be written, only removing or
+		// replacing a target waits for the lane thread to let go of the old list.
+		class dispatch_lane
+		{
+			using batch_type = ::std::vector<const log_entry*>;
+			
+			// Statistics of a single target. Only written by the lane thread.
+			struct target_counters
+			{
+				::std::atomic<::std::uint64_t> m_Writes{0};
+				::std::atomic<::std::uint64_t> m_Entries{0};
+				::std::atomic<::std::uint64_t> m_Bytes{0};
+				::std::atomic<::std::int64_t> m_Nanoseconds{0};
+			};
+			
+			struct target_slot
+			{
+				ut::observer_ptr<log_target> m_Target;
+				::std::uint64_t m_Owner;							//< Id of the logger the target belongs to
+				::std::shared_ptr<target_counters> m_Counters;		//< Kept if the target is replaced
+			};
+			
+			using container_type = ::std::vector<target_slot>;
+		
+			public:
+				dispatch_lane(const ::std::string& p_name, const lane_options& p_options);
+				~dispatch_lane();
+				
+				dispatch_lane(const dispatch_lane&) = delete;
+				dispatch_lane(dispatch_lane&&) = delete;
+
+				dispatch_lane& operator=(const dispatch_lane&) = delete;
+				dispatch_lane& operator=(dispatch_lane&&) = delete;
+				
+			public:
+				// Count one more target before it is added, so that the lane is no longer considered idle
+				auto reserve_target()
+					-> void;
+					
+				// Add target that receives the batches published by the logger with given id.
+				// The target has to be reserved before.
+				auto add_target(ut::observer_ptr<log_target> p_target, ::std::uint64_t p_owner)
+					-> void;
+					
+				// Remove target of given logger. Returns once the lane thread no longer uses it.
+				// Entries not yet written are not delivered to it anymore. Returns false if
+				// the target is not served by this lane.
+				auto remove_target(ut::observer_ptr<log_target> p_target, ::std::uint64_t p_owner)
+					-> bool;
+					
+				// Let given target take the place of a target of given logger, including its statistics.
+				// Returns once the lane thread no longer uses the old target. Entries not yet written
+				// are delivered to the new one. Returns false if the old target is not served by this lane.
+				auto replace_target(ut::observer_ptr<log_target> p_old, ut::observer_ptr<log_target> p_new, ::std::uint64_t p_owner)
+					-> bool;
+					
+				// Most verbose threshold of all targets of given logger, or -1 if it has none in this lane
+				auto max_level(::std::uint64_t p_owner) const
+					-> int;
+				
+				// Queue batch for dispatch. Depending on the overflow policy, this might block
+				// until the lane caught up. Batches carrying flush requests are only dropped
+				// once the lane was closed, which completes the requests.
+				auto publish(const batch_ptr& p_batch)
+					-> void;
+					
+				// Write all remaining batches and stop the lane thread
+				auto close()
+					-> void;
+					
+				auto info() const
+					-> lane_info;
+					
+				// Append statistics of all targets of this lane that belong to given logger
+				auto collect_stats(::std::vector<target_stats>& p_stats, ::std::uint64_t p_owner) const
+					-> void;
+					
+				auto name() const
+					-> const ::std::string&;
+					
+				auto options() const
+					-> const lane_options&;
+					
+				// Number of targets of all loggers served by this lane, including reserved ones
+				auto target_count() const
+					-> ::std::size_t;
+				
+			private:
+				// Lane thread function
+				auto do_work()
+					-> void;
+					
+				// Write those entries of given batch that pass the threshold of given log target
+				auto dispatch(log_target& p_target, target_counters& p_counters, const batch_type& p_batch)
+					-> void;
+			
+			private:
+				const ::std::string m_Name;
+				const lane_options m_Options;
+				
+				mutable ::std::mutex m_Mtx;					//< Guards the pending batches and statistics
+				::std::condition_variable m_WorkCv;			//< Signalled when a batch was published
+				::std::condition_variable m_SpaceCv;		//< Signalled when the lane finished a batch
+				::std::deque<batch_ptr> m_Pending;			//< Batches not yet written
+				batch_ptr m_Current;						//< Batch currently being written
+				::std::size_t m_Backlog{0};					//< Number of entries in m_Pending and m_Current
+				::std::uint64_t m_Dispatched{0};
+				::std::uint64_t m_Dropped{0};
+				::std::size_t m_TargetCount{0};				//< Number of targets, which can be read without the target list
+				bool m_Closed{false};
+				
+				rcu_snapshot<container_type> m_Targets;		//< Targets of all loggers served by this lane
+				batch_type m_Filtered;						//< Entries of the current batch that pass the threshold of a target
+				
+				::std::thread m_Worker;
+		};
+	}
+	
+	// Set of dispatch lanes, which can be shared by several loggers. Loggers using
+	// the same pool share the threads of all lanes they give the same name.
+	class dispatch_pool
+	{
+		public:
+			dispatch_pool() = default;
+			
+			dispatch_pool(const dispatch_pool&) = delete;
+			dispatch_pool& operator=(const dispatch_pool&) = delete;
+			
+		public:
+			// Retrieve lane with given name, creating it with given options if it does not exist yet.
+			// An empty name retrieves an anonymous lane without targets, which is created if
+			// all anonymous lanes with the same options serve targets. A target is reserved on
+			// the returned lane while the pool is locked, which the caller has to add.
+			auto lane(const ::std::string& p_name, const lane_options& p_options)
+				-> internal::dispatch_lane&;
+				
+		private:
+			struct pooled_lane
+			{
+				::std::unique_ptr<internal::dispatch_lane> m_Lane;
+				bool m_Anonymous;
+			};
+			
+		private:
+			::std::mutex m_Mtx;
+			::std::vector<pooled_lane> m_Lanes;		//< Lanes are never removed, anonymous ones are reused once their targets were removed
+	};
+}
@@ -0,0 +1,108 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if !defined(__linux__)
+#	include <mutex>
+#	include <condition_variable>
+#endif
+
+namespace lg
+{
+	namespace internal
+	{
+		// Lets a single consumer thread park until a producer rings. The consumer announces
+		// that it is about to park by changing its state, which producers check after
+		// queueing their data. Ringing thus only costs a system call if the consumer actually
+		// sleeps. On Linux, parking is implemented with a futex, elsewhere with a condition variable.
+		//
+		// Producers have to issue a sequentially consistent fence between queueing their data
+		// and reading state(), and the consumer has to check for data after prepare_park(),
+		// so that one of both always notices the other.
+		class doorbell
+		{
+			public:
+				// States of the consumer. Values other than awake are chosen by the consumer
+				// and tell producers under which condition they have to ring.
+				static constexpr ::std::uint32_t awake = 0;
+				
+			public:
+				doorbell() = default;
+				
+				doorbell(const doorbell&) = delete;
+				doorbell& operator=(const doorbell&) = delete;
+				
+			public:
+				// Announce that the consumer is about to park in given state. Returns the ticket
+				// that has to be passed to park().
+				auto prepare_park(::std::uint32_t p_state)
+					-> ::std::uint32_t;
+					
+				// Return to the awake state without parking, e.g. because data was found
+				auto cancel_park()
+					-> void
+				{
+					m_State.store(awake, ::std::memory_order_relaxed);
+				}
+				
+				// Block until a producer rang after given ticket was drawn, or the timeout elapsed.
+				// A timeout of zero waits indefinitely.
+				auto park(::std::uint32_t p_ticket, ::std::chrono::nanoseconds p_timeout)
+					-> void;
+					
+				// Current state of the consumer
+				auto state() const
+					-> ::std::uint32_t
+				{
+					return m_State.load(::std::memory_order_relaxed);
+				}
+				
+				// Wake up the consumer if it is parked. Only the first of several producers
+				// ringing at once issues the wakeup.
+				auto ring()
+					-> void
+				{
+					if(m_State.exchange(awake) != awake)
+						wake();
+				}
+				
+				// Wake up the consumer regardless of its state
+				auto force_ring()
+					-> void
+				{
+					m_State.store(awake);
+					wake();
+				}
+				
+			private:
+				auto wake()
+					-> void;
+					
+			private:
+				::std::atomic<::std::uint32_t> m_State{awake};	//< State of the consumer
+				::std::atomic<::std::uint32_t> m_Epoch{0};		//< Incremented on every wakeup. The futex word on Linux.
+				
+#if !defined(__linux__)
+				::std::mutex m_Mtx;
+				::std::condition_variable m_Cv;
+#endif
+		};
+	}
+}
@@ -0,0 +1,215 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+
+namespace lg
+{
+	class log_entry;
+
+	// Read-only view of a sequence of log entries, in dispatch order.
+	// The entries themselves are not required to be stored contiguously.
+	class entry_span
+	{
+		public:
+			class iterator
+			{
+				public:
+					using iterator_category = ::std::random_access_iterator_tag;
+					using value_type = log_entry;
+					using difference_type = ::std::ptrdiff_t;
+					using pointer = const log_entry*;
+					using reference = const log_entry&;
+
+				public:
+					iterator() = default;
+				
+					iterator(const log_entry* const* p_ptr)
+						: m_Ptr{p_ptr}
+					{
+					}
+
+				public:
+					auto operator*() const
+						-> reference
+					{
+						return **m_Ptr;
+					}
+
+					auto operator->() const
+						-> pointer
+					{
+						return *m_Ptr;
+					}
+
+					auto operator++()
+						-> iterator&
+					{
+						++m_Ptr;
+						return *this;
+					}
+
+					auto operator++(int)
+						-> iterator
+					{
+						auto t_tmp = *this;
+						++m_Ptr;
+						return t_tmp;
+					}
+
+					auto operator--()
+						-> iterator&
+					{
+						--m_Ptr;
+						return *this;
+					}
+
+					auto operator--(int)
+						-> iterator
+					{
+						auto t_tmp = *this;
+						--m_Ptr;
+						return t_tmp;
+					}
+
+					auto operator+=(difference_type p_n)
+						-> iterator&
+					{
+						m_Ptr += p_n;
+						return *this;
+					}
+
+					auto operator-=(difference_type p_n)
+						-> iterator&
+					{
+						m_Ptr -= p_n;
+						return *this;
+					}
+
+					auto operator+(difference_type p_n) const
+						-> iterator
+					{
+						return { m_Ptr + p_n };
+					}
+
+					friend auto operator+(difference_type p_n, const iterator& p_it)
+						-> iterator
+					{
+						return p_it + p_n;
+					}
+
+					auto operator-(difference_type p_n) const
+						-> iterator
+					{
+						return { m_Ptr - p_n };
+					}
+
+					auto operator-(const iterator& p_other) const
+						-> difference_type
+					{
+						return m_Ptr - p_other.m_Ptr;
+					}
+
+					auto operator[](difference_type p_n) const
+						-> reference
+					{
+						return *m_Ptr[p_n];
+					}
+
+					auto operator==(const iterator& p_other) const
+						-> bool
+					{
+						return m_Ptr == p_other.m_Ptr;
+					}
+
+					auto operator!=(const iterator& p_other) const
+						-> bool
+					{
+						return m_Ptr != p_other.m_Ptr;
+					}
+
+					auto operator<(const iterator& p_other) const
+						-> bool
+					{
+						return m_Ptr < p_other.m_Ptr;
+					}
+
+					auto operator<=(const iterator& p_other) const
+						-> bool
+					{
+						return m_Ptr <= p_other.m_Ptr;
+					}
+
+					auto operator>(const iterator& p_other) const
+						-> bool
+					{
+						return m_Ptr > p_other.m_Ptr;
+					}
+
+					auto operator>=(const iterator& p_other) const
+						-> bool
+					{
+						return m_Ptr >= p_other.m_Ptr;
+					}
+
+				private:
+					const log_entry* const* m_Ptr{nullptr};
+			};
+
+		public:
+			entry_span(const log_entry* const* p_entries, ::std::size_t p_size)
+				: m_Entries{p_entries}, m_Size{p_size}
+			{
+			}
+
+		public:
+			auto begin() const
+				-> iterator
+			{
+				return { m_Entries };
+			}
+
+			auto end() const
+				-> iterator
+			{
+				return { m_Entries + m_Size };
+			}
+
+			auto size() const
+				-> ::std::size_t
+			{
+				return m_Size;
+			}
+
+			auto empty() const
+				-> bool
+			{
+				return m_Size == 0;
+			}
+
+			auto operator[](::std::size_t p_index) const
+				-> const log_entry&
+			{
+				return *m_Entries[p_index];
+			}
+
+		private:
+			const log_entry* const* m_Entries;
+			::std::size_t m_Size;
+	};
+}
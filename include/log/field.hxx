@@ -0,0 +1,303 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <ut/string_view.hxx>
+
+#include "slab_arena.hxx"
+
+// Number of bytes of structured fields stored inline in every log entry. Entries
+// with more fields spill to the slab arena of the producer thread.
+#ifndef LIBLOG_INLINE_FIELD_SIZE
+#	define LIBLOG_INLINE_FIELD_SIZE 64
+#endif
+
+namespace lg
+{
+	// Type of the value of a structured field
+	enum class field_type : ::std::uint8_t
+	{
+		boolean = 0,
+		signed_integer,
+		unsigned_integer,
+		floating_point,
+		string
+	};
+
+	// Typed key/value pair attached to a log entry. Key and string values refer to
+	// the storage of the entry.
+	class field
+	{
+		public:
+			field(ut::string_view p_key, field_type p_type, ::std::uint64_t p_bits, ut::string_view p_string)
+				: m_Key{p_key}, m_Type{p_type}, m_Bits{p_bits}, m_String{p_string}
+			{
+			}
+
+		public:
+			auto key() const
+				-> ut::string_view
+			{
+				return m_Key;
+			}
+
+			auto type() const
+				-> field_type
+			{
+				return m_Type;
+			}
+
+			auto as_bool() const
+				-> bool
+			{
+				return m_Bits != 0;
+			}
+
+			auto as_signed() const
+				-> ::std::int64_t
+			{
+				return static_cast<::std::int64_t>(m_Bits);
+			}
+
+			auto as_unsigned() const
+				-> ::std::uint64_t
+			{
+				return m_Bits;
+			}
+
+			auto as_double() const
+				-> double
+			{
+				double t_val;
+				::std::memcpy(&t_val, &m_Bits, sizeof(t_val));
+				return t_val;
+			}
+
+			auto as_string() const
+				-> ut::string_view
+			{
+				return m_String;
+			}
+
+		private:
+			ut::string_view m_Key;
+			field_type m_Type;
+			::std::uint64_t m_Bits;			//< Value of all non-string types
+			ut::string_view m_String;
+	};
+
+	// Print field as "key=value"
+	auto operator<<(::std::ostream& p_str, const field& p_field)
+		-> ::std::ostream&;
+
+	namespace internal
+	{
+		// Field that is about to be attached to a log entry. Created by lg::kv.
+		// String values are only referenced. This is safe, since the entry copies
+		// them before the end of the full-expression containing the LOG_* statement.
+		struct kv_t
+		{
+			const char* m_Key;
+			field_type m_Type;
+			::std::uint64_t m_Bits;			//< Value of all non-string types
+			const char* m_String;
+			::std::size_t m_Length;
+		};
+
+		// Compact binary record of all fields of a log entry. Every field is stored as
+		//	[u8]		Type
+		//	[u8]		Length of key, followed by the key
+		//	...			Value: One byte for booleans, eight bytes for numbers,
+		//				and a four byte length followed by the text for strings
+		// in native byte order. Values are never converted to text by the producer.
+		class field_record
+		{
+			public:
+				class const_iterator
+				{
+					public:
+						using iterator_category = ::std::forward_iterator_tag;
+						using value_type = field;
+						using difference_type = ::std::ptrdiff_t;
+						using pointer = void;
+						using reference = field;
+
+					public:
+						const_iterator(const char* p_pos)
+							: m_Pos{p_pos}
+						{
+						}
+
+					public:
+						auto operator*() const
+							-> field;
+
+						auto operator++()
+							-> const_iterator&;
+
+						auto operator==(const const_iterator& p_other) const
+							-> bool
+						{
+							return m_Pos == p_other.m_Pos;
+						}
+
+						auto operator!=(const const_iterator& p_other) const
+							-> bool
+						{
+							return m_Pos != p_other.m_Pos;
+						}
+
+					private:
+						const char* m_Pos;
+				};
+
+			public:
+				field_record() = default;
+				~field_record();
+
+				field_record(field_record&&);
+				field_record& operator=(field_record&&);
+
+				field_record(const field_record&) = delete;
+				field_record& operator=(const field_record&) = delete;
+
+			public:
+				auto append(const kv_t& p_field)
+					-> void;
+
+				auto size() const
+					-> ::std::size_t
+				{
+					return m_Count;
+				}
+
+				auto empty() const
+					-> bool
+				{
+					return m_Count == 0;
+				}
+
+				// Binary representation of all fields, which allows comparing records
+				auto bytes() const
+					-> ut::string_view
+				{
+					return ut::string_view{ data(), m_Size };
+				}
+
+				auto begin() const
+					-> const_iterator
+				{
+					return { data() };
+				}
+
+				auto end() const
+					-> const_iterator
+				{
+					return { data() + m_Size };
+				}
+
+			private:
+				auto data() const
+					-> const char*
+				{
+					return m_Heap.m_Data ? m_Heap.m_Data : m_Inline;
+				}
+
+				auto reserve(::std::size_t p_required)
+					-> char*;
+
+				auto release()
+					-> void;
+
+			private:
+				::std::uint32_t m_Size{0};
+				::std::uint32_t m_Capacity{LIBLOG_INLINE_FIELD_SIZE};
+				::std::uint32_t m_Count{0};
+				arena_block m_Heap{ };
+				char m_Inline[LIBLOG_INLINE_FIELD_SIZE];
+		};
+
+		inline auto make_kv(const char* p_key, field_type p_type, ::std::uint64_t p_bits)
+			-> kv_t
+		{
+			return kv_t{ p_key, p_type, p_bits, nullptr, 0 };
+		}
+
+		inline auto make_kv(const char* p_key, const char* p_str, ::std::size_t p_len)
+			-> kv_t
+		{
+			return kv_t{ p_key, field_type::string, 0, p_str, p_len };
+		}
+	}
+
+	// Create a structured field, e.g. LOG_I() << lg::kv("user_id", id). Keys longer than
+	// 255 characters are truncated.
+	template< typename T >
+	auto kv(const char* p_key, T p_value)
+		-> ::std::enable_if_t<::std::is_integral<T>::value && ::std::is_signed<T>::value, internal::kv_t>
+	{
+		return internal::make_kv(p_key, field_type::signed_integer, static_cast<::std::uint64_t>(static_cast<::std::int64_t>(p_value)));
+	}
+
+	template< typename T >
+	auto kv(const char* p_key, T p_value)
+		-> ::std::enable_if_t<::std::is_integral<T>::value && ::std::is_unsigned<T>::value && !::std::is_same<T, bool>::value, internal::kv_t>
+	{
+		return internal::make_kv(p_key, field_type::unsigned_integer, static_cast<::std::uint64_t>(p_value));
+	}
+
+	template< typename T >
+	auto kv(const char* p_key, T p_value)
+		-> ::std::enable_if_t<::std::is_floating_point<T>::value, internal::kv_t>
+	{
+		const auto t_val = static_cast<double>(p_value);
+		::std::uint64_t t_bits;
+		::std::memcpy(&t_bits, &t_val, sizeof(t_bits));
+
+		return internal::make_kv(p_key, field_type::floating_point, t_bits);
+	}
+
+	inline auto kv(const char* p_key, bool p_value)
+		-> internal::kv_t
+	{
+		return internal::make_kv(p_key, field_type::boolean, p_value ? 1u : 0u);
+	}
+
+	inline auto kv(const char* p_key, const char* p_value)
+		-> internal::kv_t
+	{
+		return internal::make_kv(p_key, p_value, ::std::char_traits<char>::length(p_value));
+	}
+
+	inline auto kv(const char* p_key, const ::std::string& p_value)
+		-> internal::kv_t
+	{
+		return internal::make_kv(p_key, p_value.data(), p_value.length());
+	}
+
+	inline auto kv(const char* p_key, ut::string_view p_value)
+		-> internal::kv_t
+	{
+		return internal::make_kv(p_key, p_value.data(), p_value.length());
+	}
+}
@@ -0,0 +1,66 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+
+namespace lg
+{
+	namespace internal
+	{
+		// Output file owning the descriptor that is written to. Syncing uses that very
+		// descriptor, so it always reaches the file the data went to, even if the path
+		// was renamed or unlinked in the meantime.
+		class output_file
+		{
+			public:
+				// Open file at given path, either appending to or truncating it
+				output_file(const ::std::string& p_path, bool p_append, bool p_binary);
+				
+				// Flushes and closes the file
+				~output_file();
+				
+				output_file(const output_file&) = delete;
+				output_file& operator=(const output_file&) = delete;
+				
+			public:
+				auto write(const char* p_data, ::std::size_t p_len)
+					-> void;
+					
+				// Hand buffered data to the operating system. Returns whether that succeeded.
+				auto flush()
+					-> bool;
+					
+				// Flush and wait until the file contents reached the storage device. Returns false if
+				// that failed, or if any write since the last sync failed.
+				auto sync()
+					-> bool;
+					
+				// Current size of the file, including buffered data
+				auto size()
+					-> ::std::uint64_t;
+					
+				auto is_open() const
+					-> bool;
+				
+			private:
+				::std::FILE* m_File{nullptr};
+		};
+	}
+}
@@ -0,0 +1,138 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+// Flight recorders are only available on POSIX systems
+#if !defined(_WIN32)
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "log_target.hxx"
+#include "log_entry.hxx"
+#include "protocol_decoder.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		// Identifies the memory region of a flight recorder, in dumps as well as in core files
+		constexpr char flight_magic[16] = { 'L', 'I', 'B', 'L', 'O', 'G', '-', 'F', 'L', 'I', 'G', 'H', 'T', 'R', 'E', 'C' };
+		constexpr ::std::uint32_t flight_version = 1;
+		constexpr ::std::uint32_t flight_byte_order = 0x01020304;
+
+		// Start of the memory region of a flight recorder. The record data directly follows it.
+		struct flight_header
+		{
+			char m_Magic[16];
+			::std::uint32_t m_Version;
+			::std::uint32_t m_ByteOrder;				//< Allows readers to detect dumps of foreign machines
+			::std::uint64_t m_Capacity;					//< Size of the record data, a multiple of 8
+			::std::atomic<::std::uint64_t> m_Position;	//< Total number of bytes ever reserved
+			::std::uint64_t m_Reserved[3];
+		};
+
+		// Fixed part of every record. Records are stored back to back, wrapping around at
+		// the end of the data, and padded to a multiple of 8 bytes. Their file, tag and
+		// message strings follow the fixed part. All fields are in native byte order.
+		struct flight_record
+		{
+			::std::uint32_t m_Position;			//< Lower 32 bits of the position the record starts at. Written last,
+												//  so readers can tell complete records apart from overwritten data.
+			::std::uint32_t m_Length;			//< Total length, including padding
+			::std::int64_t m_Time;				//< Nanoseconds since epoch
+			::std::uint32_t m_Thread;
+			::std::uint32_t m_Line;
+			::std::uint8_t m_Level;
+			::std::uint8_t m_Flags;				//< Bit 0: Is bare?
+			::std::uint16_t m_FileLength;
+			::std::uint16_t m_TagLength;
+			::std::uint16_t m_Reserved;
+			::std::uint32_t m_MessageLength;
+			::std::uint32_t m_Reserved2;
+		};
+
+		static_assert(sizeof(flight_header) == 64, "Unexpected flight recorder header layout");
+		static_assert(sizeof(flight_record) == 40, "Unexpected flight recorder record layout");
+	}
+
+	// Log target keeping the most recent entries, by default at full debug verbosity, as binary
+	// records in a fixed-size, lock-free circular buffer in memory. Nothing is written to disk
+	// until the buffer is dumped, which happens when a fatal entry is written, on request, or
+	// on a fatal signal if the crash handler was installed. Dumping is async-signal-safe.
+	// Dumps and core files of the process can be read using the log_flightrec tool.
+	class flight_recorder_target
+		: public log_target
+	{
+		public:
+			// Create recorder with given capacity in bytes, dumping into the file at given path.
+			flight_recorder_target(::std::size_t p_capacity, const ::std::string& p_dumpPath, severity_level p_lvl = severity_level::debug);
+			~flight_recorder_target();
+
+			flight_recorder_target(const flight_recorder_target&) = delete;
+			flight_recorder_target& operator=(const flight_recorder_target&) = delete;
+
+		public:
+			virtual void write(const log_entry& entry) override;
+			virtual void write_batch(entry_span entries) override;
+
+		public:
+			// Store given entry. Safe to be called by multiple threads at once.
+			auto record(const log_entry& p_entry)
+				-> void;
+
+			// Write the whole buffer to the dump file. Only uses async-signal-safe functions.
+			// Returns false if the dump file could not be written.
+			auto dump() const
+				-> bool;
+
+			// Dump this recorder on SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT, which also covers
+			// std::terminate. The previous handlers are invoked afterwards. Only one recorder can be
+			// registered this way, later calls replace it. The calling thread gets an alternate
+			// signal stack, see install_signal_stack.
+			auto install_crash_handler()
+				-> void;
+
+			// Give the calling thread an alternate signal stack, unless it already has one. The crash
+			// handler runs on it, so that a stack overflow in that thread still leads to a dump.
+			// Without one, the handler runs on the regular stack of the crashing thread.
+			static auto install_signal_stack()
+				-> void;
+
+		private:
+			// Copy given data to given position, wrapping around at the end of the buffer
+			auto copy_to(::std::uint64_t p_pos, const void* p_data, ::std::size_t p_len)
+				-> void;
+
+		private:
+			::std::unique_ptr<::std::uint64_t[]> m_Storage;		//< Header followed by the record data
+			internal::flight_header* m_Header;
+			char* m_Data;
+			::std::size_t m_Capacity;
+			::std::string m_DumpPath;
+	};
+
+	// Locate all flight recorder regions in given memory, e.g. a dump or a core file, and append
+	// their records to given vector, oldest first. Returns the number of regions found.
+	auto read_flight_records(const char* p_data, ::std::size_t p_len, ::std::vector<decoded_record>& p_records)
+		-> ::std::size_t;
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <chrono>
+
+#include "severity_level.hxx"
+#include "entry_span.hxx"
+#include "log_entry.hxx"
+
+namespace lg
+{
+	// Decides when a stream based log target flushes its output stream.
+	// A flush happens after writing a batch that contains an entry at least as severe
+	// as the configured level, or once the configured interval has passed since the
+	// last flush. The interval is only checked when a batch is written.
+	class flush_policy
+	{
+		using clock_type = ::std::chrono::steady_clock;
+
+		public:
+			// Flush after every batch. This is the default.
+			static auto per_batch()
+				-> flush_policy
+			{
+				return flush_policy{ ::std::chrono::milliseconds{0}, severity_level::debug };
+			}
+
+			// Flush if at least given amount of time passed since the last flush.
+			// Entries of level error or more severe are always flushed right away.
+			static auto interval(::std::chrono::milliseconds p_interval)
+				-> flush_policy
+			{
+				return flush_policy{ p_interval, severity_level::error };
+			}
+
+			// Flush only if the batch contains an entry of given level or a more severe one
+			static auto on_level(severity_level p_lvl)
+				-> flush_policy
+			{
+				return flush_policy{ ::std::chrono::milliseconds::max(), p_lvl };
+			}
+
+		public:
+			flush_policy(::std::chrono::milliseconds p_interval, severity_level p_lvl)
+				: m_Interval{p_interval}, m_Level{p_lvl}
+			{
+			}
+
+		public:
+			// Determine whether the stream has to be flushed after writing given batch
+			auto should_flush(entry_span p_entries)
+				-> bool
+			{
+				const auto t_now = clock_type::now();
+
+				bool t_flush = (m_Interval != ::std::chrono::milliseconds::max())
+								&& (t_now - m_LastFlush) >= m_Interval;
+
+				for(auto t_it = p_entries.begin(); !t_flush && t_it != p_entries.end(); ++t_it)
+				{
+					if(t_it->level() <= m_Level)
+						t_flush = true;
+				}
+
+				if(t_flush)
+					m_LastFlush = t_now;
+
+				return t_flush;
+			}
+
+		private:
+			::std::chrono::milliseconds m_Interval;			//< Maximum time between flushes
+			severity_level m_Level;							//< Entries of this level or more severe are flushed right away
+			clock_type::time_point m_LastFlush{ };			//< Time of the last flush
+	};
+}
@@ -0,0 +1,117 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+#include <ut/string_view.hxx>
+
+namespace lg
+{
+	class log_entry;
+
+	namespace internal
+	{
+		// Minimal JSON writer collecting output in a fixed buffer, which is handed to the
+		// output stream whenever it fills up. Never allocates.
+		class json_writer
+		{
+			public:
+				json_writer(::std::ostream& p_str)
+					: m_Str{p_str}
+				{
+				}
+
+				~json_writer()
+				{
+					flush();
+				}
+
+				json_writer(const json_writer&) = delete;
+				json_writer& operator=(const json_writer&) = delete;
+
+			public:
+				// Append text as it is
+				auto raw(const char* p_str, ::std::size_t p_len)
+					-> void;
+
+				auto raw(char p_chr)
+					-> void
+				{
+					if(m_Pos == sizeof(m_Buffer))
+						flush();
+
+					m_Buffer[m_Pos++] = p_chr;
+				}
+
+				// Append quoted and escaped string
+				auto string(ut::string_view p_str)
+					-> void;
+
+				auto number(::std::int64_t p_val)
+					-> void;
+
+				auto number(::std::uint64_t p_val)
+					-> void;
+
+				// Non-finite values are written as null, since JSON can not represent them
+				auto number(double p_val)
+					-> void;
+
+				auto boolean(bool p_val)
+					-> void;
+
+				// Append "key": including the separator of the previous member, if any
+				auto key(const char* p_key, ::std::size_t p_len)
+					-> void;
+
+				auto begin_object()
+					-> void;
+
+				auto end_object()
+					-> void;
+
+				auto flush()
+					-> void;
+
+			private:
+				// Make sure that given number of bytes fits into the buffer
+				auto reserve(::std::size_t p_len)
+					-> char*;
+
+			private:
+				::std::ostream& m_Str;
+				char m_Buffer[512];
+				::std::size_t m_Pos{0};
+				bool m_First{true};			//< Whether the next key is the first of its object
+		};
+	}
+
+	// Formats every entry as a single line containing a JSON object, e.g.
+	// {"ts":1476543210123456789,"level":"info","thread":1,"file":"main.cxx","line":12,
+	//  "tag":"net","msg":"Connected","fields":{"peer":"10.0.0.1","latency_us":125}}
+	// The timestamp is given in nanoseconds since the epoch. "tag" and "fields" are only
+	// present if the entry has a tag or fields, "bare" only if it is bare.
+	class json_formatter
+	{
+		public:
+			json_formatter() = default;
+
+		public:
+			void operator()(::std::ostream&, const log_entry&);
+	};
+}
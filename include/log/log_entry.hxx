@@ -16,20 +16,32 @@
 #pragma once
 
 #include <string>
-#include <sstream>
+#include <ostream>
 #include <ctime>
+#include <cstdint>
 #include <exception>
 #include <type_traits>
 #include <ut/console_color.hxx>
 #include <ut/type_traits.hxx>
+#include <ut/string_view.hxx>
 
 #include "severity_level.hxx"
 #include "tag.hxx"
+#include "deferred_format.hxx"
+#include "timestamp.hxx"
+#include "call_site.hxx"
+#include "message_buffer.hxx"
+#include "field.hxx"
 
 namespace lg
 {
 	namespace internal
 	{
+		// Marks an entry for synchronous delivery, see lg::sync
+		struct sync_t
+		{
+		};
+	
 		// Determines if given type is to be considered a "control type" in the
 		// context of the log entry. Examples for "control types" are exceptions,
 		// severity_level or tag_t
@@ -38,13 +50,34 @@ namespace lg
 									ut::contains<
 										T,
 										severity_level,
-										internal::tag_t
+										internal::tag_t,
+										internal::kv_t,
+										internal::sync_t,
+										deferred_format
 									>,
 									::std::is_base_of<::std::exception, T>
 								>;
 								
 		template< typename T >
-		constexpr bool is_control_type_v = is_control_type<T>::value;							
+		constexpr bool is_control_type_v = is_control_type<T>::value;
+		
+		// Types that are appended to the message without going through an output stream
+		template< typename T >
+		using is_plain_text = ut::contains<
+									T,
+									char*,
+									const char*,
+									::std::string,
+									char
+								>;
+	}
+
+	// Let the logging thread wait until the entry was written and flushed by all log targets,
+	// like logger::flush does. Inside of LOCK/UNLOCK blocks, waiting happens once the block ends.
+	inline auto sync()
+		-> internal::sync_t
+	{
+		return internal::sync_t{ };
 	}
 
 	class log_entry
@@ -57,46 +90,90 @@ namespace lg
 			log_entry& operator=(log_entry&&) = default;
 		
 		public:
-			log_entry(std::string file, size_t line);
-			log_entry(std::string file, size_t line, bool is_bare);
+			// Construct entry for given call site. The call site has to have static storage duration.
+			explicit log_entry(const call_site* site);
+			
+			// Construct entry with given creation time and thread id, e.g. in order to format records read back from storage
+			log_entry(const call_site* site, ::lg::timestamp p_time, ::std::uint32_t p_threadId);
 			
 		public:
-			log_entry operator<< (severity_level lvl) &&;
-			log_entry operator<< (ut::console_color clr) &&;
-			log_entry operator<< (const std::exception& ex) &&;
-			log_entry operator<< (internal::tag_t tag) &&;	// Passing by value is intended here in order to leverage move semantics
+			// All stream operators return an rvalue reference to this entry instead of
+			// a new object, so chaining them does not move the entry around.
+			log_entry&& operator<< (severity_level lvl) &&;
+			log_entry&& operator<< (ut::console_color clr) &&;
+			log_entry&& operator<< (const std::exception& ex) &&;
+			log_entry&& operator<< (internal::tag_t tag) &&;
+			log_entry&& operator<< (deferred_format&& fmt) &&;
+			log_entry&& operator<< (const internal::kv_t& kv) &&;	// Structured field, stored as typed value
+			log_entry&& operator<< (internal::sync_t) &&;
 
 			template<
 				typename T,
 				typename = ::std::enable_if_t<not internal::is_control_type_v<::std::decay_t<T>>>
 			>
-			log_entry operator<< (T&& t) &&
+			log_entry&& operator<< (T&& t) &&
 			{
-				m_Message << ::std::forward<T>(t);
+				append(::std::forward<T>(t));
 				return std::move(*this);
 			}
 
 		public:
 			bool bare() const;		
-			const std::time_t& time() const;
+			std::time_t time() const;
+			::lg::timestamp time_point() const;
 			std::string message() const;
-			const std::string& file() const;
-			const std::string& time_string() const;
+			ut::string_view message_view() const;	// View of the message text, which stays valid as long as the entry is not modified
+			const char* file() const;
+			const char* time_string() const;		// Time of day as "%H:%M:%S". Rendered on first request.
 			size_t line() const;
+			::std::uint32_t thread_id() const;		// Small number identifying the thread that created the entry
 			severity_level level() const;
 			std::string level_string() const;
 			ut::console_color color() const;
-			const ::std::string& tag() const;
+			const ::std::string& tag() const;		// Name of the tag, or an empty string if the entry is untagged
+			tag_id tag_index() const;				// Interned id of the tag, see tag_registry.hxx
+			const ::lg::call_site& site() const;
+			const internal::field_record& fields() const;	// Structured fields, in the order they were added
+			bool sync() const;						// Whether the entry was marked using lg::sync
+			
+		public:
+			// Render everything that is otherwise rendered lazily on first request. Afterwards,
+			// the entry can be read by multiple threads at once.
+			void prepare() const;
+			
+		private:
+			// Plain text is appended directly, everything else is formatted using
+			// the output stream of the calling thread
+			void append(const char* str);
+			void append(const std::string& str);
+			void append(char chr);
+		
+			template< typename T >
+			auto append(T&& t)
+				-> ::std::enable_if_t<not internal::is_plain_text<::std::decay_t<T>>::value>
+			{
+				stream() << ::std::forward<T>(t);
+			}
+			
+			std::ostream& stream();
+			
+			// Render deferred format arguments into the message, if there are any
+			void render() const;
 
 		private:
-			std::string			m_Tag{};
-			std::stringstream	m_Message;
-			std::string			m_Timestamp{};
-			std::string			m_File{};
-			bool				m_IsBare{};
-			size_t				m_Line{};
-			severity_level		m_Level{};
-			ut::console_color	m_Color{};
-			std::time_t			m_Time;
+			const ::lg::call_site*				m_Site;
+			mutable internal::message_buffer	m_Message{};
+			internal::field_record				m_Fields{};
+			mutable deferred_format				m_Deferred{};		// Format arguments that are rendered when the message is first requested
+			std::size_t							m_DeferredPos{};	// Position in the message the deferred text is inserted at
+			mutable char						m_TimeString[time_buffer_size]{};	// Cache for the rendered time of day
+			bool								m_IsBare{};
+			bool								m_StreamUsed{};		// Whether the output stream of the calling thread was already used for this entry
+			bool								m_Sync{};			// Whether the logging thread waits for the entry to be written
+			tag_id								m_Tag{};
+			severity_level						m_Level{};
+			ut::console_color					m_Color{};
+			::std::uint32_t						m_ThreadId;
+			::lg::timestamp						m_Time;
 	};
 }
@@ -20,6 +20,7 @@
 #include <ut/type_traits.hxx>
 
 #include "severity_level.hxx"
+#include "entry_span.hxx"
 
 namespace lg
 {
@@ -39,6 +40,22 @@ namespace lg
 
 		public:
 			virtual void write(const log_entry&) = 0;
+			
+			// Write a batch of entries, all of which already passed the severity threshold.
+			// The default implementation writes them one by one. Targets that can write
+			// many entries more efficiently at once should override this.
+			virtual void write_batch(entry_span p_entries)
+			{
+				for(const auto& t_entry : p_entries)
+					write(t_entry);
+			}
+			
+			// Hand everything written so far to the underlying device. Called after entries
+			// requiring synchronous delivery and by logger::flush. Targets writing to files
+			// also make the data durable. The default implementation does nothing.
+			virtual void flush()
+			{
+			}
 
 		public:
 			severity_level level() const
@@ -21,25 +21,134 @@
 #include <condition_variable>
 #include <thread>
 #include <mutex>
-#include <queue>
+#include <deque>
 #include <chrono>
 #include <atomic>
+#include <memory>
+#include <utility>
+#include <limits>
+#include <cstdint>
 #include <ut/observer_ptr.hxx>
 #include <ut/format.hxx>
 
 #include "log_entry.hxx"
+#include "tag_registry.hxx"
+#include "ring_buffer.hxx"
+#include "dispatch_lane.hxx"
+#include "logger_stats.hxx"
+#include "slab_arena.hxx"
+#include "rate_limit.hxx"
+#include "dedup_filter.hxx"
+#include "doorbell.hxx"
 
 namespace lg
 {
 	class log_target;
+	
+	namespace internal
+	{
+		// Most verbose severity level accepted by the default logger, or -1 if it has no
+		// log targets. Maintained by logger::add_target and logger::set_threshold and checked
+		// by the LOG_* macros before a log entry is constructed.
+		extern std::atomic<int> g_Verbosity;
+		
+		// Whether an entry of given severity level would reach at least one log target.
+		// The first check is a constant expression, which lets the compiler remove
+		// disabled LOG_* statements entirely.
+		inline bool level_enabled(severity_level p_lvl)
+		{
+			return static_cast<int>(p_lvl) <= LIBLOG_MIN_LEVEL
+				&& static_cast<int>(p_lvl) <= g_Verbosity.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Information about a single producer thread in ring buffer mode
+	struct producer_info
+	{
+		std::thread::id m_Thread;	//< Id of the producer thread
+		std::size_t m_Capacity;		//< Capacity of its ring buffer
+		std::size_t m_Dropped;		//< Number of entries dropped due to a full ring buffer
+	};
+
+	// How the worker thread waits for new entries
+	enum class wakeup_strategy
+	{
+		park,		//< Sleep until a producer rings. Producers only make a system call if the worker sleeps.
+		spin,		//< Poll for a bounded number of iterations before parking. Lowest latency, but keeps a core busy while entries trickle in.
+		batch		//< Once woken, wait until a number of entries is pending or a delay elapsed. Fewest wakeups under load.
+	};
+	
+	// Settings of the worker thread wakeup
+	struct wakeup_options
+	{
+		wakeup_strategy m_Strategy{wakeup_strategy::park};		//< Strategy to use
+		std::size_t m_SpinCount{20000};							//< Number of polls before parking, if spinning
+		std::size_t m_BatchSize{256};							//< Number of pending entries that end a batching wait
+		std::chrono::microseconds m_BatchDelay{1000};			//< Maximum duration of a batching wait
+	};
+
+	// Snapshot of the logger's self-instrumentation
+	struct logger_stats
+	{
+		std::uint64_t m_Enqueued;			//< Number of entries accepted from producer threads
+		std::uint64_t m_Dispatched;			//< Number of entries handed to the dispatch lanes, including self-reports
+		std::uint64_t m_Dropped;			//< Number of entries dropped due to full ring buffers
+		std::uint64_t m_LaneDropped;		//< Sum of the entries dropped by all dispatch lanes
+		std::uint64_t m_Deduplicated;		//< Number of entries removed as repetitions of their predecessor
+		std::size_t m_QueueDepth;			//< Number of entries waiting for the worker thread
+		std::size_t m_PeakQueueDepth;		//< Largest number of entries the worker thread collected at once
+		arena_stats m_Arena;				//< Memory usage of the message arenas
+		latency_histogram m_Latency;		//< Time from entry creation until the worker thread handed it to the lanes
+		std::vector<target_stats> m_Targets;	//< Write statistics of every log target
+		std::vector<lane_info> m_Lanes;		//< Backlog information of every dispatch lane
+	};
+
+	// Settings of a logger channel
+	struct channel_options
+	{
+		std::shared_ptr<dispatch_pool> m_Pool{ };			//< Lanes to dispatch on. Channels given the same pool share the threads of equally named lanes. Null creates a pool of its own.
+		severity_level m_Threshold{severity_level::debug};	//< Most verbose severity level the channel accepts
+	};
+	
+	class channel;
 
 	class logger
 	{
-		using container_type = std::vector<ut::observer_ptr<log_target>>;
-		using queue_type = std::queue<log_entry>;
+		friend class channel;
+	
+		using queue_type = std::vector<log_entry>;
+		using lane_container_type = std::vector<internal::dispatch_lane*>;
+		using ring_type = internal::ring_buffer<log_entry>;
+		
+		// Ring buffer owned by a single producer thread
+		struct producer
+		{
+			producer(std::size_t p_capacity, overflow_policy p_policy)
+				: m_Ring{p_capacity, p_policy}
+			{
+			}
+			
+			std::thread::id m_Thread{std::this_thread::get_id()};
+			ring_type m_Ring;
+			bool m_InBlock{false};		// Whether the thread is inside a LOCK/UNLOCK block. Only used by the owning thread.
+			bool m_BlockSync{false};	// Whether the current LOCK/UNLOCK block contains an entry requiring synchronous delivery
+		};
+		
+		using producer_ptr = std::shared_ptr<producer>;
+		using producer_container_type = std::vector<producer_ptr>;
+		using ring_list = std::vector<std::pair<std::uint64_t, producer_ptr>>;
+		
+		// Allows the channel registry to destroy loggers
+		struct deleter
+		{
+			void operator()(logger* p_logger) const
+			{
+				delete p_logger;
+			}
+		};
 		
 		private:
-			logger();
+			logger(const std::string& p_name, const channel_options& p_options, bool p_isDefault);
 			~logger();
 
 			logger(const logger&) = delete;
@@ -63,8 +172,82 @@ namespace lg
 			// (which automatic destruction not always does)
 			static void shutdown();
 			
-			// Add custom log target.
-			static void add_target(ut::observer_ptr<log_target> p_target);
+			// Block until all entries enqueued before the call were written by the log targets
+			// and every target was flushed, or given time elapsed. Returns whether flushing completed.
+			// Entries of a LOCK/UNLOCK block that is still open are not waited for. Must not be called
+			// inside of such a block or from a log target.
+			static bool flush(std::chrono::milliseconds p_timeout = std::chrono::seconds{5});
+			
+			// Let the logging thread wait for entries of given severity level or more severe ones
+			// to be delivered, as if flush was called right after them. Waiting ends after given time.
+			// Other entries are still delivered asynchronously, unless marked using lg::sync.
+			static void use_sync_delivery(severity_level p_lvl, std::chrono::milliseconds p_timeout = std::chrono::seconds{5});
+			
+			// Only wait for entries marked using lg::sync. This is the default.
+			static void use_async_delivery();
+			
+			// Add custom log target. Every target is served by a dispatch lane with its own thread,
+			// so a slow target can not delay others. Targets that are given the same lane name
+			// share one lane. Without a name, the target gets a lane of its own.
+			// The lane options are only used if the lane does not exist yet.
+			static void add_target(ut::observer_ptr<log_target> p_target, const std::string& p_lane = std::string{}, const lane_options& p_options = lane_options{});
+			
+			// Remove given log target. Returns once no dispatch lane uses it anymore, so it can be destroyed
+			// afterwards. Logging continues meanwhile. Entries not yet written are not delivered to it,
+			// call flush() beforehand to keep them. Must not be called from inside of a target.
+			// Returns false if the target was not added to this logger.
+			static bool remove_target(ut::observer_ptr<log_target> p_target);
+			
+			// Let a new log target take the place of an added one, e.g. in order to reopen a file.
+			// The new target is served by the same lane and receives all entries not yet written.
+			// Returns once no dispatch lane uses the old target anymore. Must not be called from inside of a target.
+			// Returns false if the old target was not added to this logger.
+			static bool replace_target(ut::observer_ptr<log_target> p_old, ut::observer_ptr<log_target> p_new);
+			
+			// Retrieve backlog and lag information about all dispatch lanes.
+			static std::vector<lane_info> lanes();
+			
+			// Change the most verbose severity level accepted by the LOG_* macros, regardless of
+			// the thresholds of the log targets. Takes effect immediately.
+			static void set_threshold(severity_level p_lvl);
+			
+			// Retrieve the threshold set by set_threshold.
+			static severity_level threshold();
+			
+			// Change how the worker thread waits for new entries. Takes effect the next time it waits.
+			static void set_wakeup(const wakeup_options& p_options);
+			
+			// Let every producer thread queue its entries into its own lock-free ring buffer
+			// with given capacity, instead of the shared mutex-guarded queue.
+			// Should be called before logging starts, since ring buffers that already
+			// exist keep their capacity and overflow policy.
+			static void use_ring_buffers(std::size_t p_capacity = 1024, overflow_policy p_policy = overflow_policy::block);
+			
+			// Switch back to the shared, mutex-guarded queue. This is the default.
+			static void use_shared_queue();
+			
+			// Retrieve information about all producer threads that currently own a ring buffer.
+			static std::vector<producer_info> producers();
+			
+			// Total number of entries dropped due to full ring buffers, including those
+			// of producer threads that already exited.
+			static std::size_t dropped();
+			
+			// Retrieve a snapshot of the logger statistics. The counters are maintained at all times,
+			// but cheap to update, since each of them is written by a single thread only.
+			static logger_stats stats();
+			
+			// Let the worker thread emit an info entry tagged with lg::stats_tag, summarizing
+			// the statistics, once per given interval. Zero disables self-reporting, which is the default.
+			static void self_report(std::chrono::milliseconds p_interval);
+			
+			// Change slab size and high-water mark of the arenas holding long messages.
+			// Slabs that already exist keep their size.
+			static void configure_arenas(const arena_options& p_options);
+			
+			// Collapse runs of identical consecutive entries into the first one, followed by an entry
+			// saying how often it was repeated. Long runs are summarized once per second. Disabled by default.
+			static void deduplicate(bool p_enable);
 
 		public:
 			// Queue new log entry for later processing and dispatching.
@@ -79,43 +262,155 @@ namespace lg
 			void unlock();
 
 		private:
-			void _add_target(ut::observer_ptr<log_target> p_target);
+			void _add_target(ut::observer_ptr<log_target> p_target, const std::string& p_lane, const lane_options& p_options);
+			bool _remove_target(ut::observer_ptr<log_target> p_target);
+			bool _replace_target(ut::observer_ptr<log_target> p_old, ut::observer_ptr<log_target> p_new);
+			std::vector<lane_info> _lanes();
+			void _set_threshold(severity_level p_lvl);
+			void _set_wakeup(const wakeup_options& p_options);
+			bool _flush(std::chrono::nanoseconds p_timeout);
+			void _use_sync_delivery(severity_level p_lvl, std::chrono::milliseconds p_timeout);
+			void _self_report(std::chrono::milliseconds p_interval);
+			void _use_ring_buffers(std::size_t p_capacity, overflow_policy p_policy);
+			std::vector<producer_info> _producers();
+			std::size_t _dropped();
+			logger_stats _stats();
+			
+		private:
+			// Retrieve ring buffer of the calling thread, creating it on first use
+			producer& local_producer();
+			
+			// Retrieve ring buffer of the calling thread, or nullptr if it has none yet
+			producer* find_producer();
+			
+			// Ring buffers of the calling thread, one for every logger it wrote to, keyed by logger id
+			static ring_list& thread_rings();
+			
+			// Move all entries waiting in producer ring buffers into given queue.
+			// Returns true if at least one entry was moved.
+			bool drain_producers(queue_type&);
 			
 		private:
 			// Worker thread function
 			void do_work();
 			
-			// Notify worker thread of new data
-			void notify();
+			// Block worker thread until entries are pending, according to the wakeup strategy
+			void wait_for_work();
+			
+			// Number of entries waiting for the worker thread that it could take right now
+			std::size_t pending();
+			
+			// Whether the worker thread has anything to do right now
+			bool has_work();
+			
+			// Take all flush requests made so far. They are published along with the next batch.
+			void take_flush_requests();
+			
+			// Wait for delivery of an entry requiring it
+			void wait_delivery();
+			
+			// Longest time the worker thread may park without missing a periodic duty, or zero if unbounded
+			std::chrono::nanoseconds idle_timeout();
+			
+			// Notify worker thread of new data, of which there are given number of entries waiting.
+			// Only makes a system call if the worker thread is parked and interested in that many entries.
+			void notify(std::size_t p_pending = std::numeric_limits<std::size_t>::max());
 			
 			// Request worker thread shutdown
 			void kill_thread();
 			
-			// Dispatch log entry to all registered log targets
-			void dispatch(const log_entry&);
+			// Hand all log entries in given queue to all dispatch lanes as one shared batch,
+			// along with the flush requests taken so far
+			void publish(queue_type&);
+			
+			// Append a self-report entry to given queue if one is due
+			void report(queue_type&);
+			
+			// Apply duplicate suppression to given queue, if enabled. Summarizes the current
+			// run regardless of its age if requested.
+			void deduplicate(queue_type&, bool p_finish);
 			
-			// Dispatch all log entries in given queue
-			void dispatch_all(queue_type&);
+			// Recompute the level checked before entries are constructed. Requires m_DataMutex.
+			void update_verbosity();
+			
+			// Recompute the most verbose target level and forget lanes without targets of this logger.
+			// Requires m_DataMutex.
+			void update_targets();
+			
+			// Retrieve channel with given name, creating it on first use
+			static logger& channel_instance(const std::string& p_name, const channel_options& p_options);
+			
+		private:
+			const std::uint64_t m_Id;			// Unique id, which tells the lanes which targets a batch is meant for
+			const std::string m_Name;			// Name of the channel, empty for the default logger
+			const bool m_IsDefault;				// Whether this is the default logger, which also maintains internal::g_Verbosity
+			const bool m_SharedPool;			// Whether the dispatch pool was supplied by the user and might be used by others
+			std::atomic<int> m_Threshold;		// Level set by set_threshold
+			int m_MaxLevel{-1};					// Most verbose level of all targets. Guarded by m_DataMutex.
+			std::atomic<int> m_Verbosity{-1};	// Most verbose level that passes both the threshold and a target
 
 		private:
 			std::atomic_bool m_Empty{true};		// Whether the logger has no targets
 			std::mutex m_DataMutex;				// Mutex used to guard logger data access
-			container_type m_Targets;			// Non-owning pointers to log targets
+			std::mutex m_TargetMutex;			// Serializes adding, removing and replacing targets
+			internal::batch_pool m_BatchPool;	// Storage of published batches, reused once all lanes wrote them. Outlives the lanes.
+			std::shared_ptr<dispatch_pool> m_Pool;	// Owner of the dispatch lanes
+			lane_container_type m_Lanes;		// Dispatch lanes serving at least one target of this logger
+			std::vector<internal::dispatch_lane*> m_PublishLanes;	// Lanes the current batch is published to
 			queue_type m_WorkQueue;				// Queue that holds all log entry data
 			queue_type m_TempQueue;				// Queue that holds queue tail during dispatch
 			
 		private:
 			bool m_IsLocked{false};				// Whether we currently are in a LOCK/UNLOCK block
+			bool m_BlockSync{false};			// Whether the current LOCK/UNLOCK block contains an entry requiring synchronous delivery
 			std::recursive_mutex m_Mtx;			// Access mutex for producer threads
-			std::condition_variable m_WorkCv;	// Used to notify the consumer thread of new data
-			std::mutex m_CvMtx;					// Mutex used by the condition_variable
 			
-			bool m_HasWork{false};				// Whether there is work pending to be processed
+			// Doorbell states of the parked worker thread
+			static constexpr std::uint32_t parked_state = 1;	// Waiting for any entry
+			static constexpr std::uint32_t batching_state = 2;	// Waiting for m_BatchSize entries
+			
+			internal::doorbell m_Doorbell;		// Used to wake up the worker thread when new data arrives
+			std::atomic<wakeup_strategy> m_Strategy{wakeup_strategy::park};
+			std::atomic<std::size_t> m_SpinCount{20000};
+			std::atomic<std::size_t> m_BatchSize{256};
+			std::atomic<std::int64_t> m_BatchDelay{1000};	// Maximum batching wait in microseconds
+			
 			std::atomic_bool m_ShouldStop{false};	// Whether the worker thread is requested to stop
 			std::thread m_Worker;				// Worker thread
 
 			bool m_IsShutdown{false};			// Whether the logger has already been shut down
 			
+		private:
+			std::atomic_bool m_UseRings{false};		// Whether producers use per-thread ring buffers
+			std::atomic<std::size_t> m_WaitingProducers{0};	// Number of producers waiting for room in a full ring buffer
+			std::mutex m_ProducerMtx;				// Guards the producer ring buffer list and settings
+			producer_container_type m_Producers;	// Ring buffers of all producer threads
+			std::size_t m_RingCapacity{1024};		// Capacity of newly created ring buffers
+			overflow_policy m_RingPolicy{overflow_policy::block};	// Overflow policy of newly created ring buffers
+			std::size_t m_DetachedDrops{0};			// Dropped entries of ring buffers that were already released
+			std::uint64_t m_DetachedPushes{0};		// Inserted entries of ring buffers that were already released
+			
+		private:
+			std::atomic<std::uint64_t> m_Enqueued{0};	// Entries inserted into the shared queue. Only changed while holding m_Mtx.
+			std::atomic<std::uint64_t> m_Collected{0};	// Entries the worker thread took from the shared queue
+			std::atomic<std::uint64_t> m_Dispatched{0};	// Entries handed to the lanes. Only changed by the worker thread.
+			std::atomic<std::size_t> m_PeakDepth{0};	// Largest batch collected by the worker thread
+			internal::atomic_histogram m_Latency;		// Creation to dispatch latency of all entries
+			std::atomic<std::int64_t> m_ReportInterval{0};	// Self-report interval in milliseconds, zero if disabled
+			std::chrono::steady_clock::time_point m_LastReport{std::chrono::steady_clock::now()};	// Time of the last self-report. Only used by the worker thread.
+			
+		private:
+			std::atomic_bool m_Dedup{false};			// Whether duplicate suppression is enabled
+			internal::dedup_filter m_DedupFilter;		// Duplicate suppression state. Only used by the worker thread.
+			
+		private:
+			std::mutex m_FlushMtx;						// Guards the flush requests
+			std::vector<internal::barrier_ptr> m_FlushRequests;	// Flush requests not yet taken by the worker thread
+			bool m_FlushClosed{false};					// Whether the worker thread finished, which makes flushing unnecessary. Guarded by m_FlushMtx.
+			std::atomic_bool m_FlushPending{false};		// Whether m_FlushRequests is not empty
+			std::vector<internal::barrier_ptr> m_Barriers;	// Flush requests published with the next batch. Only used by the worker thread.
+			std::atomic<int> m_SyncLevel{-1};			// Entries of this level or more severe ones are delivered synchronously
+			std::atomic<std::int64_t> m_SyncTimeout{5000};	// Maximum wait for synchronous delivery in milliseconds
 	};
 }
 
@@ -125,14 +420,24 @@ namespace lg
 #define NS() lg
 #define NS_UTIL() ut
 #define LOGGER() ::NS()::logger::instance()
-#define LOG() LOGGER() += ::NS()::log_entry(__FILE__, __LINE__)
-#define LOG_BARE() LOGGER() += ::NS()::log_entry(__FILE__, __LINE__, true)
-#define LOG_BARE_BASE( _level, _clr ) LOG_BARE() << ::NS()::severity_level::_level << ::NS_UTIL()::console_color::_clr
-#define LOG_LVL_BASE( _level, _clr ) LOG() << ::NS()::severity_level::_level << ::NS_UTIL()::console_color::_clr
-#define LOG_TAG_BASE( _logexpr, _tag ) _logexpr << ::NS()::tag( _tag )
+#define LOG_SITE_BASE( _level, _clr, _bare ) [](){ static constexpr ::NS()::call_site t_site{ __FILE__, __LINE__, ::NS()::severity_level::_level, ::NS_UTIL()::console_color::_clr, _bare }; return &t_site; }()
+#define LOG() LOGGER() += ::NS()::log_entry(LOG_SITE_BASE(info, reset, false))
+#define LOG_BARE() LOGGER() += ::NS()::log_entry(LOG_SITE_BASE(info, reset, true))
+#define LOG_ENABLED_BASE( _level ) ::NS()::internal::level_enabled(::NS()::severity_level::_level)
+#define LOG_FILTER_BASE( _level ) !LOG_ENABLED_BASE(_level) ? (void)0 : 
+#define LOG_BARE_BASE( _level, _clr ) LOG_FILTER_BASE(_level) LOGGER() += ::NS()::log_entry(LOG_SITE_BASE(_level, _clr, true))
+#define LOG_LVL_BASE( _level, _clr ) LOG_FILTER_BASE(_level) LOGGER() += ::NS()::log_entry(LOG_SITE_BASE(_level, _clr, false))
+// Tagged statements resolve their tag once per call site and are skipped entirely if the tag
+// is turned off for their level. The loop runs at most once; unlike an if statement, it can not
+// capture a following else.
+#define LOG_TAG_SITE( _level, _tag ) [](const auto& p_tag){ static ::NS()::internal::tag_cache t_cache{ }; return t_cache.resolve(p_tag, ::NS()::severity_level::_level); }(_tag)
+#define LOG_TAG_BASE( _enabled, _level, _logexpr, _tag ) for(::NS()::internal::tag_t t_logTag = (_enabled) ? LOG_TAG_SITE(_level, _tag) : ::NS()::internal::tag_t::disabled(); t_logTag; t_logTag = ::NS()::internal::tag_t::disabled()) _logexpr << t_logTag
 #define LOG_IF_BASE( _expr, _logexpr ) if(_expr) _logexpr 
 #define LOG_EXCEPT_BASE( _logexpr ) _logexpr << "An exception was thrown: "
-#define LOG_FMT_BASE( _logexpr, _fmtstr, ...) _logexpr << ::NS_UTIL()::sprintf(_fmtstr, __VA_ARGS__)
+#define LOG_FMT_BASE( _logexpr, _fmtstr, ...) _logexpr << ::NS()::format(_fmtstr, __VA_ARGS__)
+#define LOG_LIMIT_BASE( _level, _clr, _allow ) !(LOG_ENABLED_BASE(_level) && (_allow)) ? (void)0 : LOGGER() += ::NS()::log_entry(LOG_SITE_BASE(_level, _clr, false))
+#define LOG_EVERY_N_SITE( _n ) [](){ static ::NS()::internal::every_n_limiter t_limiter{ }; return &t_limiter; }()->allow(_n)
+#define LOG_RATE_SITE( _rate ) [](){ static ::NS()::internal::token_bucket t_bucket{ }; return &t_bucket; }()->allow(_rate)
 #define MACRO_WRAP_BASE( _expr ) do { _expr } while(0)
 #define LOG_BARE_FMT( _fmtstr, ... ) LOG_FMT_BASE( LOG_BARE(), _fmtstr, __VA_ARGS__ )
 #define LOG_BARE_EMPTY() MACRO_WRAP_BASE(LOG_BARE();)
@@ -147,11 +452,11 @@ namespace lg
 // ---
 
 // Log Macros - tagged
-#define LOG_F_TAG( _tag ) LOG_TAG_BASE(LOG_F(), _tag)
-#define LOG_E_TAG( _tag ) LOG_TAG_BASE(LOG_E(), _tag)
-#define LOG_W_TAG( _tag ) LOG_TAG_BASE(LOG_W(), _tag)
-#define LOG_I_TAG( _tag ) LOG_TAG_BASE(LOG_I(), _tag)
-#define LOG_D_TAG( _tag ) LOG_TAG_BASE(LOG_D(), _tag)
+#define LOG_F_TAG( _tag ) LOG_TAG_BASE(LOG_ENABLED_BASE(fatal), fatal, LOG_F(), _tag)
+#define LOG_E_TAG( _tag ) LOG_TAG_BASE(LOG_ENABLED_BASE(error), error, LOG_E(), _tag)
+#define LOG_W_TAG( _tag ) LOG_TAG_BASE(LOG_ENABLED_BASE(warning), warning, LOG_W(), _tag)
+#define LOG_I_TAG( _tag ) LOG_TAG_BASE(LOG_ENABLED_BASE(info), info, LOG_I(), _tag)
+#define LOG_D_TAG( _tag ) LOG_TAG_BASE(LOG_ENABLED_BASE(debug), debug, LOG_D(), _tag)
 // ---
 
 // Log Macros - bare
@@ -170,8 +475,25 @@ namespace lg
 #define LOG_D_IF( _expr ) LOG_IF_BASE( (_expr), LOG_D() )
 // ---
 
+// Log Macros - rate limited. The limit is checked before the entry is constructed and
+// applies to the call site. EVERY_N lets the first of every N calls pass, RATE at most
+// the given number of calls per second, with bursts of up to one second worth of calls.
+#define LOG_F_EVERY_N( _n ) LOG_LIMIT_BASE(fatal,	bright_red,		LOG_EVERY_N_SITE(_n))
+#define LOG_E_EVERY_N( _n ) LOG_LIMIT_BASE(error,	bright_red,		LOG_EVERY_N_SITE(_n))
+#define LOG_W_EVERY_N( _n ) LOG_LIMIT_BASE(warning,	bright_yellow,	LOG_EVERY_N_SITE(_n))
+#define LOG_I_EVERY_N( _n ) LOG_LIMIT_BASE(info,	bright_white,	LOG_EVERY_N_SITE(_n))
+#define LOG_D_EVERY_N( _n ) LOG_LIMIT_BASE(debug,	bright_cyan,	LOG_EVERY_N_SITE(_n))
+
+#define LOG_F_RATE( _per_sec ) LOG_LIMIT_BASE(fatal,	bright_red,		LOG_RATE_SITE(_per_sec))
+#define LOG_E_RATE( _per_sec ) LOG_LIMIT_BASE(error,	bright_red,		LOG_RATE_SITE(_per_sec))
+#define LOG_W_RATE( _per_sec ) LOG_LIMIT_BASE(warning,	bright_yellow,	LOG_RATE_SITE(_per_sec))
+#define LOG_I_RATE( _per_sec ) LOG_LIMIT_BASE(info,		bright_white,	LOG_RATE_SITE(_per_sec))
+#define LOG_D_RATE( _per_sec ) LOG_LIMIT_BASE(debug,	bright_cyan,	LOG_RATE_SITE(_per_sec))
+// ---
+
 // Log Macros - assert
-#define LOG_ASSERT_EX( _expr, _msg ) MACRO_WRAP_BASE( if(!_expr){ LOG_F() << "Assertion failed: "  #_expr << " " << _msg; std::terminate(); } )
+// The failed assertion and everything logged before it is written before terminating
+#define LOG_ASSERT_EX( _expr, _msg ) MACRO_WRAP_BASE( if(!_expr){ LOG_F() << "Assertion failed: "  #_expr << " " << _msg; ::NS()::logger::flush(); std::terminate(); } )
 #define LOG_ASSERT( _expr ) LOG_ASSERT_EX( (_expr), "" )
 // ---
 
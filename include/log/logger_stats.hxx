@@ -0,0 +1,84 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace lg
+{
+	// Tag of the entries the logger emits about itself when self-reporting is enabled
+	constexpr const char* stats_tag = "liblog";
+
+	// Distribution of durations in power-of-two nanosecond buckets.
+	// Bucket 0 holds zero durations, bucket i durations in [2^(i-1), 2^i) ns.
+	// The last bucket also holds everything longer than that.
+	struct latency_histogram
+	{
+		static constexpr ::std::size_t bucket_count = 40;
+
+		::std::array<::std::uint64_t, bucket_count> m_Buckets{ };
+
+		// Number of recorded durations
+		auto total() const
+			-> ::std::uint64_t;
+
+		// Upper bound of the bucket containing given quantile, which is in [0, 1]
+		auto percentile(double p_quantile) const
+			-> ::std::chrono::nanoseconds;
+
+		// Bucket given duration in nanoseconds belongs to
+		static auto bucket_of(::std::int64_t p_ns)
+			-> ::std::size_t;
+	};
+
+	// Statistics of a single log target
+	struct target_stats
+	{
+		::std::string m_Lane;				//< Name of the lane serving the target
+		::std::size_t m_Index;				//< Position of the target inside of its lane
+		::std::uint64_t m_Writes;			//< Number of write_batch calls
+		::std::uint64_t m_Entries;			//< Number of entries written
+		::std::uint64_t m_Bytes;			//< Number of message bytes written, without formatting
+		::std::chrono::nanoseconds m_Time;	//< Time spent inside of write_batch
+	};
+
+	namespace internal
+	{
+		// Latency histogram that is updated by a single thread and may be read by any.
+		// All accesses are relaxed, so recording a value costs one uncontended add.
+		class atomic_histogram
+		{
+			public:
+				auto record(::std::int64_t p_ns)
+					-> void
+				{
+					m_Buckets[latency_histogram::bucket_of(p_ns)].fetch_add(1, ::std::memory_order_relaxed);
+				}
+
+				auto snapshot() const
+					-> latency_histogram;
+
+			private:
+				::std::array<::std::atomic<::std::uint64_t>, latency_histogram::bucket_count> m_Buckets{ };
+		};
+	}
+}
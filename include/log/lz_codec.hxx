@@ -0,0 +1,77 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace lg
+{
+	namespace internal
+	{
+		// Small LZ77 block codec producing the LZ4 block format, so that compressed
+		// data can be decoded using any LZ4 implementation as well.
+		
+		// Compression levels select the size of the match finder table. Higher levels
+		// find more matches, at the cost of clearing a larger table for every block.
+		constexpr unsigned lz_min_level = 1;
+		constexpr unsigned lz_max_level = 7;
+		constexpr unsigned lz_default_level = 3;
+		
+		// Compress given data and append the result to given buffer
+		auto lz_compress(const char* p_src, ::std::size_t p_len, ::std::string& p_out, unsigned p_level = lz_default_level)
+			-> void;
+			
+		// Decompress given block into given buffer, which has to be exactly as big as the
+		// uncompressed data. Returns false if the block is malformed.
+		auto lz_decompress(const char* p_src, ::std::size_t p_len, char* p_dst, ::std::size_t p_dstLen)
+			-> bool;
+			
+		// Decompress given block into given buffer of given capacity and store the size of the
+		// uncompressed data. Returns false if the block is malformed or does not fit.
+		auto lz_decompress_bounded(const char* p_src, ::std::size_t p_len, char* p_dst, ::std::size_t p_capacity, ::std::size_t& p_size)
+			-> bool;
+			
+		// Compress given data into a complete LZ4 frame with independent blocks and append it to given buffer.
+		// The frame records the uncompressed size. Any LZ4 frame decoder, e.g. the lz4 command line tool,
+		// can decompress it, as well as concatenations of such frames.
+		auto lz_frame_compress(const char* p_src, ::std::size_t p_len, ::std::string& p_out, unsigned p_level = lz_default_level)
+			-> void;
+			
+		// Decompress the LZ4 frame at the start of given data and append its contents to given buffer.
+		// Skippable frames are consumed without output. Returns the size of the frame, or zero if the
+		// data ends before the frame does. Throws std::runtime_error if the frame is malformed or its
+		// blocks depend on each other, which is not supported.
+		auto lz_frame_decompress(const char* p_src, ::std::size_t p_len, ::std::string& p_out)
+			-> ::std::size_t;
+			
+		// Summary of an LZ4 frame
+		struct lz_frame_info
+		{
+			::std::size_t m_Size{0};				//< Size of the whole frame
+			::std::uint64_t m_ContentSize{0};		//< Size of the uncompressed contents, if recorded
+			bool m_HasContentSize{false};			//< Whether the frame header records the content size
+			bool m_Skippable{false};				//< Whether this is a skippable frame without contents
+		};
+		
+		// Describe the frame at the start of given data by only reading its headers, which allows
+		// seeking through a sequence of frames without decompressing them. Returns false if the data
+		// ends before the frame does. Throws std::runtime_error like lz_frame_decompress.
+		auto lz_frame_inspect(const char* p_src, ::std::size_t p_len, lz_frame_info& p_info)
+			-> bool;
+	}
+}
@@ -0,0 +1,212 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <memory>
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+
+#include "slab_arena.hxx"
+
+// Number of message characters stored inline in every log entry. Longer messages
+// spill to the slab arena of the producer thread.
+#ifndef LIBLOG_INLINE_MESSAGE_SIZE
+#	define LIBLOG_INLINE_MESSAGE_SIZE 256
+#endif
+
+namespace lg
+{
+	namespace internal
+	{
+		// Character buffer with inline small-buffer storage
+		class message_buffer
+		{
+			public:
+				message_buffer() = default;
+				
+				// Buffers that are kept around for a long time should not pin arena slabs
+				explicit message_buffer(bool p_useArena)
+					: m_UseArena{p_useArena}
+				{
+				}
+				
+				~message_buffer();
+
+				message_buffer(message_buffer&&);
+				message_buffer& operator=(message_buffer&&);
+
+				message_buffer(const message_buffer&) = delete;
+				message_buffer& operator=(const message_buffer&) = delete;
+
+			public:
+				auto append(const char* p_str, ::std::size_t p_len)
+					-> void
+				{
+					if(m_Size + p_len > m_Capacity)
+						grow(m_Size + p_len);
+
+					::std::char_traits<char>::copy(data() + m_Size, p_str, p_len);
+					m_Size += p_len;
+				}
+
+				auto push_back(char p_chr)
+					-> void
+				{
+					append(&p_chr, 1);
+				}
+
+				// Insert given string at given position
+				auto insert(::std::size_t p_pos, const char* p_str, ::std::size_t p_len)
+					-> void;
+					
+				// Remove all characters, but keep the allocated storage
+				auto clear()
+					-> void
+				{
+					m_Size = 0;
+				}
+
+			public:
+				auto data()
+					-> char*
+				{
+					return m_Heap.m_Data ? m_Heap.m_Data : m_Inline;
+				}
+
+				auto data() const
+					-> const char*
+				{
+					return m_Heap.m_Data ? m_Heap.m_Data : m_Inline;
+				}
+
+				auto size() const
+					-> ::std::size_t
+				{
+					return m_Size;
+				}
+
+				// Whether the message outgrew the inline storage
+				auto spilled() const
+					-> bool
+				{
+					return m_Heap.m_Data != nullptr;
+				}
+
+			private:
+				auto grow(::std::size_t p_required)
+					-> void;
+					
+				auto release()
+					-> void;
+
+			private:
+				::std::size_t m_Size{0};
+				::std::size_t m_Capacity{LIBLOG_INLINE_MESSAGE_SIZE};
+				arena_block m_Heap{ };				//< Storage used once the inline storage is exhausted
+				bool m_UseArena{true};				//< Whether m_Heap is allocated from the arena of the thread
+
+				char m_Inline[LIBLOG_INLINE_MESSAGE_SIZE];
+		};
+
+		// Stream buffer forwarding everything to the message buffer it is currently attached to
+		class message_streambuf
+			: public ::std::streambuf
+		{
+			public:
+				message_streambuf() = default;
+			
+				message_streambuf(message_buffer* p_buffer)
+					: m_Target{p_buffer}
+				{
+				}
+		
+			public:
+				auto attach(message_buffer* p_buffer)
+					-> void
+				{
+					m_Target = p_buffer;
+				}
+				
+			protected:
+				virtual auto overflow(int_type p_chr)
+					-> int_type override
+				{
+					if(!traits_type::eq_int_type(p_chr, traits_type::eof()))
+						m_Target->push_back(traits_type::to_char_type(p_chr));
+						
+					return traits_type::not_eof(p_chr);
+				}
+				
+				virtual auto xsputn(const char_type* p_str, ::std::streamsize p_len)
+					-> ::std::streamsize override
+				{
+					m_Target->append(p_str, static_cast<::std::size_t>(p_len));
+					return p_len;
+				}
+				
+			private:
+				message_buffer* m_Target{nullptr};
+		};
+		
+		// Output stream writing into an owned character buffer. Used by log targets to
+		// format a whole batch of entries before handing it to the operating system at once.
+		class buffer_stream
+			: public ::std::ostream
+		{
+			public:
+				buffer_stream()
+					: ::std::ostream{nullptr}, m_Buffer{false}, m_Streambuf{&m_Buffer}
+				{
+					rdbuf(&m_Streambuf);
+				}
+				
+				buffer_stream(const buffer_stream&) = delete;
+				buffer_stream& operator=(const buffer_stream&) = delete;
+				
+			public:
+				auto data() const
+					-> const char*
+				{
+					return m_Buffer.data();
+				}
+				
+				auto size() const
+					-> ::std::size_t
+				{
+					return m_Buffer.size();
+				}
+				
+				// Discard buffer contents, keeping the allocated storage for the next batch
+				auto clear_buffer()
+					-> void
+				{
+					m_Buffer.clear();
+					clear();
+				}
+				
+			private:
+				message_buffer m_Buffer;
+				message_streambuf m_Streambuf;
+		};
+
+		// Retrieve the output stream of the calling thread, writing into given buffer.
+		// The stream is created once per thread. If requested, its formatting state
+		// (flags, width, precision and fill character) is reset to the defaults.
+		auto message_stream(message_buffer& p_buffer, bool p_reset)
+			-> ::std::ostream&;
+	}
+}
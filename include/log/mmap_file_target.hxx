@@ -0,0 +1,170 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+// Memory-mapped file targets are only available on POSIX systems
+#if !defined(_WIN32)
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <condition_variable>
+
+#include "default_formatter.hxx"
+#include "log_target.hxx"
+#include "log_entry.hxx"
+#include "message_buffer.hxx"
+
+namespace lg
+{
+	// Settings of a memory-mapped file target
+	struct mmap_file_options
+	{
+		::std::size_t m_SegmentSize{64u << 20};				//< Size every segment file is preallocated with
+		::std::chrono::seconds m_Interval{0};				//< Start a new segment after this time. Zero disables time based rotation.
+		::std::size_t m_MaxFiles{0};						//< Maximum number of segment files to keep. Zero means unlimited.
+		::std::uint64_t m_MaxTotalBytes{0};					//< Maximum total size of all segment files. Zero means unlimited.
+		::std::chrono::milliseconds m_SyncInterval{1000};	//< Interval in which written pages are handed to the kernel for writeback
+	};
+
+	namespace internal
+	{
+		// Appends data to a sequence of preallocated, memory-mapped segment files
+		// named "<path>.<index>". Segments are rotated by size and, optionally, by age.
+		// Old segments are removed according to the retention settings.
+		// A background thread periodically starts asynchronous writeback of written
+		// pages and drops them from the page tables of this process.
+		class mmap_writer
+		{
+			public:
+				mmap_writer(const ::std::string& p_path, const mmap_file_options& p_options);
+				~mmap_writer();
+
+				mmap_writer(const mmap_writer&) = delete;
+				mmap_writer(mmap_writer&&) = delete;
+
+				mmap_writer& operator=(const mmap_writer&) = delete;
+				mmap_writer& operator=(mmap_writer&&) = delete;
+
+			public:
+				// Copy given data into the current segment. A record never spans two segments.
+				auto append(const char* p_data, ::std::size_t p_len)
+					-> void;
+					
+				// Wait until everything appended so far reached the storage device
+				auto sync()
+					-> void;
+
+				// Number of bytes that could not be written, e.g. because a new segment could not be created
+				auto discarded() const
+					-> ::std::uint64_t
+				{
+					return m_Discarded.load(::std::memory_order_relaxed);
+				}
+
+			private:
+				// Finish current segment and create next one, which is at least given size
+				auto rotate(::std::size_t p_minSize)
+					-> void;
+
+				auto open_segment(::std::size_t p_size)
+					-> bool;
+
+				auto close_segment()
+					-> void;
+
+				// Remove oldest segments exceeding the retention limits
+				auto apply_retention()
+					-> void;
+
+				auto segment_path(::std::uint64_t p_index) const
+					-> ::std::string;
+
+				// Background thread function
+				auto do_sync()
+					-> void;
+
+			private:
+				::std::string m_Path;						//< Base path of all segment files
+				mmap_file_options m_Options;				//< Rotation and retention settings
+				::std::uint64_t m_Index{0};					//< Index of the current segment
+				int m_Fd{-1};								//< File descriptor of the current segment
+				char* m_Map{nullptr};						//< Mapping of the current segment
+				::std::size_t m_Size{0};					//< Size of the current segment
+				::std::size_t m_Offset{0};					//< Write offset inside of the current segment
+				::std::size_t m_Synced{0};					//< Offset up to which writeback was already started
+				::std::chrono::steady_clock::time_point m_Opened{ };	//< Time the current segment was created
+				::std::atomic<::std::uint64_t> m_Discarded{0};
+
+				::std::mutex m_Mtx;							//< Guards the current segment against the background thread
+				::std::condition_variable m_Cv;				//< Used to wake up the background thread on shutdown
+				bool m_ShouldStop{false};					//< Whether the background thread is requested to stop
+				::std::thread m_Worker;						//< Background writeback thread
+		};
+	}
+
+	// Log target that writes formatted entries into memory-mapped, preallocated
+	// segment files. Appending an entry is a plain memory copy without any system call.
+	template< typename Tformat = default_formatter >
+	class mmap_file_target
+		: public log_target
+	{
+		static_assert(internal::is_formatter<Tformat>::value, "Tformat is not a valid log formatter!");
+
+		public:
+			// Construct new memory-mapped file target with given severity threshold, base path and settings.
+			mmap_file_target(severity_level p_lvl, const ::std::string& p_path, const mmap_file_options& p_options = mmap_file_options{ })
+				: log_target(p_lvl), m_Writer{p_path, p_options}
+			{
+			}
+
+			mmap_file_target(severity_level p_lvl, const ::std::string& p_path, const mmap_file_options& p_options, const Tformat& p_fmt)
+				: log_target(p_lvl), m_Formatter{p_fmt}, m_Writer{p_path, p_options}
+			{
+			}
+
+		public:
+			virtual void write(const log_entry& entry) override
+			{
+				m_Buffer.clear_buffer();
+				m_Formatter(m_Buffer, entry);
+				m_Writer.append(m_Buffer.data(), m_Buffer.size());
+			}
+
+			// Entries are appended one by one, so that a segment never ends in the middle of one
+			virtual void write_batch(entry_span entries) override
+			{
+				for(const auto& t_entry : entries)
+					write(t_entry);
+			}
+			
+			virtual void flush() override
+			{
+				m_Writer.sync();
+			}
+
+		private:
+			Tformat m_Formatter;				// Formatter used by this target
+			internal::mmap_writer m_Writer;		// Segment file writer
+			internal::buffer_stream m_Buffer;	// Buffer the current entry is formatted into
+	};
+}
+
+#endif
@@ -0,0 +1,172 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*	PROTOCOL v1:
+ *	
+ *	[u8]	Length of message string
+ *	[u8]	Length of source string
+ *	[u8]	Length of tag string
+ *  [u8]	Level
+ *	[u8]	Is Bare? (0x1 or 0x0)
+ *	[u64]	Timestamp (time_t)
+ *	N*[u8]	String payload
+ *	M*[u8]	Source payload
+ *	K*[u8]	Tag payload
+ *
+ *	Strings longer than 255 bytes are truncated.
+ *
+ *
+ *	PROTOCOL v2:
+ *
+ *	Frame:
+ *	[u8 x2]		Magic ("LG")
+ *	[u8]		Version (0x2)
+ *	[u8]		Flags. Bit 0: Payload is compressed using the LZ4 block format
+ *	[u32]		Length of the remaining frame
+ *	[varint]	Number of records
+ *	[varint]	Length of uncompressed payload
+ *	[varint]	Length of source string
+ *	N*[u8]		Source payload
+ *	...			Payload, consisting of all records back to back
+ *
+ *	Record:
+ *	[u8]		Level
+ *	[u8]		Flags. Bit 0: Is Bare? Bit 1: Has fields? Bit 2: Tag is a reference?
+ *	[varint]	Timestamp in nanoseconds since epoch. The first record of a frame stores the
+ *				absolute value, all others the zigzag-encoded difference to the previous record.
+ *	[varint]	Thread id
+ *	[varint]	Line
+ *	[varint]	Length of file string, followed by its payload
+ *	[varint]	Length of tag string, followed by its payload. If the tag is a reference, this is
+ *				instead the index of the tag among the distinct non-empty tags sent inline in this frame.
+ *	[varint]	Length of message string, followed by its payload
+ *	[varint]	Number of structured fields, only present if the record has fields
+ *	...			Fields
+ *
+ *	Field:
+ *	[u8]		Type, see lg::field_type
+ *	[varint]	Length of key string, followed by its payload
+ *	...			Value: [u8] 0 or 1 for booleans, [varint] zigzag-encoded value for signed
+ *				integers, [varint] for unsigned integers, [u64] IEEE 754 bit pattern for
+ *				floating point numbers, [varint] length followed by the payload for strings.
+ *
+ *	Fields are not transmitted by v1.
+ *
+ *	Varints are unsigned LEB128. All other integers are big endian.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "log_entry.hxx"
+#include "entry_span.hxx"
+
+namespace lg
+{
+	enum class protocol_version
+	{
+		v1 = 1,
+		v2 = 2
+	};
+
+	// Wire protocol settings of network targets
+	struct protocol_options
+	{
+		protocol_version m_Version{protocol_version::v1};	//< v1 is the default in order to stay compatible with existing servers
+		bool m_Compress{false};								//< Whether to compress frames. Only supported by v2.
+		::std::size_t m_MaxFrameSize{256u << 10};			//< Records are split into multiple frames beyond this payload size
+	};
+
+	namespace internal
+	{
+		// Size of the fixed part of a v1 packet
+		constexpr ::std::size_t packet_header_size = 13;
+		
+		// Size of the fixed part of a v2 frame, up to and including the length field
+		constexpr ::std::size_t frame_header_size = 8;
+		
+		// Largest v2 frame, and largest uncompressed payload, a decoder accepts. Encoders only
+		// exceed the configured maximum frame size by a single record.
+		constexpr ::std::size_t max_frame_size = 64u << 20;
+		
+		constexpr ::std::uint8_t frame_magic_0 = 0x4C;
+		constexpr ::std::uint8_t frame_magic_1 = 0x47;
+		constexpr ::std::uint8_t frame_flag_compressed = 0x1;
+		constexpr ::std::uint8_t record_flag_bare = 0x1;
+		constexpr ::std::uint8_t record_flag_fields = 0x2;
+		constexpr ::std::uint8_t record_flag_tag_ref = 0x4;
+	
+		// Encode given entry as v1 packet and append it to given buffer
+		auto encode_packet(::std::string& p_out, const log_entry& p_entry, const ::std::string& p_src)
+			-> void;
+			
+		auto append_varint(::std::string& p_out, ::std::uint64_t p_val)
+			-> void;
+			
+		// Position of a complete frame (or v1 packet) in an output buffer
+		struct frame_info
+		{
+			::std::size_t m_End;		//< Offset one past the last byte of the frame
+			::std::size_t m_Records;	//< Number of entries contained in the frame
+		};
+		
+		// Encodes batches of entries using the configured protocol version.
+		// Buffers are kept between calls in order to avoid allocations.
+		class protocol_encoder
+		{
+			public:
+				protocol_encoder(const ::std::string& p_src = ::std::string{ }, const protocol_options& p_options = protocol_options{ });
+				
+			public:
+				// Encode given entries and append the result to given buffer. Every frame, or v1 packet,
+				// that was produced is recorded in given vector.
+				auto encode(::std::string& p_out, entry_span p_entries, ::std::vector<frame_info>& p_frames)
+					-> void;
+					
+				// Append given entry to the current v2 frame, regardless of the maximum frame size
+				auto encode_record(const log_entry& p_entry)
+					-> void;
+					
+				// Finish current v2 frame and append it to given buffer. Does nothing if the frame is empty.
+				auto finish_frame(::std::string& p_out, ::std::vector<frame_info>& p_frames)
+					-> void;
+					
+				// Size of the uncompressed payload of the current v2 frame
+				auto payload_size() const
+					-> ::std::size_t
+				{
+					return m_Payload.size();
+				}
+					
+			private:
+				auto encode_fields(const log_entry& p_entry)
+					-> void;
+				
+			private:
+				::std::string m_Src;
+				protocol_options m_Options;
+				::std::string m_Payload;				//< Records of the current frame
+				::std::string m_Compressed;				//< Buffer used for compressing the payload
+				::std::size_t m_Records{0};				//< Number of records in the current frame
+				::std::int64_t m_LastTime{0};			//< Timestamp of the previous record in the current frame
+				::std::vector<::std::uint32_t> m_TagSlots;	//< Index of each tag id in the tag table of the current frame plus one, zero if not sent yet
+				::std::vector<tag_id> m_FrameTags;		//< Tags sent inline in the current frame, in order
+		};
+	}
+}
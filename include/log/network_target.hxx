@@ -13,29 +13,20 @@
 	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-/*	PROTOCOL:
- *	
- *	[u8]	Length of message string
- *	[u8]	Length of source string
- *	[u8]	Length of tag string
- *  [u8]	Level
- *	[u8]	Is Bare? (0x1 or 0x0)
- *	[u64]	Timestamp (time_t)
- *	N*[u8]	String payload
- *	M*[u8]	Source payload
- *	K*[u8]	Tag payload
- */
-
-
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "log_target.hxx"
 #include "log_entry.hxx"
+#include "network_protocol.hxx"
 
 namespace lg
 {
+	// Log target sending entries to a remote server over TCP, see network_protocol.hxx
+	// for the packet layout. Writes are blocking. Use async_network_target if a slow or
+	// unreachable server must not stall the logger.
 	class network_target
 		: public log_target
 	{
@@ -46,7 +37,13 @@ namespace lg
 				: log_target(severity_level::debug)
 			{}
 
-			network_target(severity_level p_lvl, const ::std::string& p_host, const ::std::string& p_port, const ::std::string& p_src = ::std::string{});
+			network_target(
+				severity_level p_lvl,
+				const ::std::string& p_host,
+				const ::std::string& p_port,
+				const ::std::string& p_src = ::std::string{},
+				const protocol_options& p_protocol = protocol_options{ }
+			);
 			~network_target();
 
 			network_target(const network_target&) = delete;
@@ -57,6 +54,9 @@ namespace lg
 
 		public:
 			virtual void write(const log_entry& entry) override;
+			
+			// Send all packets of the batch using a single write
+			virtual void write_batch(entry_span entries) override;
 
 		private:
 			auto connect() -> void;
@@ -66,5 +66,8 @@ namespace lg
 			::std::string m_Port;
 			::std::string m_Src;
 			handle_type m_InternalData{nullptr};
+			internal::protocol_encoder m_Encoder;			// Encodes entries using the configured protocol version
+			::std::string m_Packet;							// Buffer the packets are encoded into
+			::std::vector<internal::frame_info> m_Frames;
 	};
 }
@@ -0,0 +1,363 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <ostream>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <ut/console_color.hxx>
+#include <ut/string_view.hxx>
+
+#include "timestamp.hxx"
+#include "severity_level.hxx"
+#include "log_entry.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		// Collects formatted output in a fixed buffer, which is handed to the output stream
+		// once the entry is complete or the buffer fills up. Never changes the stream state.
+		class text_buffer
+		{
+			public:
+				text_buffer(::std::ostream& p_str)
+					: m_Str{p_str}
+				{
+				}
+				
+				~text_buffer()
+				{
+					flush();
+				}
+				
+				text_buffer(const text_buffer&) = delete;
+				text_buffer& operator=(const text_buffer&) = delete;
+				
+			public:
+				auto raw(const char* p_str, ::std::size_t p_len)
+					-> void;
+					
+				auto raw(ut::string_view p_str)
+					-> void
+				{
+					raw(p_str.data(), p_str.length());
+				}
+					
+				auto raw(char p_chr)
+					-> void
+				{
+					if(m_Pos == sizeof(m_Buffer))
+						flush();
+						
+					m_Buffer[m_Pos++] = p_chr;
+					++m_Visible;
+				}
+				
+				// Append given character the given number of times
+				auto fill(char p_chr, ::std::size_t p_count)
+					-> void;
+					
+				auto number(::std::uint64_t p_val)
+					-> void;
+					
+				// Append local time of day of given timestamp
+				auto time(timestamp p_time, time_precision p_precision)
+					-> void;
+					
+				// Append ANSI escape sequence selecting given foreground color
+				auto color(ut::console_color p_clr)
+					-> void;
+					
+				// Append ANSI escape sequence restoring the default color
+				auto reset_color()
+					-> void;
+					
+				// Append all structured fields of given entry, each as " key=value"
+				auto fields(const log_entry& p_entry)
+					-> void;
+					
+				auto flush()
+					-> void;
+					
+				// Number of characters written so far, without escape sequences
+				auto visible() const
+					-> ::std::size_t
+				{
+					return m_Visible;
+				}
+				
+			private:
+				// Make sure that given number of bytes fits into the buffer
+				auto reserve(::std::size_t p_len)
+					-> char*;
+					
+				// Append text that takes up no room on screen
+				auto escape(const char* p_str, ::std::size_t p_len)
+					-> void;
+				
+			private:
+				::std::ostream& m_Str;
+				char m_Buffer[512];
+				::std::size_t m_Pos{0};
+				::std::size_t m_Visible{0};
+		};
+		
+		// Level strings right-aligned to seven characters, like the default formatter prints them
+		auto padded_level_string(severity_level p_lvl)
+			-> ut::string_view;
+			
+		auto lower_level_string(severity_level p_lvl)
+			-> ut::string_view;
+		
+		// Piece of a pattern, which is either literal text or a single directive
+		struct pattern_segment
+		{
+			char m_Directive;		//< Directive character, or zero for literal text
+			::std::size_t m_Begin;	//< Literal text of the segment, as range inside the pattern
+			::std::size_t m_End;	//< Position of the next segment
+		};
+		
+		constexpr auto is_pattern_directive(char p_chr)
+			-> bool
+		{
+			switch(p_chr)
+			{
+				case 'T': case 'L': case 'l': case 'm': case 't': case 'f':
+				case 'n': case 'i': case 'C': case 'R': case 'F':
+					return true;
+				default:
+					return false;
+			}
+		}
+		
+		// Parse segment starting at given position
+		constexpr auto pattern_segment_at(const char* p_pattern, ::std::size_t p_pos)
+			-> pattern_segment
+		{
+			if(p_pattern[p_pos] == '%')
+			{
+				// A trailing '%' is an invalid directive, which is rejected by pattern_valid
+				if(p_pattern[p_pos + 1] == '\0')
+					return pattern_segment{ '%', p_pos, p_pos + 1 };
+				
+				// "%%" is a literal percent sign
+				if(p_pattern[p_pos + 1] == '%')
+					return pattern_segment{ '\0', p_pos + 1, p_pos + 2 };
+					
+				return pattern_segment{ p_pattern[p_pos + 1], p_pos, p_pos + 2 };
+			}
+			
+			::std::size_t t_end = p_pos;
+			
+			while(p_pattern[t_end] != '\0' && p_pattern[t_end] != '%')
+				++t_end;
+				
+			return pattern_segment{ '\0', p_pos, t_end };
+		}
+		
+		constexpr auto pattern_segment_count(const char* p_pattern)
+			-> ::std::size_t
+		{
+			::std::size_t t_count{0};
+			
+			for(::std::size_t t_pos = 0; p_pattern[t_pos] != '\0'; t_pos = pattern_segment_at(p_pattern, t_pos).m_End)
+				++t_count;
+				
+			return t_count;
+		}
+		
+		constexpr auto pattern_segment_of(const char* p_pattern, ::std::size_t p_index)
+			-> pattern_segment
+		{
+			::std::size_t t_pos{0};
+			
+			for(; p_index > 0; --p_index)
+				t_pos = pattern_segment_at(p_pattern, t_pos).m_End;
+				
+			return pattern_segment_at(p_pattern, t_pos);
+		}
+		
+		constexpr auto pattern_valid(const char* p_pattern)
+			-> bool
+		{
+			for(::std::size_t t_pos = 0; p_pattern[t_pos] != '\0'; )
+			{
+				const auto t_segment = pattern_segment_at(p_pattern, t_pos);
+				
+				if(t_segment.m_Directive != '\0' && !is_pattern_directive(t_segment.m_Directive))
+					return false;
+					
+				t_pos = t_segment.m_End;
+			}
+			
+			return true;
+		}
+	}
+
+	// Formatter whose layout is given by a pattern, which is parsed at compile time.
+	// Every entry is rendered into a fixed buffer and handed to the stream with a single write.
+	// The pattern has to be a constexpr character array at namespace scope, since C++14 does
+	// not accept string literals as template arguments:
+	//
+	//		constexpr char g_pattern[] = "[%T] %C%L%R| %m%F";
+	//		lg::console_target<lg::pattern_formatter<g_pattern>> t_target{ lg::severity_level::debug };
+	//
+	// Supported directives:
+	//		%T	Time of day, with the sub-second precision given on construction
+	//		%L	Level, right-aligned to seven characters
+	//		%l	Level in lower case
+	//		%m	Message
+	//		%t	Tag
+	//		%f	Source file
+	//		%n	Source line
+	//		%i	Thread id
+	//		%C	ANSI escape sequence selecting the color of the entry
+	//		%R	ANSI escape sequence restoring the default color
+	//		%F	Structured fields, each as " key=value"
+	//		%%	Literal percent sign
+	//
+	// A newline is appended to every entry. Bare entries consist of the message and fields only,
+	// indented to the column the message of the previous entry started in.
+	template< const char* Pattern >
+	class pattern_formatter
+	{
+		static_assert(internal::pattern_valid(Pattern), "Pattern contains unknown directive");
+		
+		static constexpr ::std::size_t segment_count = internal::pattern_segment_count(Pattern);
+		
+		template< char Directive >
+		using directive_tag = ::std::integral_constant<char, Directive>;
+	
+		public:
+			pattern_formatter() = default;
+			
+			// Construct formatter that prints timestamps with given sub-second precision
+			pattern_formatter(time_precision p_precision)
+				: m_Precision{p_precision}
+			{
+			}
+			
+		public:
+			void operator()(::std::ostream& p_str, const log_entry& p_entry)
+			{
+				internal::text_buffer t_out{ p_str };
+				
+				if(p_entry.bare())
+				{
+					t_out.fill(' ', m_Indent);
+					t_out.raw(p_entry.message_view());
+					t_out.fields(p_entry);
+				}
+				else write_segments(t_out, p_entry, ::std::make_index_sequence<segment_count>{ });
+				
+				t_out.raw('\n');
+			}
+			
+		private:
+			template< ::std::size_t... Indices >
+			void write_segments(internal::text_buffer& p_out, const log_entry& p_entry, ::std::index_sequence<Indices...>)
+			{
+				using expand_type = int[];
+				(void)expand_type{ 0, (write_segment<Indices>(p_out, p_entry), 0)... };
+			}
+			
+			template< ::std::size_t Index >
+			void write_segment(internal::text_buffer& p_out, const log_entry& p_entry)
+			{
+				constexpr auto t_segment = internal::pattern_segment_of(Pattern, Index);
+				
+				if(t_segment.m_Directive == '\0')
+					p_out.raw(Pattern + t_segment.m_Begin, t_segment.m_End - t_segment.m_Begin);
+				else write_directive(p_out, p_entry, directive_tag<t_segment.m_Directive>{ });
+			}
+			
+			// Literal text, handled by write_segment
+			void write_directive(internal::text_buffer&, const log_entry&, directive_tag<'\0'>)
+			{
+			}
+			
+			void write_directive(internal::text_buffer& p_out, const log_entry& p_entry, directive_tag<'T'>)
+			{
+				// Without sub-seconds, the time string cached by the entry can be used
+				if(m_Precision == time_precision::seconds)
+					p_out.raw(ut::string_view{ p_entry.time_string() });
+				else p_out.time(p_entry.time_point(), m_Precision);
+			}
+			
+			void write_directive(internal::text_buffer& p_out, const log_entry& p_entry, directive_tag<'L'>)
+			{
+				p_out.raw(internal::padded_level_string(p_entry.level()));
+			}
+			
+			void write_directive(internal::text_buffer& p_out, const log_entry& p_entry, directive_tag<'l'>)
+			{
+				p_out.raw(internal::lower_level_string(p_entry.level()));
+			}
+			
+			void write_directive(internal::text_buffer& p_out, const log_entry& p_entry, directive_tag<'m'>)
+			{
+				// Bare entries following this one are aligned to the message
+				m_Indent = p_out.visible();
+				p_out.raw(p_entry.message_view());
+			}
+			
+			void write_directive(internal::text_buffer& p_out, const log_entry& p_entry, directive_tag<'t'>)
+			{
+				const auto& t_tag = p_entry.tag();
+				p_out.raw(t_tag.data(), t_tag.length());
+			}
+			
+			void write_directive(internal::text_buffer& p_out, const log_entry& p_entry, directive_tag<'f'>)
+			{
+				p_out.raw(ut::string_view{ p_entry.file() });
+			}
+			
+			void write_directive(internal::text_buffer& p_out, const log_entry& p_entry, directive_tag<'n'>)
+			{
+				p_out.number(p_entry.line());
+			}
+			
+			void write_directive(internal::text_buffer& p_out, const log_entry& p_entry, directive_tag<'i'>)
+			{
+				p_out.number(p_entry.thread_id());
+			}
+			
+			void write_directive(internal::text_buffer& p_out, const log_entry& p_entry, directive_tag<'C'>)
+			{
+				p_out.color(p_entry.color());
+			}
+			
+			void write_directive(internal::text_buffer& p_out, const log_entry&, directive_tag<'R'>)
+			{
+				p_out.reset_color();
+			}
+			
+			void write_directive(internal::text_buffer& p_out, const log_entry& p_entry, directive_tag<'F'>)
+			{
+				p_out.fields(p_entry);
+			}
+			
+		private:
+			time_precision m_Precision{time_precision::seconds};
+			::std::size_t m_Indent{0};		// Column the message of the last non-bare entry started in
+	};
+	
+	template< const char* Pattern >
+	constexpr ::std::size_t pattern_formatter<Pattern>::segment_count;
+}
@@ -0,0 +1,96 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "severity_level.hxx"
+#include "timestamp.hxx"
+#include "network_protocol.hxx"
+
+namespace lg
+{
+	// A structured field as received by a server. Only the member matching the type is set.
+	struct decoded_field
+	{
+		::std::string m_Key{ };
+		field_type m_Type{field_type::string};
+		bool m_Bool{false};
+		::std::int64_t m_Signed{0};
+		::std::uint64_t m_Unsigned{0};
+		double m_Double{0.0};
+		::std::string m_String{ };
+	};
+
+	// A log entry as received by a server
+	struct decoded_record
+	{
+		severity_level m_Level{ };
+		bool m_Bare{false};
+		::lg::timestamp m_Time{ };			//< Only has second resolution for v1
+		::std::uint32_t m_ThreadId{0};		//< Not transmitted by v1
+		::std::uint64_t m_Line{0};			//< Not transmitted by v1
+		::std::string m_File{ };			//< Not transmitted by v1
+		::std::string m_Source{ };
+		::std::string m_Tag{ };
+		::std::string m_Message{ };
+		::std::vector<decoded_field> m_Fields{ };	//< Not transmitted by v1
+	};
+
+	// Reference decoder for the byte stream sent by network targets, see network_protocol.hxx.
+	// Data can be fed in arbitrarily sized pieces. Records become available as soon as the
+	// packet or frame containing them was received completely.
+	class protocol_decoder
+	{
+		public:
+			explicit protocol_decoder(protocol_version p_version = protocol_version::v2);
+			
+		public:
+			// Append received data
+			auto feed(const char* p_data, ::std::size_t p_len)
+				-> void;
+				
+			// Retrieve next decoded record. Returns false if more data is needed.
+			// Throws std::runtime_error if the stream is malformed.
+			auto next(decoded_record& p_record)
+				-> bool;
+				
+			// Number of bytes that were received but not decoded yet
+			auto pending() const
+				-> ::std::size_t;
+				
+		private:
+			// Decode next v1 packet or v2 frame into the record queue
+			auto decode_packet()
+				-> bool;
+				
+			auto decode_frame()
+				-> bool;
+				
+		private:
+			protocol_version m_Version;
+			::std::string m_Buffer;						//< Received data
+			::std::size_t m_Offset{0};					//< Start of the data that was not decoded yet
+			::std::string m_Payload;					//< Decompressed payload of the current frame
+			::std::vector<::std::string> m_Tags;		//< Tag table of the current frame
+			::std::vector<decoded_record> m_Frame;		//< Records of the frame currently being decoded
+			::std::deque<decoded_record> m_Records;		//< Records that were decoded, but not retrieved yet
+	};
+}
@@ -0,0 +1,81 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+namespace lg
+{
+	namespace internal
+	{
+		// Lets the first of every N calls pass. Used by the LOG_*_EVERY_N macros,
+		// which keep one instance per call site.
+		class every_n_limiter
+		{
+			public:
+				auto allow(::std::uint64_t p_n)
+					-> bool
+				{
+					return p_n <= 1 || m_Count.fetch_add(1, ::std::memory_order_relaxed) % p_n == 0;
+				}
+
+			private:
+				::std::atomic<::std::uint64_t> m_Count{0};
+		};
+
+		// Lock-free token bucket, implemented as generic cell rate algorithm: the only state
+		// is the theoretical arrival time of the next call, which advances by one emission
+		// interval per accepted call. Calls are rejected while it runs ahead of the current
+		// time by more than the burst tolerance. The bucket holds one second worth of calls,
+		// so bursts of up to the given rate pass at once. Used by the LOG_*_RATE macros,
+		// which keep one instance per call site.
+		class token_bucket
+		{
+			using clock_type = ::std::chrono::steady_clock;
+
+			public:
+				auto allow(double p_perSecond)
+					-> bool
+				{
+					if(!(p_perSecond > 0.0))
+						return false;
+
+					const auto t_interval = ::std::max<::std::int64_t>(1, static_cast<::std::int64_t>(1e9 / p_perSecond));
+					const auto t_tolerance = ::std::max<::std::int64_t>(0, 1000000000 - t_interval);
+					const auto t_now = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count();
+
+					auto t_tat = m_Tat.load(::std::memory_order_relaxed);
+
+					while(true)
+					{
+						const auto t_base = ::std::max(t_tat, t_now);
+
+						if(t_base - t_now > t_tolerance)
+							return false;
+
+						if(m_Tat.compare_exchange_weak(t_tat, t_base + t_interval, ::std::memory_order_relaxed))
+							return true;
+					}
+				}
+
+			private:
+				::std::atomic<::std::int64_t> m_Tat{0};		//< Theoretical arrival time in nanoseconds of the steady clock
+		};
+	}
+}
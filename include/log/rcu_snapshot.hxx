@@ -0,0 +1,173 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <condition_variable>
+
+namespace lg
+{
+	namespace internal
+	{
+		// Immutable value that is read by a single thread without locking and replaced by
+		// writers publishing a modified copy (read-copy-update). The reader announces the
+		// value it currently uses through a hazard pointer. Replaced values are freed once
+		// the reader no longer uses them, and writers can wait for that to happen.
+		template< typename T >
+		class rcu_snapshot
+		{
+			public:
+				explicit rcu_snapshot(T p_value = T{ })
+					: m_Current{ new T(::std::move(p_value)) }
+				{
+				}
+				
+				~rcu_snapshot()
+				{
+					delete m_Current.load();
+					
+					for(auto* t_value : m_Retired)
+						delete t_value;
+				}
+				
+				rcu_snapshot(const rcu_snapshot&) = delete;
+				rcu_snapshot& operator=(const rcu_snapshot&) = delete;
+				
+			public:
+				// Retrieve the current value. Only to be used by the reader thread. The value
+				// stays valid until release is called.
+				auto acquire()
+					-> const T&
+				{
+					auto* t_value = m_Current.load();
+					
+					// The value could have been replaced and freed before the hazard pointer
+					// was visible, so it has to be checked again afterwards
+					while(true)
+					{
+						m_Hazard.store(t_value);
+						
+						auto* t_check = m_Current.load();
+						
+						if(t_check == t_value)
+							return *t_value;
+							
+						t_value = t_check;
+					}
+				}
+				
+				// Signal that the reader is done with the value it acquired
+				auto release()
+					-> void
+				{
+					m_Hazard.store(nullptr);
+					
+					// Only lock if a writer waits, so that reading stays lock-free otherwise
+					if(m_Waiting.load() != 0)
+					{
+						{
+							::std::lock_guard<::std::mutex> t_lock{m_Mtx};
+						}
+						
+						m_Cv.notify_all();
+					}
+				}
+				
+				// Replace the value with a copy modified by given function, which returns whether
+				// it changed anything. Does not wait for the reader. Returns whether the value was replaced.
+				template< typename F >
+				auto update(F&& p_func)
+					-> bool
+				{
+					::std::lock_guard<::std::mutex> t_lock{m_WriteMtx};
+					
+					::std::unique_ptr<T> t_copy{ new T(*m_Current.load(::std::memory_order_relaxed)) };
+					
+					if(!p_func(*t_copy))
+						return false;
+						
+					m_Retired.push_back(m_Current.exchange(t_copy.release()));
+					reclaim();
+					return true;
+				}
+				
+				// Block until the reader no longer uses any replaced value. Must not be called
+				// by the reader thread while it holds a value.
+				auto synchronize()
+					-> void
+				{
+					++m_Waiting;
+					
+					// Other writers may continue meanwhile. Values they replace are waited for as well.
+					{
+						::std::unique_lock<::std::mutex> t_lock{m_Mtx};
+						
+						m_Cv.wait(t_lock, [this]()
+						{
+							const auto* t_hazard = m_Hazard.load();
+							return t_hazard == nullptr || t_hazard == m_Current.load();
+						});
+					}
+					
+					--m_Waiting;
+					
+					::std::lock_guard<::std::mutex> t_writeLock{m_WriteMtx};
+					reclaim();
+				}
+				
+				// Call given function with the current value from any thread. Writers are blocked meanwhile.
+				template< typename F >
+				auto read(F&& p_func) const
+					-> decltype(auto)
+				{
+					::std::lock_guard<::std::mutex> t_lock{m_WriteMtx};
+					return p_func(*m_Current.load(::std::memory_order_relaxed));
+				}
+				
+			private:
+				// Free all replaced values the reader does not use. Requires m_WriteMtx.
+				auto reclaim()
+					-> void
+				{
+					const auto* t_hazard = m_Hazard.load();
+					
+					const auto t_end = ::std::remove_if(m_Retired.begin(), m_Retired.end(), [t_hazard](T* p_value)
+					{
+						if(p_value == t_hazard)
+							return false;
+							
+						delete p_value;
+						return true;
+					});
+					
+					m_Retired.erase(t_end, m_Retired.end());
+				}
+				
+			private:
+				::std::atomic<T*> m_Current;						//< Value new readers see
+				::std::atomic<const T*> m_Hazard{nullptr};			//< Value the reader currently uses
+				::std::atomic<::std::size_t> m_Waiting{0};			//< Number of writers waiting for the reader
+				mutable ::std::mutex m_WriteMtx;					//< Serializes writers
+				::std::mutex m_Mtx;									//< Used to wait for the reader
+				::std::condition_variable m_Cv;
+				::std::vector<T*> m_Retired;						//< Replaced values, which might still be in use. Guarded by m_WriteMtx.
+		};
+	}
+}
@@ -0,0 +1,283 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <limits>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+namespace lg
+{
+	// What a producer thread does when its ring buffer is full
+	enum class overflow_policy
+	{
+		block,			//< Wait until the worker thread made room
+		drop_newest,	//< Discard the entry that was about to be inserted
+		drop_oldest		//< Discard the oldest entry still waiting in the buffer
+	};
+
+	namespace internal
+	{
+		// Bounded single-producer/single-consumer ring buffer with pre-allocated slots.
+		// Every slot carries a sequence number telling both sides whether it is free
+		// for the writer (sequence == position) or holds an element for the reader
+		// (sequence == position + 1). The producer only ever touches the read index
+		// when it evicts the oldest element under overflow_policy::drop_oldest,
+		// which is why the read index is advanced using CAS on both sides.
+		template< typename T >
+		class ring_buffer
+		{
+			using storage_type = typename ::std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+			struct slot
+			{
+				::std::atomic<::std::size_t> m_Sequence;
+				storage_type m_Storage;
+
+				auto get()
+					-> T*
+				{
+					return reinterpret_cast<T*>(&m_Storage);
+				}
+			};
+
+			static constexpr ::std::size_t no_block = ::std::numeric_limits<::std::size_t>::max();
+
+			public:
+				ring_buffer(::std::size_t p_capacity, overflow_policy p_policy)
+					:	m_Capacity{p_capacity > 0 ? p_capacity : 1},
+						m_Policy{p_policy},
+						m_Slots{new slot[m_Capacity]}
+				{
+					for(::std::size_t t_i = 0; t_i < m_Capacity; ++t_i)
+						m_Slots[t_i].m_Sequence.store(t_i, ::std::memory_order_relaxed);
+				}
+
+				~ring_buffer()
+				{
+					// Destroy all elements that were never consumed
+					while(try_pop([](T&){ }));
+				}
+
+				ring_buffer(const ring_buffer&) = delete;
+				ring_buffer(ring_buffer&&) = delete;
+
+				ring_buffer& operator=(const ring_buffer&) = delete;
+				ring_buffer& operator=(ring_buffer&&) = delete;
+
+			public:
+				// Insert element. Returns false if it, or the oldest element, had to be dropped.
+				// Must only be called by the owning producer thread.
+				auto push(T&& p_value)
+					-> bool
+				{
+					const auto t_pos = m_Write.load(::std::memory_order_relaxed);
+					auto& t_slot = m_Slots[t_pos % m_Capacity];
+					bool t_dropped{false};
+
+					while(t_slot.m_Sequence.load(::std::memory_order_acquire) != t_pos)
+					{
+						// The slot still holds an element from the previous lap
+						if(m_Closed.load(::std::memory_order_relaxed) || m_Policy == overflow_policy::drop_newest)
+						{
+							m_Dropped.fetch_add(1, ::std::memory_order_relaxed);
+							return false;
+						}
+						else if(m_Policy == overflow_policy::drop_oldest && evict(t_pos))
+							t_dropped = true;
+						else ::std::this_thread::yield();
+					}
+
+					new (t_slot.get()) T(::std::move(p_value));
+
+					// Publish element to the consumer
+					t_slot.m_Sequence.store(t_pos + 1, ::std::memory_order_release);
+					m_Write.store(t_pos + 1, ::std::memory_order_release);
+
+					return !t_dropped;
+				}
+
+				// Remove the oldest element and pass it to given function.
+				// Returns false if there was nothing to consume. Elements inserted after
+				// begin_block() are held back until end_block() is called, unless the
+				// buffer is full.
+				template< typename F >
+				auto try_pop(F&& p_func)
+					-> bool
+				{
+					auto t_pos = m_Read.load(::std::memory_order_relaxed);
+
+					while(true)
+					{
+						auto& t_slot = m_Slots[t_pos % m_Capacity];
+
+						if(t_slot.m_Sequence.load(::std::memory_order_acquire) != t_pos + 1)
+							return false;
+
+						// Any block that was begun before this element was published is visible now
+						const auto t_block = m_BlockBegin.load(::std::memory_order_acquire);
+						if(t_block != no_block && t_pos >= t_block && !full(t_pos))
+							return false;
+
+						// Claim element. This only fails if the producer evicted it in the meantime.
+						if(m_Read.compare_exchange_weak(t_pos, t_pos + 1, ::std::memory_order_acq_rel, ::std::memory_order_relaxed))
+						{
+							p_func(*t_slot.get());
+							t_slot.get()->~T();
+							t_slot.m_Sequence.store(t_pos + m_Capacity, ::std::memory_order_release);
+							return true;
+						}
+					}
+				}
+
+			public:
+				// Mark the start of a LOCK/UNLOCK block. Only to be called by the producer.
+				auto begin_block()
+					-> void
+				{
+					m_BlockBegin.store(m_Write.load(::std::memory_order_relaxed), ::std::memory_order_seq_cst);
+				}
+
+				// Mark the end of a LOCK/UNLOCK block. Only to be called by the producer.
+				auto end_block()
+					-> void
+				{
+					m_BlockBegin.store(no_block, ::std::memory_order_release);
+				}
+
+				// Make all further insertions fail. Used on logger shutdown to release blocked producers.
+				auto close()
+					-> void
+				{
+					m_Closed.store(true, ::std::memory_order_relaxed);
+				}
+
+			public:
+				auto empty() const
+					-> bool
+				{
+					return m_Read.load(::std::memory_order_acquire) == m_Write.load(::std::memory_order_acquire);
+				}
+
+				auto capacity() const
+					-> ::std::size_t
+				{
+					return m_Capacity;
+				}
+
+				// Whether the next insertion finds no free slot
+				auto full() const
+					-> bool
+				{
+					return full(m_Read.load(::std::memory_order_acquire));
+				}
+
+				// Number of elements currently waiting. Only an estimate while either side is active.
+				auto size() const
+					-> ::std::size_t
+				{
+					const auto t_read = m_Read.load(::std::memory_order_relaxed);
+					const auto t_write = m_Write.load(::std::memory_order_relaxed);
+
+					return t_write > t_read ? t_write - t_read : 0;
+				}
+
+				// Number of elements the consumer could take right now. Unlike size(), this
+				// excludes elements held back by a LOCK/UNLOCK block.
+				auto available() const
+					-> ::std::size_t
+				{
+					const auto t_read = m_Read.load(::std::memory_order_acquire);
+					const auto t_write = m_Write.load(::std::memory_order_acquire);
+					const auto t_block = m_BlockBegin.load(::std::memory_order_acquire);
+					
+					const auto t_end = (t_block != no_block && t_block < t_write && !full(t_read)) ? t_block : t_write;
+					
+					return t_end > t_read ? t_end - t_read : 0;
+				}
+
+				// Number of elements ever inserted
+				auto pushed() const
+					-> ::std::size_t
+				{
+					return m_Write.load(::std::memory_order_relaxed);
+				}
+
+				auto policy() const
+					-> overflow_policy
+				{
+					return m_Policy;
+				}
+
+				// Number of elements that were discarded due to the overflow policy
+				auto dropped() const
+					-> ::std::size_t
+				{
+					return m_Dropped.load(::std::memory_order_relaxed);
+				}
+
+			private:
+				auto full(::std::size_t p_read) const
+					-> bool
+				{
+					return m_Write.load(::std::memory_order_acquire) - p_read >= m_Capacity;
+				}
+
+				// Try to discard the oldest element to free the slot needed for given write position.
+				auto evict(::std::size_t p_write)
+					-> bool
+				{
+					auto t_pos = m_Read.load(::std::memory_order_acquire);
+
+					// The consumer already claimed the slot we are waiting for. It will be released shortly.
+					if(t_pos + m_Capacity != p_write)
+					{
+						::std::this_thread::yield();
+						return false;
+					}
+
+					auto& t_slot = m_Slots[t_pos % m_Capacity];
+
+					if(t_slot.m_Sequence.load(::std::memory_order_acquire) == t_pos + 1 &&
+					   m_Read.compare_exchange_strong(t_pos, t_pos + 1, ::std::memory_order_acq_rel, ::std::memory_order_relaxed))
+					{
+						t_slot.get()->~T();
+						t_slot.m_Sequence.store(t_pos + m_Capacity, ::std::memory_order_release);
+						m_Dropped.fetch_add(1, ::std::memory_order_relaxed);
+						return true;
+					}
+
+					return false;
+				}
+
+			private:
+				const ::std::size_t m_Capacity;						//< Number of slots
+				const overflow_policy m_Policy;						//< What to do when the buffer is full
+				::std::unique_ptr<slot[]> m_Slots;					//< Pre-allocated slot storage
+				::std::atomic_bool m_Closed{false};					//< Whether insertions are still accepted
+				::std::atomic<::std::size_t> m_Dropped{0};			//< Number of discarded elements
+				::std::atomic<::std::size_t> m_BlockBegin{no_block};	//< Write position of the current LOCK/UNLOCK block
+
+				// Keep indices on separate cache lines to avoid false sharing between producer and consumer
+				alignas(64) ::std::atomic<::std::size_t> m_Write{0};
+				alignas(64) ::std::atomic<::std::size_t> m_Read{0};
+		};
+	}
+}
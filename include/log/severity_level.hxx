@@ -15,6 +15,14 @@
 
 #pragma once
 
+// Least severe level that is compiled in, as numeric value of lg::severity_level
+// (0 = fatal, ..., 4 = debug). LOG_* macros for less severe levels are removed entirely,
+// without evaluating their operands. Define this before including any liblog header,
+// e.g. -DLIBLOG_MIN_LEVEL=3 to strip all debug messages from release builds.
+#ifndef LIBLOG_MIN_LEVEL
+#	define LIBLOG_MIN_LEVEL 4
+#endif
+
 namespace lg
 {
 	enum class severity_level
@@ -25,4 +33,7 @@ namespace lg
 		info,
 		debug
 	};
+	
+	// Least severe level that is compiled in
+	constexpr severity_level min_level = static_cast<severity_level>(LIBLOG_MIN_LEVEL);
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lg
+{
+	// Settings of the slab arenas holding the text of messages that outgrow the inline storage
+	struct arena_options
+	{
+		::std::size_t m_SlabSize{64u << 10};	//< Size of a single slab. Messages larger than a quarter of it always use the heap.
+		::std::size_t m_MaxBytes{16u << 20};	//< High-water mark for the slabs of all threads. Beyond it, messages use the heap.
+	};
+
+	// Memory usage of all slab arenas
+	struct arena_stats
+	{
+		::std::size_t m_Bytes;				//< Bytes currently held by slabs, including unused ones kept for reuse
+		::std::size_t m_Peak;				//< Largest value m_Bytes ever had
+		::std::size_t m_Slabs;				//< Number of slabs currently allocated
+		::std::uint64_t m_HeapFallbacks;	//< Number of message allocations that were served by the heap instead
+	};
+
+	namespace internal
+	{
+		struct slab;
+
+		// Storage of message text. Blocks without a slab were allocated from the heap.
+		struct arena_block
+		{
+			char* m_Data{nullptr};
+			slab* m_Slab{nullptr};
+		};
+
+		// Allocate given number of bytes from the arena of the calling thread. Every thread
+		// fills one slab at a time. A slab is returned to the arena of its thread as a whole
+		// once all blocks allocated from it were released, which usually happens when the
+		// batch containing the corresponding entries was written. Releasing single blocks thus
+		// never touches the global allocator, no matter which thread does it.
+		auto arena_allocate(::std::size_t p_size)
+			-> arena_block;
+
+		// Release given block. May be called from any thread.
+		auto arena_release(const arena_block& p_block)
+			-> void;
+
+		// Change the settings used for slabs allocated from now on
+		auto configure_arenas(const arena_options& p_options)
+			-> void;
+
+		auto arena_statistics()
+			-> arena_stats;
+	}
+}
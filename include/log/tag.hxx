@@ -16,49 +16,55 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
 
 namespace lg
 {
+	// Small number a tag name is interned into, see tag_registry.hxx. Zero stands for "no tag".
+	using tag_id = ::std::uint16_t;
+
 	namespace internal
 	{
-		// Structure used to hold tag label and signal the implementation
+		// Structure used to hold an interned tag and signal the implementation
 		// that its meant to be interpreted as such
 		class tag_t
 		{
 			public:
-				// Taking the string by value is by design here, since this way
-				// we can take advantage of move semantics
-				tag_t(::std::string p_str)
-					: m_Tag{::std::move(p_str)}
+				constexpr explicit tag_t(tag_id p_id = 0)
+					: m_Id{p_id}
 				{
 					
 				}
 				
-				tag_t() = default;
-				tag_t(const tag_t&) = default;
-				tag_t(tag_t&&) = default;
-				
-				tag_t& operator=(const tag_t&) = default;
-				tag_t& operator=(tag_t&&) = default;
+				// Returned by the tag lookup of the LOG_*_TAG macros if the statement is turned off
+				static constexpr auto disabled()
+					-> tag_t
+				{
+					tag_t t_tag{ };
+					t_tag.m_Disabled = true;
+					return t_tag;
+				}
 				
 			public:
-				auto value() const &
-					-> const ::std::string&
+				constexpr auto id() const
+					-> tag_id
 				{
-					return m_Tag;
+					return m_Id;
 				}
-					
-				auto value() &&
-					-> ::std::string&&
+				
+				// Whether entries with this tag are to be logged
+				constexpr explicit operator bool() const
 				{
-					return ::std::move(m_Tag);
+					return !m_Disabled;
 				}
 		
 			private:
-				::std::string m_Tag{ };
+				tag_id m_Id{0};
+				bool m_Disabled{false};
 		};
 	}
 	
-	// Passing string by value is intented here in order to leverage move semantics
-	auto tag(::std::string) -> internal::tag_t;
+	// Intern given tag name. This takes a lock, the LOG_*_TAG macros instead only
+	// look the name up once per call site.
+	auto tag(const ::std::string& p_str) -> internal::tag_t;
 }
@@ -0,0 +1,136 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+#include "severity_level.hxx"
+#include "tag.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		// Maximum number of distinct tags. Tags interned beyond this are dropped, i.e. entries are untagged.
+		constexpr ::std::size_t max_tags = ::std::size_t{1} << 16;
+		
+		// Number of tags allocated at once. Chunks are never moved or freed.
+		constexpr ::std::size_t tag_chunk_size = 256;
+		
+		struct tag_info
+		{
+			::std::string m_Name{ };
+			::std::atomic<int> m_Threshold{static_cast<int>(severity_level::debug)};	//< Most verbose level that passes, or -1 if the tag is turned off
+		};
+		
+		// Chunks of the tag table, indexed by id / tag_chunk_size. A chunk is published before
+		// any of its ids is handed out.
+		extern ::std::atomic<tag_info*> g_TagChunks[max_tags / tag_chunk_size];
+		
+		// Interns tag names into small ids, which are assigned in order of first use and stay
+		// valid until the process ends. Log entries and sinks refer to tags by id and look the
+		// name up when needed. Looking up name or threshold of an id does not lock.
+		class tag_registry
+		{
+			public:
+				// Retrieve id of given tag name, registering it if needed. The empty name is id zero.
+				static auto intern(const ::std::string& p_name)
+					-> tag_id;
+					
+				static auto intern(const char* p_name)
+					-> tag_id;
+				
+				static auto name(tag_id p_id)
+					-> const ::std::string&
+				{
+					static const ::std::string t_empty{ };
+					return (p_id == 0) ? t_empty : info(p_id).m_Name;
+				}
+				
+				// Whether entries of given level pass the threshold of given tag
+				static auto enabled(tag_id p_id, severity_level p_lvl)
+					-> bool
+				{
+					return p_id == 0 || static_cast<int>(p_lvl) <= info(p_id).m_Threshold.load(::std::memory_order_relaxed);
+				}
+				
+				// Set threshold of given tag, -1 turns it off
+				static auto set_threshold(const ::std::string& p_name, int p_lvl)
+					-> void;
+					
+				// Copy of the name table, indexed by tag id
+				static auto names()
+					-> ::std::vector<::std::string>;
+					
+			private:
+				static auto info(tag_id p_id)
+					-> tag_info&
+				{
+					return g_TagChunks[p_id / tag_chunk_size].load(::std::memory_order_acquire)[p_id % tag_chunk_size];
+				}
+		};
+		
+		// Caches the id of the tag given to a LOG_*_TAG statement, of which there is one instance
+		// per call site. The cached name is compared on every use, so statements with varying
+		// tags stay correct and only miss the cache.
+		class tag_cache
+		{
+			public:
+				// Retrieve the tag with given name, or a disabled tag if entries of given level are turned off for it
+				auto resolve(const char* p_name, severity_level p_lvl)
+					-> tag_t
+				{
+					if(*p_name == '\0')
+						return tag_t{ };
+						
+					auto t_id = m_Id.load(::std::memory_order_acquire);
+					
+					if(t_id == 0 || tag_registry::name(t_id) != p_name)
+					{
+						t_id = tag_registry::intern(p_name);
+						m_Id.store(t_id, ::std::memory_order_release);
+					}
+					
+					return tag_registry::enabled(t_id, p_lvl) ? tag_t{ t_id } : tag_t::disabled();
+				}
+				
+				auto resolve(const ::std::string& p_name, severity_level p_lvl)
+					-> tag_t
+				{
+					return resolve(p_name.c_str(), p_lvl);
+				}
+				
+			private:
+				::std::atomic<tag_id> m_Id{0};
+		};
+	}
+	
+	// Only let entries with given tag pass if they are of given level or more severe.
+	// All tags start out at debug. Takes effect immediately, also for tags not used yet.
+	auto set_tag_threshold(const ::std::string& p_tag, severity_level p_lvl)
+		-> void;
+		
+	// Drop all entries with given tag. LOG_*_TAG statements using it skip constructing the entry.
+	auto disable_tag(const ::std::string& p_tag)
+		-> void;
+		
+	// Let all entries with given tag pass again
+	auto enable_tag(const ::std::string& p_tag)
+		-> void;
+}
@@ -0,0 +1,94 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <ctime>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace lg
+{
+	// Sub-second precision of rendered timestamps
+	enum class time_precision
+	{
+		seconds,
+		milliseconds,
+		microseconds,
+		nanoseconds
+	};
+
+	// Raw point in time, stored as nanoseconds since the system clock epoch.
+	// Recording one is a single clock read, rendering it into text is deferred
+	// until a formatter actually needs it.
+	class timestamp
+	{
+		using clock_type = ::std::chrono::system_clock;
+
+		public:
+			timestamp() = default;
+
+			explicit timestamp(::std::int64_t p_ns)
+				: m_Ticks{p_ns}
+			{
+			}
+
+		public:
+			// Capture current time
+			static auto now()
+				-> timestamp
+			{
+				return timestamp{
+					::std::chrono::duration_cast<::std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count()
+				};
+			}
+
+		public:
+			// Nanoseconds since epoch
+			auto nanoseconds() const
+				-> ::std::int64_t
+			{
+				return m_Ticks;
+			}
+
+			// Whole seconds since epoch
+			auto to_time_t() const
+				-> ::std::time_t
+			{
+				return static_cast<::std::time_t>(m_Ticks / 1000000000);
+			}
+
+			// Nanoseconds elapsed since the last whole second
+			auto subsecond() const
+				-> ::std::uint32_t
+			{
+				return static_cast<::std::uint32_t>(m_Ticks % 1000000000);
+			}
+
+		private:
+			::std::int64_t m_Ticks{ };
+	};
+
+	// Buffer size required by format_time, including the null terminator ("HH:MM:SS.nnnnnnnnn")
+	constexpr ::std::size_t time_buffer_size = 19;
+
+	// Render local time of day of given timestamp as "%H:%M:%S", followed by the
+	// requested sub-second digits, into given buffer, which has to hold at least
+	// time_buffer_size characters. Returns the length of the rendered string.
+	// The "%H:%M:%S" prefix is cached per thread and only recomputed once per second.
+	auto format_time(timestamp p_time, time_precision p_precision, char* p_buffer)
+		-> ::std::size_t;
+}
@@ -0,0 +1,121 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+// UNIX domain sockets are only available on POSIX systems
+#if !defined(_WIN32)
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "log_target.hxx"
+#include "log_entry.hxx"
+#include "network_protocol.hxx"
+
+namespace lg
+{
+	// Settings of a UNIX datagram target
+	struct unix_datagram_options
+	{
+		bool m_SeqPacket{false};							//< Use a connection-oriented SOCK_SEQPACKET socket instead of SOCK_DGRAM
+		bool m_NonBlocking{true};							//< Drop datagrams the receiver has no room for instead of waiting for it
+		::std::chrono::milliseconds m_RetryInterval{1000};	//< Minimum delay between attempts to reach an absent receiver
+		protocol_options m_Protocol{ protocol_version::v1, false, 32u << 10 };	//< Every v1 packet and v2 frame is sent as one datagram
+	};
+	
+	namespace internal
+	{
+		struct unix_datagram_data;
+	}
+
+	// Log target sending entries to a local receiver, e.g. a log shipping agent, over a UNIX
+	// domain socket. Every v1 packet or v2 frame, see network_protocol.hxx, is sent as a datagram
+	// of its own, and all datagrams of a batch are handed to the kernel using as few sendmmsg
+	// calls as possible. An absent receiver does not make construction fail. Entries are
+	// dropped until it appears, which is checked at most once per retry interval.
+	class unix_datagram_target
+		: public log_target
+	{
+		public:
+			unix_datagram_target(
+				severity_level p_lvl,
+				const ::std::string& p_path,
+				const ::std::string& p_src = ::std::string{},
+				const unix_datagram_options& p_options = unix_datagram_options{ }
+			);
+			
+			~unix_datagram_target();
+
+			unix_datagram_target(const unix_datagram_target&) = delete;
+			unix_datagram_target(unix_datagram_target&&) = delete;
+
+			unix_datagram_target& operator=(const unix_datagram_target&) = delete;
+			unix_datagram_target& operator=(unix_datagram_target&&) = delete;
+
+		public:
+			virtual void write(const log_entry& entry) override;
+			virtual void write_batch(entry_span entries) override;
+			
+		public:
+			// Whether the socket is currently connected to the receiver
+			auto connected() const
+				-> bool;
+				
+			// Number of entries that were dropped because the receiver was absent or had no room for them
+			auto dropped() const
+				-> ::std::uint64_t;
+				
+			// Number of datagrams that were handed to the receiver
+			auto sent() const
+				-> ::std::uint64_t;
+				
+		private:
+			// Try to connect to the receiver, unless the last attempt happened less than the retry interval ago
+			auto connect()
+				-> bool;
+				
+			auto disconnect()
+				-> void;
+				
+			// Send all encoded datagrams. Those that could not be sent are counted as dropped.
+			auto send()
+				-> void;
+				
+			// Count entries of the datagrams in given range as dropped
+			auto drop(::std::size_t p_begin, ::std::size_t p_end)
+				-> void;
+
+		private:
+			::std::string m_Path;							// Path of the receiving socket
+			unix_datagram_options m_Options;
+			int m_Fd{-1};									// Socket, -1 if not connected
+			::std::chrono::steady_clock::time_point m_LastAttempt{ };	// Time of the last connection attempt
+			internal::protocol_encoder m_Encoder;			// Encodes entries using the configured protocol version
+			::std::string m_Packets;						// Buffer the datagrams of a batch are encoded into
+			::std::vector<internal::frame_info> m_Frames;	// Datagrams contained in m_Packets
+			::std::unique_ptr<internal::unix_datagram_data> m_Data;	// Message headers passed to the kernel
+			::std::atomic<bool> m_Connected{false};
+			::std::atomic<::std::uint64_t> m_Dropped{0};
+			::std::atomic<::std::uint64_t> m_Sent{0};
+	};
+}
+
+#endif
@@ -0,0 +1,525 @@
+#define ASIO_STANDALONE 1
+
+#include <list>
+#include <array>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <condition_variable>
+#include <asio.hpp>
+
+#include <async_network_target.hxx>
+
+namespace lg
+{
+	namespace internal
+	{
+		// Everything the asynchronous network target needs. This is hidden from
+		// the header in order to not expose asio to the outer world.
+		// All members prefixed with "do_" or "on_" only ever run on the I/O thread.
+		struct async_network_data
+		{
+			using lock_type = ::std::unique_lock<::std::mutex>;
+		
+			// Block of encoded packets. Packets never span two chunks, which allows chunks
+			// to be sent again on their own after the connection was lost.
+			struct chunk
+			{
+				::std::string m_Data{ };
+				::std::uint64_t m_Entries{0};
+			};
+			
+			// Header of a chunk record in the spill file
+			struct spill_header
+			{
+				::std::uint64_t m_Size;
+				::std::uint64_t m_Entries;
+			};
+		
+			async_network_data(const ::std::string& p_host, const ::std::string& p_port, const async_network_options& p_options)
+				:	m_Host{p_host},
+					m_Port{p_port},
+					m_Options{p_options},
+					m_Backoff{p_options.m_BackoffInitial},
+					m_Work{m_Service},
+					m_Socket{m_Service},
+					m_Resolver{m_Service},
+					m_Timer{m_Service}
+			{
+				m_Service.post([this](){ do_connect(); });
+				m_Thread = ::std::thread{ [this](){ m_Service.run(); } };
+			}
+			
+			~async_network_data()
+			{
+				{
+					// Give the I/O thread a chance to send what is left
+					lock_type lck(m_Mtx);
+					
+					m_Cv.wait_for(lck, m_Options.m_ShutdownTimeout, [this]()
+					{
+						return m_Chunks.empty() && !spilled();
+					});
+				
+					m_Stopping = true;
+				}
+				
+				m_Cv.notify_all();
+				m_Service.stop();
+				m_Thread.join();
+				
+				if(m_Spill.is_open())
+				{
+					m_Spill.close();
+					::std::remove(m_Options.m_SpillPath.c_str());
+				}
+			}
+			
+			// Wait until all buffered chunks were sent or the connection is lost. Called by the logger thread.
+			auto drain()
+				-> void
+			{
+				lock_type lck(m_Mtx);
+				
+				m_Cv.wait_for(lck, m_Options.m_ShutdownTimeout, [this]()
+				{
+					return (m_Chunks.empty() && !spilled()) || !m_Connected.load() || m_Stopping;
+				});
+			}
+			
+			// Enqueue packets stored back to back in given buffer. Called by the logger thread.
+			auto enqueue(const ::std::string& p_packets, const ::std::vector<frame_info>& p_frames)
+				-> void
+			{
+				{
+					lock_type lck(m_Mtx);
+					
+					::std::size_t t_begin{0};
+					
+					for(const auto& t_frame : p_frames)
+					{
+						enqueue_packet(lck, p_packets.data() + t_begin, t_frame.m_End - t_begin, t_frame.m_Records);
+						t_begin = t_frame.m_End;
+					}
+				}
+				
+				// Only post a send request if there is none pending yet
+				if(m_Connected.load() && !m_KickPending.exchange(true))
+				{
+					m_Service.post([this]()
+					{
+						m_KickPending.store(false);
+						do_send();
+					});
+				}
+			}
+			
+			auto enqueue_packet(lock_type& p_lck, const char* p_data, ::std::size_t p_len, ::std::size_t p_entries)
+				-> void
+			{
+				while(true)
+				{
+					// Once packets were spilled, all further ones have to be spilled too in order to keep them ordered.
+					// A packet that is bigger than the whole memory limit is accepted if nothing else is buffered.
+					if(!spilled() && (m_Buffered == 0 || m_Buffered + p_len <= m_Options.m_MaxBufferedBytes))
+					{
+						append_memory(p_data, p_len, p_entries);
+						return;
+					}
+					
+					if(spill_available(p_len))
+					{
+						append_spill(p_data, p_len, p_entries);
+						return;
+					}
+					
+					// Memory and spill file are full
+					if(m_Options.m_Overflow == overflow_policy::block && !m_Stopping)
+						m_Cv.wait(p_lck);
+					else if(m_Options.m_Overflow == overflow_policy::drop_oldest && !spilled() && evict_oldest())
+						continue;
+					else break;
+				}
+				
+				m_Dropped += p_entries;
+			}
+			
+			auto append_memory(const char* p_data, ::std::size_t p_len, ::std::size_t p_entries)
+				-> void
+			{
+				// The last chunk can only be extended if it is not being sent right now
+				if(m_Chunks.size() <= m_InFlight || m_Chunks.back().m_Data.size() + p_len > m_Options.m_ChunkSize)
+				{
+					m_Chunks.emplace_back();
+					m_Chunks.back().m_Data.reserve(::std::max(p_len, m_Options.m_ChunkSize));
+				}
+				
+				auto& t_chunk = m_Chunks.back();
+				t_chunk.m_Data.append(p_data, p_len);
+				t_chunk.m_Entries += p_entries;
+				
+				m_Buffered += p_len;
+			}
+			
+			// Discard the oldest chunk that is not currently being sent
+			auto evict_oldest()
+				-> bool
+			{
+				if(m_Chunks.size() <= m_InFlight)
+					return false;
+					
+				const auto t_it = ::std::next(m_Chunks.begin(), m_InFlight);
+				
+				m_Dropped += t_it->m_Entries;
+				m_Buffered -= t_it->m_Data.size();
+				m_Chunks.erase(t_it);
+				
+				return true;
+			}
+			
+		public:
+			// Whether there is spilled data that still has to be sent
+			auto spilled() const
+				-> bool
+			{
+				return m_SpillRead < m_SpillWrite || !m_SpillTail.m_Data.empty();
+			}
+			
+			auto spill_available(::std::size_t p_len) const
+				-> bool
+			{
+				return !m_Options.m_SpillPath.empty()
+					&& (m_SpillWrite - m_SpillRead) + m_SpillTail.m_Data.size() + p_len <= m_Options.m_MaxSpillBytes;
+			}
+			
+			// Packets are collected in a chunk kept in memory, which is written to the spill file once full
+			auto append_spill(const char* p_data, ::std::size_t p_len, ::std::size_t p_entries)
+				-> void
+			{
+				if(!m_SpillTail.m_Data.empty() && m_SpillTail.m_Data.size() + p_len > m_Options.m_ChunkSize)
+					write_spill_tail();
+			
+				m_SpillTail.m_Data.append(p_data, p_len);
+				m_SpillTail.m_Entries += p_entries;
+			}
+			
+			auto write_spill_tail()
+				-> void
+			{
+				if(!m_Spill.is_open())
+				{
+					m_Spill.open(m_Options.m_SpillPath, ::std::ios::in | ::std::ios::out | ::std::ios::binary | ::std::ios::trunc);
+					m_SpillRead = m_SpillWrite = 0;
+				}
+				
+				const spill_header t_header{ m_SpillTail.m_Data.size(), m_SpillTail.m_Entries };
+				
+				m_Spill.seekp(static_cast<::std::streamoff>(m_SpillWrite));
+				m_Spill.write(reinterpret_cast<const char*>(&t_header), sizeof(t_header));
+				m_Spill.write(m_SpillTail.m_Data.data(), m_SpillTail.m_Data.size());
+				
+				if(m_Spill)
+					m_SpillWrite += sizeof(t_header) + t_header.m_Size;
+				else
+				{
+					m_Spill.clear();
+					m_Dropped += m_SpillTail.m_Entries;
+				}
+				
+				m_SpillTail = chunk{ };
+			}
+			
+			// Move spilled chunks back into memory while there is enough room
+			auto refill()
+				-> void
+			{
+				while(spilled() && m_Buffered < m_Options.m_MaxBufferedBytes / 2)
+				{
+					chunk t_chunk{ };
+				
+					if(m_SpillRead < m_SpillWrite)
+					{
+						spill_header t_header{ };
+					
+						m_Spill.seekg(static_cast<::std::streamoff>(m_SpillRead));
+						m_Spill.read(reinterpret_cast<char*>(&t_header), sizeof(t_header));
+						
+						t_chunk.m_Data.resize(static_cast<::std::size_t>(t_header.m_Size));
+						t_chunk.m_Entries = t_header.m_Entries;
+						m_Spill.read(&t_chunk.m_Data[0], t_chunk.m_Data.size());
+						
+						m_SpillRead += sizeof(t_header) + t_header.m_Size;
+						
+						if(!m_Spill)
+						{
+							// The spill file is unusable. Everything in it is lost.
+							m_Spill.clear();
+							m_Dropped += t_chunk.m_Entries;
+							continue;
+						}
+					}
+					else ::std::swap(t_chunk, m_SpillTail);
+					
+					m_Buffered += t_chunk.m_Data.size();
+					m_Chunks.push_back(::std::move(t_chunk));
+				}
+				
+				// Start over at the beginning of the file once it was drained
+				if(!spilled())
+					m_SpillRead = m_SpillWrite = 0;
+			}
+			
+		public:
+			auto do_connect()
+				-> void
+			{
+				asio::ip::tcp::resolver::query t_query(m_Host, m_Port);
+				
+				m_Resolver.async_resolve(t_query, [this](const asio::error_code& p_err, asio::ip::tcp::resolver::iterator p_it)
+				{
+					if(p_err)
+					{
+						schedule_reconnect();
+						return;
+					}
+					
+					asio::async_connect(m_Socket, p_it, [this](const asio::error_code& p_err, asio::ip::tcp::resolver::iterator)
+					{
+						on_connected(p_err);
+					});
+				});
+			}
+			
+			auto on_connected(const asio::error_code& p_err)
+				-> void
+			{
+				if(p_err)
+				{
+					asio::error_code t_ignored{ };
+					m_Socket.close(t_ignored);
+					
+					schedule_reconnect();
+					return;
+				}
+				
+				if(m_EverConnected)
+					++m_Reconnects;
+				
+				m_EverConnected = true;
+				m_Backoff = m_Options.m_BackoffInitial;
+				m_Connected.store(true);
+				
+				do_read();
+				do_send();
+			}
+			
+			auto schedule_reconnect()
+				-> void
+			{
+				m_Timer.expires_from_now(m_Backoff);
+				m_Backoff = ::std::min(m_Backoff * 2, m_Options.m_BackoffMax);
+				
+				m_Timer.async_wait([this](const asio::error_code& p_err)
+				{
+					if(!p_err)
+						do_connect();
+				});
+			}
+			
+			// The server is not expected to send anything. Reading is only used to notice
+			// a closed connection while there is nothing to send.
+			auto do_read()
+				-> void
+			{
+				m_Socket.async_read_some(asio::buffer(m_ReadBuffer), [this](const asio::error_code& p_err, ::std::size_t)
+				{
+					if(p_err)
+						on_disconnected();
+					else do_read();
+				});
+			}
+			
+			auto on_disconnected()
+				-> void
+			{
+				// Both a pending read and a pending write report the same loss of connection
+				if(!m_Connected.exchange(false))
+					return;
+				
+				asio::error_code t_ignored{ };
+				m_Socket.close(t_ignored);
+				
+				// Release a flushing logger thread. Taking the lock makes sure it is either
+				// waiting already or sees the connection gone.
+				{
+					lock_type lck(m_Mtx);
+				}
+				
+				m_Cv.notify_all();
+				
+				schedule_reconnect();
+			}
+			
+			// Send as many whole chunks as allowed using one scatter-gather write
+			auto do_send()
+				-> void
+			{
+				lock_type lck(m_Mtx);
+			
+				if(!m_Connected.load() || m_InFlight > 0)
+					return;
+					
+				refill();
+				
+				m_Gather.clear();
+				::std::size_t t_bytes{0};
+				
+				for(const auto& t_chunk : m_Chunks)
+				{
+					if(!m_Gather.empty() && t_bytes + t_chunk.m_Data.size() > m_Options.m_MaxSendBytes)
+						break;
+						
+					m_Gather.push_back(asio::buffer(t_chunk.m_Data.data(), t_chunk.m_Data.size()));
+					t_bytes += t_chunk.m_Data.size();
+					++m_InFlight;
+				}
+				
+				if(m_InFlight == 0)
+					return;
+					
+				asio::async_write(m_Socket, m_Gather, [this](const asio::error_code& p_err, ::std::size_t)
+				{
+					on_sent(p_err);
+				});
+			}
+			
+			auto on_sent(const asio::error_code& p_err)
+				-> void
+			{
+				{
+					lock_type lck(m_Mtx);
+					
+					// If sending failed, all chunks that were in flight are sent again after reconnecting
+					if(!p_err)
+					{
+						for(; m_InFlight > 0; --m_InFlight)
+						{
+							m_Buffered -= m_Chunks.front().m_Data.size();
+							m_Chunks.pop_front();
+						}
+					}
+					
+					m_InFlight = 0;
+				}
+				
+				m_Cv.notify_all();
+				
+				if(p_err)
+					on_disconnected();
+				else do_send();
+			}
+			
+		public:
+			const ::std::string m_Host;
+			const ::std::string m_Port;
+			const async_network_options m_Options;
+			
+			// State shared with the logger thread, guarded by m_Mtx
+			mutable ::std::mutex m_Mtx;
+			::std::condition_variable m_Cv;					//< Signalled whenever buffer space was freed
+			::std::list<chunk> m_Chunks;					//< Chunks waiting to be sent. Nodes are stable while being sent.
+			::std::size_t m_InFlight{0};					//< Number of chunks at the front that are currently being sent
+			::std::uint64_t m_Buffered{0};					//< Total size of all chunks in memory
+			::std::uint64_t m_Dropped{0};					//< Number of discarded entries
+			bool m_Stopping{false};							//< Set on destruction to release a blocked logger thread
+			::std::fstream m_Spill;							//< Spill file, opened on first use
+			::std::uint64_t m_SpillRead{0};					//< Offset of the oldest chunk record in the spill file
+			::std::uint64_t m_SpillWrite{0};				//< End of the last chunk record in the spill file
+			chunk m_SpillTail{ };							//< Newest spilled packets, not yet written to the file
+			
+			::std::atomic_bool m_Connected{false};
+			::std::atomic_bool m_KickPending{false};		//< Whether a send request was posted that did not run yet
+			::std::atomic<::std::uint64_t> m_Reconnects{0};
+			
+			// State only used by the I/O thread
+			bool m_EverConnected{false};
+			::std::chrono::milliseconds m_Backoff;
+			::std::vector<asio::const_buffer> m_Gather;		//< Buffers of the write currently in progress
+			::std::array<char, 64> m_ReadBuffer;
+			
+			asio::io_service m_Service;
+			asio::io_service::work m_Work;					//< Keeps the service running while there is nothing to do
+			asio::ip::tcp::socket m_Socket;
+			asio::ip::tcp::resolver m_Resolver;
+			asio::steady_timer m_Timer;						//< Used to delay reconnection attempts
+			::std::thread m_Thread;							//< I/O thread running the service
+		};
+	}
+	
+	async_network_target::async_network_target(
+		severity_level p_lvl,
+		const ::std::string& p_host,
+		const ::std::string& p_port,
+		const ::std::string& p_src,
+		const async_network_options& p_options
+	)
+		:	log_target(p_lvl),
+			m_Encoder{p_src, p_options.m_Protocol},
+			m_Data{ ::std::make_unique<internal::async_network_data>(p_host, p_port, p_options) }
+	{
+	}
+	
+	async_network_target::~async_network_target()
+	{
+	}
+	
+	void async_network_target::write(const log_entry& p_entry)
+	{
+		const log_entry* t_entry = &p_entry;
+		write_batch(entry_span{ &t_entry, 1 });
+	}
+	
+	void async_network_target::write_batch(entry_span p_entries)
+	{
+		m_Packets.clear();
+		m_Frames.clear();
+		
+		m_Encoder.encode(m_Packets, p_entries, m_Frames);
+		m_Data->enqueue(m_Packets, m_Frames);
+	}
+	
+	void async_network_target::flush()
+	{
+		m_Data->drain();
+	}
+	
+	auto async_network_target::connected() const
+		-> bool
+	{
+		return m_Data->m_Connected.load();
+	}
+	
+	auto async_network_target::dropped() const
+		-> ::std::uint64_t
+	{
+		::std::lock_guard<::std::mutex> lck(m_Data->m_Mtx);
+		return m_Data->m_Dropped;
+	}
+	
+	auto async_network_target::buffered() const
+		-> ::std::uint64_t
+	{
+		::std::lock_guard<::std::mutex> lck(m_Data->m_Mtx);
+		return m_Data->m_Buffered + (m_Data->m_SpillWrite - m_Data->m_SpillRead) + m_Data->m_SpillTail.m_Data.size();
+	}
+	
+	auto async_network_target::reconnects() const
+		-> ::std::uint64_t
+	{
+		return m_Data->m_Reconnects.load();
+	}
+}
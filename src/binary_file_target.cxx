@@ -0,0 +1,121 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "binary_file_target.hxx"
+
+namespace lg
+{
+	namespace
+	{
+		auto make_protocol(const binary_file_options& p_options)
+			-> protocol_options
+		{
+			protocol_options t_protocol{ };
+			t_protocol.m_Version = protocol_version::v2;
+			t_protocol.m_Compress = p_options.m_Compress;
+			return t_protocol;
+		}
+	}
+
+	binary_file_target::binary_file_target(severity_level p_lvl, const ::std::string& p_path, const binary_file_options& p_options, flush_policy p_policy)
+		:	log_target(p_lvl),
+			m_Options{p_options},
+			m_Policy{p_policy},
+			m_Encoder{p_options.m_Source, make_protocol(p_options)},
+			m_Data{p_path, true, true},
+			m_Index{p_path + ".idx", true, true}
+	{
+		// Blocks are appended to existing files, so their offsets start at the current size
+		m_Offset = m_Data.size();
+		
+		if(m_Index.size() == 0)
+		{
+			internal::encode_index_header(m_Buffer);
+			m_Index.write(m_Buffer.data(), m_Buffer.size());
+			m_Index.flush();
+		}
+	}
+	
+	binary_file_target::~binary_file_target()
+	{
+		finish_block();
+	}
+	
+	void binary_file_target::write(const log_entry& entry)
+	{
+		const log_entry* t_entry = &entry;
+		write_batch(entry_span{ &t_entry, 1 });
+	}
+	
+	void binary_file_target::write_batch(entry_span entries)
+	{
+		for(const auto& t_entry : entries)
+		{
+			m_Block.add(t_entry.level(), t_entry.time_point(), t_entry.tag());
+			m_Encoder.encode_record(t_entry);
+			
+			if(m_Encoder.payload_size() >= m_Options.m_BlockSize)
+				finish_block();
+		}
+		
+		if(m_Policy.should_flush(entries))
+		{
+			finish_block();
+			m_Data.flush();
+			m_Index.flush();
+		}
+	}
+	
+	void binary_file_target::flush()
+	{
+		finish_block();
+		
+		// Data first, so that the index never refers to blocks that were lost
+		const bool t_data = m_Data.sync();
+		const bool t_index = m_Index.sync();
+		
+		if(!t_data || !t_index)
+			m_SyncFailures.fetch_add(1, ::std::memory_order_relaxed);
+	}
+	
+	auto binary_file_target::sync_failures() const
+		-> ::std::uint64_t
+	{
+		return m_SyncFailures.load(::std::memory_order_relaxed);
+	}
+	
+	auto binary_file_target::finish_block()
+		-> void
+	{
+		if(m_Block.m_Records == 0)
+			return;
+			
+		m_Buffer.clear();
+		m_Frames.clear();
+		
+		m_Encoder.finish_frame(m_Buffer, m_Frames);
+		m_Data.write(m_Buffer.data(), m_Buffer.size());
+		
+		m_Block.m_Offset = m_Offset;
+		m_Block.m_Length = static_cast<::std::uint32_t>(m_Buffer.size());
+		m_Offset += m_Buffer.size();
+		
+		m_Buffer.clear();
+		internal::encode_index(m_Buffer, m_Block);
+		m_Index.write(m_Buffer.data(), m_Buffer.size());
+		
+		m_Block.clear();
+	}
+}
@@ -0,0 +1,199 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdexcept>
+#include <algorithm>
+
+#include "binary_index.hxx"
+#include "network_protocol.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		namespace
+		{
+			template< typename T >
+			auto append_be(::std::string& p_out, T p_val)
+				-> void
+			{
+				for(::std::size_t t_i = sizeof(T); t_i > 0; --t_i)
+					p_out.push_back(static_cast<char>((p_val >> ((t_i - 1) * 8)) & 0xFF));
+			}
+			
+			// Bounds checked reading from an index record
+			class index_reader
+			{
+				public:
+					index_reader(const char* p_begin, const char* p_end)
+						: m_Cur{p_begin}, m_End{p_end}
+					{
+					}
+					
+				public:
+					auto read_u8()
+						-> ::std::uint8_t
+					{
+						require(1);
+						return static_cast<::std::uint8_t>(*m_Cur++);
+					}
+					
+					template< typename T >
+					auto read_be()
+						-> T
+					{
+						T t_val{ };
+						
+						for(::std::size_t t_i = 0; t_i < sizeof(T); ++t_i)
+							t_val = static_cast<T>((t_val << 8) | read_u8());
+							
+						return t_val;
+					}
+					
+					auto read_varint()
+						-> ::std::uint64_t
+					{
+						::std::uint64_t t_val{0};
+						
+						for(unsigned t_shift = 0; t_shift < 64; t_shift += 7)
+						{
+							const auto t_byte = read_u8();
+							t_val |= static_cast<::std::uint64_t>(t_byte & 0x7F) << t_shift;
+							
+							if((t_byte & 0x80) == 0)
+								return t_val;
+						}
+						
+						throw ::std::runtime_error("binary_index: Malformed varint");
+					}
+					
+					auto read_string()
+						-> ::std::string
+					{
+						const auto t_len = static_cast<::std::size_t>(read_varint());
+						require(t_len);
+						
+						::std::string t_str(m_Cur, t_len);
+						m_Cur += t_len;
+						return t_str;
+					}
+					
+				private:
+					auto require(::std::size_t p_len)
+						-> void
+					{
+						if(static_cast<::std::size_t>(m_End - m_Cur) < p_len)
+							throw ::std::runtime_error("binary_index: Index record is truncated");
+					}
+					
+				private:
+					const char* m_Cur;
+					const char* m_End;
+			};
+		}
+	
+		auto block_index::add(severity_level p_lvl, timestamp p_time, const ::std::string& p_tag)
+			-> void
+		{
+			++m_Records;
+			m_First = ::std::min(m_First, p_time.nanoseconds());
+			m_Last = ::std::max(m_Last, p_time.nanoseconds());
+			m_Levels |= static_cast<::std::uint8_t>(1u << static_cast<unsigned>(p_lvl));
+			
+			// Usually only a handful of tags are in use, so a linear search is sufficient
+			if(m_MoreTags || ::std::find(m_Tags.begin(), m_Tags.end(), p_tag) != m_Tags.end())
+				return;
+				
+			if(m_Tags.size() < max_indexed_tags)
+				m_Tags.push_back(p_tag);
+			else m_MoreTags = true;
+		}
+		
+		auto block_index::clear()
+			-> void
+		{
+			*this = block_index{ };
+		}
+		
+		auto encode_index_header(::std::string& p_out)
+			-> void
+		{
+			p_out.push_back(static_cast<char>(index_magic_0));
+			p_out.push_back(static_cast<char>(index_magic_1));
+			p_out.push_back(static_cast<char>(index_magic_2));
+			p_out.push_back(static_cast<char>(index_magic_3));
+			p_out.push_back(static_cast<char>(index_version));
+		}
+		
+		auto encode_index(::std::string& p_out, const block_index& p_index)
+			-> void
+		{
+			const auto t_begin = p_out.size();
+			append_be<::std::uint32_t>(p_out, 0u);	// Length is filled in below
+			
+			append_be<::std::uint64_t>(p_out, p_index.m_Offset);
+			append_be<::std::uint32_t>(p_out, p_index.m_Length);
+			append_varint(p_out, p_index.m_Records);
+			append_be<::std::uint64_t>(p_out, static_cast<::std::uint64_t>(p_index.m_First));
+			append_be<::std::uint64_t>(p_out, static_cast<::std::uint64_t>(p_index.m_Last));
+			p_out.push_back(static_cast<char>(p_index.m_Levels));
+			p_out.push_back(static_cast<char>(p_index.m_MoreTags ? index_flag_more_tags : 0u));
+			append_varint(p_out, p_index.m_Tags.size());
+			
+			for(const auto& t_tag : p_index.m_Tags)
+			{
+				append_varint(p_out, t_tag.length());
+				p_out.append(t_tag);
+			}
+			
+			const auto t_length = p_out.size() - t_begin - sizeof(::std::uint32_t);
+			
+			for(::std::size_t t_i = 0; t_i < 4; ++t_i)
+				p_out[t_begin + t_i] = static_cast<char>((t_length >> ((3 - t_i) * 8)) & 0xFF);
+		}
+		
+		auto decode_index(const char* p_data, ::std::size_t p_len, block_index& p_index)
+			-> ::std::size_t
+		{
+			if(p_len < sizeof(::std::uint32_t))
+				return 0;
+				
+			index_reader t_header{ p_data, p_data + p_len };
+			const auto t_length = t_header.read_be<::std::uint32_t>();
+			
+			if(p_len - sizeof(::std::uint32_t) < t_length)
+				return 0;
+				
+			// Records might grow new fields at their end, which are skipped
+			index_reader t_reader{ p_data + sizeof(::std::uint32_t), p_data + sizeof(::std::uint32_t) + t_length };
+			
+			p_index.m_Offset = t_reader.read_be<::std::uint64_t>();
+			p_index.m_Length = t_reader.read_be<::std::uint32_t>();
+			p_index.m_Records = t_reader.read_varint();
+			p_index.m_First = static_cast<::std::int64_t>(t_reader.read_be<::std::uint64_t>());
+			p_index.m_Last = static_cast<::std::int64_t>(t_reader.read_be<::std::uint64_t>());
+			p_index.m_Levels = t_reader.read_u8();
+			p_index.m_MoreTags = (t_reader.read_u8() & index_flag_more_tags) != 0;
+			
+			const auto t_count = t_reader.read_varint();
+			p_index.m_Tags.clear();
+			
+			for(::std::uint64_t t_i = 0; t_i < t_count; ++t_i)
+				p_index.m_Tags.push_back(t_reader.read_string());
+				
+			return sizeof(::std::uint32_t) + t_length;
+		}
+	}
+}
@@ -0,0 +1,188 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+
+#include "binary_log_reader.hxx"
+
+namespace lg
+{
+	auto log_query::matches(const decoded_record& p_record) const
+		-> bool
+	{
+		return p_record.m_Level <= m_Level
+			&& p_record.m_Time.nanoseconds() >= m_Since.nanoseconds()
+			&& p_record.m_Time.nanoseconds() <= m_Until.nanoseconds()
+			&& (m_Tags.empty() || ::std::find(m_Tags.begin(), m_Tags.end(), p_record.m_Tag) != m_Tags.end());
+	}
+
+	binary_log_reader::binary_log_reader(const ::std::string& p_path)
+		: m_Data{p_path, ::std::ios_base::in | ::std::ios_base::binary}
+	{
+		if(!m_Data)
+			throw ::std::runtime_error("binary_log_reader: Failed to open \"" + p_path + "\"");
+			
+		m_Data.seekg(0, ::std::ios_base::end);
+		m_Size = static_cast<::std::uint64_t>(m_Data.tellg());
+		
+		load_index(p_path + ".idx");
+	}
+	
+	auto binary_log_reader::load_index(const ::std::string& p_path)
+		-> void
+	{
+		::std::ifstream t_file{p_path, ::std::ios_base::in | ::std::ios_base::binary};
+		
+		if(!t_file)
+			return;
+			
+		const ::std::string t_data{ ::std::istreambuf_iterator<char>{t_file}, ::std::istreambuf_iterator<char>{} };
+		
+		if(t_data.size() < internal::index_header_size)
+			return;
+			
+		if(static_cast<::std::uint8_t>(t_data[0]) != internal::index_magic_0 || static_cast<::std::uint8_t>(t_data[1]) != internal::index_magic_1
+			|| static_cast<::std::uint8_t>(t_data[2]) != internal::index_magic_2 || static_cast<::std::uint8_t>(t_data[3]) != internal::index_magic_3)
+			throw ::std::runtime_error("binary_log_reader: Invalid index magic");
+			
+		if(static_cast<::std::uint8_t>(t_data[4]) != internal::index_version)
+			throw ::std::runtime_error("binary_log_reader: Unsupported index version");
+			
+		// A record that was cut off by a crash is ignored, its block is scanned instead
+		for(::std::size_t t_pos = internal::index_header_size; t_pos < t_data.size(); )
+		{
+			internal::block_index t_block{ };
+			const auto t_used = internal::decode_index(t_data.data() + t_pos, t_data.size() - t_pos, t_block);
+			
+			if(t_used == 0)
+				break;
+				
+			// Blocks the data file does not fully contain were lost
+			if(t_block.m_Offset + t_block.m_Length <= m_Size)
+				m_Blocks.push_back(::std::move(t_block));
+				
+			t_pos += t_used;
+		}
+		
+		::std::stable_sort(m_Blocks.begin(), m_Blocks.end(),
+			[](const internal::block_index& p_a, const internal::block_index& p_b)
+			{
+				return p_a.m_Offset < p_b.m_Offset;
+			}
+		);
+	}
+	
+	auto binary_log_reader::query(const log_query& p_query, const ::std::function<void(const decoded_record&)>& p_fn)
+		-> query_stats
+	{
+		query_stats t_stats{ };
+		t_stats.m_Blocks = m_Blocks.size();
+		
+		// End of the data covered so far. Everything in between two indexed blocks lacks an index record.
+		::std::uint64_t t_pos{0};
+		
+		for(const auto& t_block : m_Blocks)
+		{
+			if(t_block.m_Offset > t_pos)
+			{
+				t_stats.m_Unindexed += t_block.m_Offset - t_pos;
+				scan(t_pos, t_block.m_Offset, p_query, p_fn, t_stats);
+			}
+			
+			if(may_match(t_block, p_query))
+			{
+				++t_stats.m_BlocksRead;
+				scan(t_block.m_Offset, t_block.m_Offset + t_block.m_Length, p_query, p_fn, t_stats);
+			}
+			
+			t_pos = ::std::max(t_pos, t_block.m_Offset + t_block.m_Length);
+		}
+		
+		if(t_pos < m_Size)
+		{
+			t_stats.m_Unindexed += m_Size - t_pos;
+			scan(t_pos, m_Size, p_query, p_fn, t_stats);
+		}
+		
+		return t_stats;
+	}
+	
+	auto binary_log_reader::blocks() const
+		-> const ::std::vector<internal::block_index>&
+	{
+		return m_Blocks;
+	}
+	
+	auto binary_log_reader::may_match(const internal::block_index& p_block, const log_query& p_query) const
+		-> bool
+	{
+		// Bits of the requested level and all more severe ones
+		const auto t_levels = static_cast<::std::uint8_t>((1u << (static_cast<unsigned>(p_query.m_Level) + 1)) - 1);
+		
+		if((p_block.m_Levels & t_levels) == 0)
+			return false;
+			
+		if(p_block.m_Last < p_query.m_Since.nanoseconds() || p_block.m_First > p_query.m_Until.nanoseconds())
+			return false;
+			
+		if(p_query.m_Tags.empty() || p_block.m_MoreTags)
+			return true;
+			
+		return ::std::any_of(p_query.m_Tags.begin(), p_query.m_Tags.end(),
+			[&p_block](const ::std::string& p_tag)
+			{
+				return ::std::find(p_block.m_Tags.begin(), p_block.m_Tags.end(), p_tag) != p_block.m_Tags.end();
+			}
+		);
+	}
+	
+	auto binary_log_reader::scan(::std::uint64_t p_begin, ::std::uint64_t p_end, const log_query& p_query, const ::std::function<void(const decoded_record&)>& p_fn, query_stats& p_stats)
+		-> void
+	{
+		static constexpr ::std::size_t chunk_size = 64u << 10;
+	
+		// A frame that is cut off at the end of the range is ignored
+		protocol_decoder t_decoder{ protocol_version::v2 };
+		decoded_record t_record{ };
+		
+		m_Data.clear();
+		m_Data.seekg(static_cast<::std::streamoff>(p_begin));
+		
+		for(auto t_remaining = p_end - p_begin; t_remaining > 0; )
+		{
+			const auto t_len = static_cast<::std::size_t>(::std::min<::std::uint64_t>(t_remaining, chunk_size));
+			m_Buffer.resize(t_len);
+			
+			if(!m_Data.read(m_Buffer.data(), static_cast<::std::streamsize>(t_len)))
+				throw ::std::runtime_error("binary_log_reader: Failed to read data file");
+				
+			p_stats.m_BytesRead += t_len;
+			t_remaining -= t_len;
+			
+			t_decoder.feed(m_Buffer.data(), t_len);
+			
+			while(t_decoder.next(t_record))
+			{
+				if(p_query.matches(t_record))
+				{
+					++p_stats.m_Matches;
+					p_fn(t_record);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,171 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <chrono>
+#include <algorithm>
+
+#include "block_compressor.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		block_compressor::block_compressor(const ::std::string& p_path, const compressed_file_options& p_options)
+			:	m_Options{p_options},
+				m_File{p_path, true, true}
+		{
+			m_Options.m_Threads = ::std::max<::std::size_t>(m_Options.m_Threads, 1);
+			m_Options.m_MaxPending = ::std::max(m_Options.m_MaxPending, m_Options.m_Threads);
+			
+			for(::std::size_t t_i = 0; t_i < m_Options.m_Threads; ++t_i)
+				m_Workers.emplace_back(&block_compressor::do_work, this);
+		}
+		
+		block_compressor::~block_compressor()
+		{
+			{
+				::std::lock_guard<::std::mutex> t_lock{m_Mtx};
+				m_ShouldStop = true;
+			}
+			
+			m_WorkCv.notify_all();
+			
+			// Compressor threads only stop once the queue is empty
+			for(auto& t_worker : m_Workers)
+				t_worker.join();
+				
+			m_File.flush();
+		}
+		
+		auto block_compressor::submit(::std::string& p_block)
+			-> void
+		{
+			::std::unique_lock<::std::mutex> t_lock{m_Mtx};
+			
+			m_DoneCv.wait(t_lock, [this]() { return m_Pending.size() < m_Options.m_MaxPending; });
+			
+			job_ptr t_job{ };
+			
+			if(!m_Free.empty())
+			{
+				t_job = ::std::move(m_Free.back());
+				m_Free.pop_back();
+			}
+			else
+			{
+				// New buffers start as large as the submitted one, so that the next block does not have to grow
+				t_job.reset(new job{ });
+				t_job->m_Raw.reserve(p_block.capacity());
+			}
+			
+			t_job->m_Raw.swap(p_block);
+			t_job->m_Done = false;
+			p_block.clear();
+			
+			m_Queue.push_back(t_job.get());
+			m_Pending.push_back(::std::move(t_job));
+			
+			t_lock.unlock();
+			m_WorkCv.notify_one();
+		}
+		
+		auto block_compressor::sync()
+			-> bool
+		{
+			::std::unique_lock<::std::mutex> t_lock{m_Mtx};
+			m_DoneCv.wait(t_lock, [this]() { return m_Pending.empty() && !m_Writing; });
+			
+			// The lock keeps compressor threads from writing while the file is synced
+			return m_File.sync();
+		}
+		
+		auto block_compressor::stats() const
+			-> compression_stats
+		{
+			compression_stats t_stats{ };
+			t_stats.m_Blocks = m_Blocks.load(::std::memory_order_relaxed);
+			t_stats.m_RawBytes = m_RawBytes.load(::std::memory_order_relaxed);
+			t_stats.m_CompressedBytes = m_CompressedBytes.load(::std::memory_order_relaxed);
+			t_stats.m_Nanoseconds = m_Nanoseconds.load(::std::memory_order_relaxed);
+			return t_stats;
+		}
+		
+		auto block_compressor::do_work()
+			-> void
+		{
+			::std::unique_lock<::std::mutex> t_lock{m_Mtx};
+			
+			while(true)
+			{
+				m_WorkCv.wait(t_lock, [this]() { return m_ShouldStop || !m_Queue.empty(); });
+				
+				if(m_Queue.empty())
+					return;
+					
+				auto* t_job = m_Queue.front();
+				m_Queue.pop_front();
+				
+				t_lock.unlock();
+				
+				const auto t_begin = ::std::chrono::steady_clock::now();
+				
+				t_job->m_Compressed.clear();
+				lz_frame_compress(t_job->m_Raw.data(), t_job->m_Raw.size(), t_job->m_Compressed, m_Options.m_Level);
+				
+				const auto t_time = ::std::chrono::steady_clock::now() - t_begin;
+				
+				m_Nanoseconds.fetch_add(static_cast<::std::uint64_t>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(t_time).count()), ::std::memory_order_relaxed);
+				
+				t_lock.lock();
+				t_job->m_Done = true;
+				
+				// If another thread is writing, it will pick up this block as well
+				if(!m_Writing)
+					write_ready(t_lock);
+			}
+		}
+		
+		auto block_compressor::write_ready(::std::unique_lock<::std::mutex>& p_lock)
+			-> void
+		{
+			m_Writing = true;
+			
+			while(!m_Pending.empty() && m_Pending.front()->m_Done)
+			{
+				auto t_job = ::std::move(m_Pending.front());
+				m_Pending.pop_front();
+				
+				// The slot is free now, so the producer can continue while this block is written
+				m_DoneCv.notify_all();
+				p_lock.unlock();
+				
+				m_File.write(t_job->m_Compressed.data(), t_job->m_Compressed.size());
+				
+				m_Blocks.fetch_add(1, ::std::memory_order_relaxed);
+				m_RawBytes.fetch_add(t_job->m_Raw.size(), ::std::memory_order_relaxed);
+				m_CompressedBytes.fetch_add(t_job->m_Compressed.size(), ::std::memory_order_relaxed);
+				
+				t_job->m_Raw.clear();
+				t_job->m_Compressed.clear();
+				
+				p_lock.lock();
+				m_Free.push_back(::std::move(t_job));
+			}
+			
+			m_Writing = false;
+			m_DoneCv.notify_all();
+		}
+	}
+}
@@ -0,0 +1,132 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "channel.hxx"
+
+namespace lg
+{
+	channel::channel()
+		: m_Logger{ &logger::instance() }
+	{
+	}
+	
+	channel::channel(logger& p_logger)
+		: m_Logger{ &p_logger }
+	{
+	}
+	
+	auto channel::get(const ::std::string& p_name, const channel_options& p_options)
+		-> channel
+	{
+		return channel{ logger::channel_instance(p_name, p_options) };
+	}
+	
+	auto channel::add_target(ut::observer_ptr<log_target> p_target, const ::std::string& p_lane, const lane_options& p_options) const
+		-> void
+	{
+		m_Logger->_add_target(p_target, p_lane, p_options);
+	}
+	
+	auto channel::remove_target(ut::observer_ptr<log_target> p_target) const
+		-> bool
+	{
+		return m_Logger->_remove_target(p_target);
+	}
+	
+	auto channel::replace_target(ut::observer_ptr<log_target> p_old, ut::observer_ptr<log_target> p_new) const
+		-> bool
+	{
+		return m_Logger->_replace_target(p_old, p_new);
+	}
+	
+	auto channel::set_threshold(severity_level p_lvl) const
+		-> void
+	{
+		m_Logger->_set_threshold(p_lvl);
+	}
+	
+	auto channel::threshold() const
+		-> severity_level
+	{
+		return static_cast<severity_level>(m_Logger->m_Threshold.load());
+	}
+	
+	auto channel::use_ring_buffers(::std::size_t p_capacity, overflow_policy p_policy) const
+		-> void
+	{
+		m_Logger->_use_ring_buffers(p_capacity, p_policy);
+	}
+	
+	auto channel::set_wakeup(const wakeup_options& p_options) const
+		-> void
+	{
+		m_Logger->_set_wakeup(p_options);
+	}
+	
+	auto channel::deduplicate(bool p_enable) const
+		-> void
+	{
+		m_Logger->m_Dedup.store(p_enable, ::std::memory_order_relaxed);
+	}
+	
+	auto channel::flush(::std::chrono::milliseconds p_timeout) const
+		-> bool
+	{
+		return m_Logger->_flush(p_timeout);
+	}
+	
+	auto channel::use_sync_delivery(severity_level p_lvl, ::std::chrono::milliseconds p_timeout) const
+		-> void
+	{
+		m_Logger->_use_sync_delivery(p_lvl, p_timeout);
+	}
+	
+	auto channel::use_async_delivery() const
+		-> void
+	{
+		m_Logger->m_SyncLevel.store(-1, ::std::memory_order_relaxed);
+	}
+	
+	auto channel::self_report(::std::chrono::milliseconds p_interval) const
+		-> void
+	{
+		m_Logger->_self_report(p_interval);
+	}
+	
+	auto channel::lanes() const
+		-> ::std::vector<lane_info>
+	{
+		return m_Logger->_lanes();
+	}
+	
+	auto channel::stats() const
+		-> logger_stats
+	{
+		return m_Logger->_stats();
+	}
+	
+	auto channel::shutdown() const
+		-> void
+	{
+		if(!m_Logger->m_IsShutdown)
+			m_Logger->kill_thread();
+	}
+	
+	auto channel::name() const
+		-> const ::std::string&
+	{
+		return m_Logger->m_Name;
+	}
+}
@@ -71,9 +71,13 @@ namespace lg
 				
 			update_width(entry);
 		}
-		str	<< entry.message()
-			<< "\n";
-			
-		str.flush();
+		const auto t_msg = entry.message_view();
+		str.write(t_msg.data(), t_msg.length());
+		
+		// Structured fields are appended as "key=value"
+		for(const auto& t_field : entry.fields())
+			str << ' ' << t_field;
+		
+		str << "\n";
 	}
 }
@@ -0,0 +1,102 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <utility>
+#include <string>
+
+#include "dedup_filter.hxx"
+#include "tag.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		constexpr ::std::chrono::seconds dedup_filter::max_run_age;
+
+		auto dedup_filter::apply(queue_type& p_queue)
+			-> void
+		{
+			m_Output.clear();
+
+			for(auto& t_entry : p_queue)
+			{
+				if(is_repetition(t_entry))
+				{
+					if(m_Repeats++ == 0)
+						m_RunBegin = clock_type::now();
+
+					m_Removed.fetch_add(1, ::std::memory_order_relaxed);
+					continue;
+				}
+
+				if(m_Repeats > 0)
+					m_Output.push_back(summary());
+
+				remember(t_entry);
+				m_Output.push_back(::std::move(t_entry));
+			}
+
+			p_queue.swap(m_Output);
+			m_Output.clear();
+
+			flush(p_queue, false);
+		}
+
+		auto dedup_filter::flush(queue_type& p_queue, bool p_force)
+			-> void
+		{
+			if(m_Repeats > 0 && (p_force || clock_type::now() - m_RunBegin >= max_run_age))
+				p_queue.push_back(summary());
+		}
+
+		auto dedup_filter::is_repetition(const log_entry& p_entry) const
+			-> bool
+		{
+			if(&p_entry.site() != m_Site || p_entry.level() != m_Level)
+				return false;
+
+			const auto t_msg = p_entry.message_view();
+			const auto t_fields = p_entry.fields().bytes();
+
+			return p_entry.tag_index() == m_Tag
+				&& m_Message.compare(0, m_Message.length(), t_msg.data(), t_msg.length()) == 0
+				&& m_Fields.compare(0, m_Fields.length(), t_fields.data(), t_fields.length()) == 0;
+		}
+
+		auto dedup_filter::remember(const log_entry& p_entry)
+			-> void
+		{
+			const auto t_msg = p_entry.message_view();
+			const auto t_fields = p_entry.fields().bytes();
+
+			m_Site = &p_entry.site();
+			m_Level = p_entry.level();
+			m_Tag = p_entry.tag_index();
+			m_Message.assign(t_msg.data(), t_msg.length());
+			m_Fields.assign(t_fields.data(), t_fields.length());
+		}
+
+		auto dedup_filter::summary()
+			-> log_entry
+		{
+			log_entry t_entry{ m_Site };
+
+			::std::move(t_entry) << m_Level << tag_t{ m_Tag } << "Last message repeated " << m_Repeats << " times";
+
+			m_Repeats = 0;
+			return t_entry;
+		}
+	}
+}
@@ -30,10 +30,20 @@ namespace lg
 		}
 		else
 		{
+			// Sub-second precision is not cached by the entry
+			char t_buffer[time_buffer_size];
+			const char* t_time = entry.time_string();
+			
+			if(m_Precision != time_precision::seconds)
+			{
+				format_time(entry.time_point(), m_Precision, t_buffer);
+				t_time = t_buffer;
+			}
+		
 			str << "["
 				<< std::setw(8)
 				<< std::right
-				<< entry.time_string()
+				<< t_time
 				<< "] "
 				<< ut::foreground(entry.color())
 				<< std::setw(7)
@@ -41,9 +51,13 @@ namespace lg
 				<< entry.level_string() << ut::reset_color
 				<< "| ";
 		}
-		str	<< entry.message()
-			<< "\n";
-			
-		str.flush();
+		const auto t_msg = entry.message_view();
+		str.write(t_msg.data(), t_msg.length());
+		
+		// Structured fields are appended as "key=value"
+		for(const auto& t_field : entry.fields())
+			str << ' ' << t_field;
+		
+		str << "\n";
 	}
 }
\ No newline at end of file
@@ -0,0 +1,497 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <iterator>
+#include <algorithm>
+
+#include "dispatch_lane.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		auto flush_barrier::expect(::std::size_t p_lanes)
+			-> void
+		{
+			{
+				::std::lock_guard<::std::mutex> lck(m_Mtx);
+				m_Remaining += p_lanes;
+				m_Published = true;
+			}
+			
+			m_Cv.notify_all();
+		}
+		
+		auto flush_barrier::arrive()
+			-> void
+		{
+			{
+				::std::lock_guard<::std::mutex> lck(m_Mtx);
+				--m_Remaining;
+			}
+			
+			m_Cv.notify_all();
+		}
+		
+		auto flush_barrier::wait_for(::std::chrono::nanoseconds p_timeout)
+			-> bool
+		{
+			::std::unique_lock<::std::mutex> lck(m_Mtx);
+			
+			return m_Cv.wait_for(lck, p_timeout, [this](){ return m_Published && m_Remaining == 0; });
+		}
+	
+		constexpr ::std::size_t batch_pool::max_batches;
+		constexpr ::std::size_t batch_pool::max_capacity;
+	
+		auto batch_pool::acquire()
+			-> ::std::unique_ptr<entry_batch>
+		{
+			{
+				::std::lock_guard<::std::mutex> lck(m_Mtx);
+				
+				if(!m_Free.empty())
+				{
+					auto t_batch = ::std::move(m_Free.back());
+					m_Free.pop_back();
+					return t_batch;
+				}
+			}
+			
+			return ::std::make_unique<entry_batch>();
+		}
+		
+		auto batch_pool::share(::std::unique_ptr<entry_batch> p_batch)
+			-> batch_ptr
+		{
+			{
+				::std::lock_guard<::std::mutex> lck(m_Mtx);
+				++m_Shared;
+			}
+		
+			return batch_ptr{ p_batch.release(), [this](const entry_batch* p_ptr)
+				{
+					release(const_cast<entry_batch*>(p_ptr));
+				}
+			};
+		}
+		
+		auto batch_pool::release(entry_batch* p_batch)
+			-> void
+		{
+			::std::unique_ptr<entry_batch> t_batch{ p_batch };
+			
+			// Entries are destroyed outside of the lock. This also releases their arena blocks.
+			t_batch->m_Entries.clear();
+			t_batch->m_Pointers.clear();
+			t_batch->m_Barriers.clear();
+			
+			{
+				::std::lock_guard<::std::mutex> lck(m_Mtx);
+				
+				--m_Shared;
+				
+				if(m_Free.size() < max_batches && t_batch->m_Entries.capacity() <= max_capacity)
+					m_Free.push_back(::std::move(t_batch));
+			}
+			
+			m_ReleaseCv.notify_all();
+		}
+		
+		auto batch_pool::wait_released()
+			-> void
+		{
+			::std::unique_lock<::std::mutex> lck(m_Mtx);
+			m_ReleaseCv.wait(lck, [this](){ return m_Shared == 0; });
+		}
+	
+		dispatch_lane::dispatch_lane(const ::std::string& p_name, const lane_options& p_options)
+			: m_Name{p_name}, m_Options{p_options}, m_Worker{ &dispatch_lane::do_work, this }
+		{
+		}
+		
+		dispatch_lane::~dispatch_lane()
+		{
+			close();
+		}
+		
+		auto dispatch_lane::reserve_target()
+			-> void
+		{
+			::std::lock_guard<::std::mutex> lck(m_Mtx);
+			++m_TargetCount;
+		}
+		
+		auto dispatch_lane::add_target(ut::observer_ptr<log_target> p_target, ::std::uint64_t p_owner)
+			-> void
+		{
+			m_Targets.update([p_target, p_owner](container_type& p_targets)
+			{
+				p_targets.push_back(target_slot{ p_target, p_owner, ::std::make_shared<target_counters>() });
+				return true;
+			});
+		}
+		
+		auto dispatch_lane::remove_target(ut::observer_ptr<log_target> p_target, ::std::uint64_t p_owner)
+			-> bool
+		{
+			const auto t_removed = m_Targets.update([p_target, p_owner](container_type& p_targets)
+			{
+				const auto t_it = ::std::find_if(p_targets.begin(), p_targets.end(), [p_target, p_owner](const target_slot& p_slot)
+				{
+					return p_slot.m_Target == p_target && p_slot.m_Owner == p_owner;
+				});
+				
+				if(t_it == p_targets.end())
+					return false;
+					
+				p_targets.erase(t_it);
+				return true;
+			});
+			
+			if(!t_removed)
+				return false;
+				
+			{
+				::std::lock_guard<::std::mutex> lck(m_Mtx);
+				--m_TargetCount;
+			}
+			
+			m_Targets.synchronize();
+			return true;
+		}
+		
+		auto dispatch_lane::replace_target(ut::observer_ptr<log_target> p_old, ut::observer_ptr<log_target> p_new, ::std::uint64_t p_owner)
+			-> bool
+		{
+			const auto t_replaced = m_Targets.update([p_old, p_new, p_owner](container_type& p_targets)
+			{
+				for(auto& t_slot : p_targets)
+				{
+					if(t_slot.m_Target == p_old && t_slot.m_Owner == p_owner)
+					{
+						t_slot.m_Target = p_new;
+						return true;
+					}
+				}
+				
+				return false;
+			});
+			
+			if(t_replaced)
+				m_Targets.synchronize();
+				
+			return t_replaced;
+		}
+		
+		auto dispatch_lane::max_level(::std::uint64_t p_owner) const
+			-> int
+		{
+			return m_Targets.read([p_owner](const container_type& p_targets)
+			{
+				int t_level{-1};
+				
+				for(const auto& t_slot : p_targets)
+				{
+					if(t_slot.m_Owner == p_owner)
+						t_level = ::std::max(t_level, static_cast<int>(t_slot.m_Target->level()));
+				}
+				
+				return t_level;
+			});
+		}
+		
+		auto dispatch_lane::publish(const batch_ptr& p_batch)
+			-> void
+		{
+			const auto t_size = p_batch->m_Pointers.size();
+			const bool t_barrier = !p_batch->m_Barriers.empty();
+			
+			{
+				::std::unique_lock<::std::mutex> lck(m_Mtx);
+				
+				// A batch is always accepted if nothing else is waiting, even if it exceeds the limit
+				const auto t_fits = [this, t_size]()
+				{
+					return m_Options.m_MaxBacklog == 0 || m_Backlog == 0 || m_Backlog + t_size <= m_Options.m_MaxBacklog;
+				};
+				
+				if(!t_fits())
+				{
+					switch(m_Options.m_Policy)
+					{
+						case overflow_policy::block:
+							m_SpaceCv.wait(lck, [this, &t_fits](){ return t_fits() || m_Closed; });
+							break;
+							
+						case overflow_policy::drop_oldest:
+							// Flush requests have to be completed by the lane, so eviction stops at them
+							while(!t_fits() && !m_Pending.empty() && m_Pending.front()->m_Barriers.empty())
+							{
+								const auto t_dropped = m_Pending.front()->m_Pointers.size();
+								m_Backlog -= t_dropped;
+								m_Dropped += t_dropped;
+								m_Pending.pop_front();
+							}
+							break;
+							
+						default:
+							break;
+					}
+					
+					if((!t_fits() && !t_barrier) || m_Closed)
+					{
+						m_Dropped += t_size;
+						
+						// Nothing is written anymore, so there is nothing left to wait for
+						for(const auto& t_request : p_batch->m_Barriers)
+							t_request->arrive();
+						
+						return;
+					}
+				}
+				
+				m_Pending.push_back(p_batch);
+				m_Backlog += t_size;
+			}
+			
+			m_WorkCv.notify_one();
+		}
+		
+		auto dispatch_lane::close()
+			-> void
+		{
+			{
+				::std::lock_guard<::std::mutex> lck(m_Mtx);
+				m_Closed = true;
+			}
+			
+			m_WorkCv.notify_one();
+			m_SpaceCv.notify_all();
+			
+			if(m_Worker.joinable())
+				m_Worker.join();
+		}
+		
+		auto dispatch_lane::info() const
+			-> lane_info
+		{
+			::std::lock_guard<::std::mutex> lck(m_Mtx);
+			
+			// The oldest entry not yet written is the first one of the current or next batch
+			auto t_oldest = m_Current;
+			
+			if(!t_oldest && !m_Pending.empty())
+				t_oldest = m_Pending.front();
+			
+			::std::chrono::nanoseconds t_lag{0};
+			
+			if(t_oldest && !t_oldest->m_Pointers.empty())
+				t_lag = ::std::chrono::nanoseconds{ timestamp::now().nanoseconds() - t_oldest->m_Pointers.front()->time_point().nanoseconds() };
+		
+			return lane_info{
+				m_Name,
+				m_TargetCount,
+				m_Backlog,
+				m_Dispatched,
+				m_Dropped,
+				t_lag
+			};
+		}
+		
+		auto dispatch_lane::collect_stats(::std::vector<target_stats>& p_stats, ::std::uint64_t p_owner) const
+			-> void
+		{
+			// The lane thread updates the counters without any lock
+			m_Targets.read([this, &p_stats, p_owner](const container_type& p_targets)
+			{
+				for(::std::size_t t_i = 0; t_i < p_targets.size(); ++t_i)
+				{
+					if(p_targets[t_i].m_Owner != p_owner)
+						continue;
+				
+					const auto& t_counters = *p_targets[t_i].m_Counters;
+					
+					p_stats.push_back(target_stats{
+						m_Name,
+						t_i,
+						t_counters.m_Writes.load(::std::memory_order_relaxed),
+						t_counters.m_Entries.load(::std::memory_order_relaxed),
+						t_counters.m_Bytes.load(::std::memory_order_relaxed),
+						::std::chrono::nanoseconds{ t_counters.m_Nanoseconds.load(::std::memory_order_relaxed) }
+					});
+				}
+			});
+		}
+		
+		auto dispatch_lane::name() const
+			-> const ::std::string&
+		{
+			return m_Name;
+		}
+		
+		auto dispatch_lane::options() const
+			-> const lane_options&
+		{
+			return m_Options;
+		}
+		
+		auto dispatch_lane::target_count() const
+			-> ::std::size_t
+		{
+			::std::lock_guard<::std::mutex> lck(m_Mtx);
+			return m_TargetCount;
+		}
+		
+		auto dispatch_lane::do_work()
+			-> void
+		{
+			while(true)
+			{
+				{
+					::std::unique_lock<::std::mutex> lck(m_Mtx);
+					
+					m_WorkCv.wait(lck, [this](){ return !m_Pending.empty() || m_Closed; });
+					
+					// Only stop once everything was written
+					if(m_Pending.empty())
+						break;
+						
+					m_Current = ::std::move(m_Pending.front());
+					m_Pending.pop_front();
+				}
+				
+				{
+					const auto& t_targets = m_Targets.acquire();
+					
+					for(const auto& t_slot : t_targets)
+					{
+						if(t_slot.m_Owner == m_Current->m_Owner)
+							dispatch(*t_slot.m_Target, *t_slot.m_Counters, m_Current->m_Pointers);
+					}
+					
+					// Entries written before a flush request have to reach the devices of all
+					// targets of the requesting logger, even if they did not receive any of this batch
+					if(!m_Current->m_Barriers.empty())
+					{
+						for(const auto& t_slot : t_targets)
+						{
+							if(t_slot.m_Owner == m_Current->m_Owner)
+								t_slot.m_Target->flush();
+						}
+					}
+					
+					m_Targets.release();
+				}
+				
+				for(const auto& t_request : m_Current->m_Barriers)
+					t_request->arrive();
+				
+				{
+					::std::lock_guard<::std::mutex> lck(m_Mtx);
+					
+					const auto t_size = m_Current->m_Pointers.size();
+					m_Backlog -= t_size;
+					m_Dispatched += t_size;
+					
+					// This lane is done with the batch. It is freed once all lanes are.
+					m_Current.reset();
+				}
+				
+				m_SpaceCv.notify_all();
+			}
+		}
+		
+		auto dispatch_lane::dispatch(log_target& p_target, target_counters& p_counters, const batch_type& p_batch)
+			-> void
+		{
+			// Time a single write and account for it. The lane thread is the only writer,
+			// so none of these additions are contended.
+			const auto t_write = [&p_target, &p_counters](const batch_type& p_entries)
+			{
+				::std::uint64_t t_bytes{0};
+				
+				for(const auto* t_entry : p_entries)
+					t_bytes += t_entry->message_view().size();
+			
+				const auto t_begin = ::std::chrono::steady_clock::now();
+				p_target.write_batch(entry_span{ p_entries.data(), p_entries.size() });
+				const auto t_time = ::std::chrono::steady_clock::now() - t_begin;
+				
+				p_counters.m_Writes.fetch_add(1, ::std::memory_order_relaxed);
+				p_counters.m_Entries.fetch_add(p_entries.size(), ::std::memory_order_relaxed);
+				p_counters.m_Bytes.fetch_add(t_bytes, ::std::memory_order_relaxed);
+				p_counters.m_Nanoseconds.fetch_add(::std::chrono::duration_cast<::std::chrono::nanoseconds>(t_time).count(), ::std::memory_order_relaxed);
+			};
+		
+			const auto t_excluded = [&p_target](const log_entry* p_entry)
+			{
+				// Log only if verbosity level does not exclude entry level
+				return p_target.level() < p_entry->level();
+			};
+		
+			// Usually, either all or none of the entries pass the threshold. In both cases
+			// the batch does not have to be copied.
+			if(::std::none_of(p_batch.begin(), p_batch.end(), t_excluded))
+				t_write(p_batch);
+			else
+			{
+				m_Filtered.clear();
+				
+				::std::remove_copy_if(p_batch.begin(), p_batch.end(), ::std::back_inserter(m_Filtered), t_excluded);
+				
+				if(!m_Filtered.empty())
+					t_write(m_Filtered);
+			}
+		}
+	}
+	
+	auto dispatch_pool::lane(const ::std::string& p_name, const lane_options& p_options)
+		-> internal::dispatch_lane&
+	{
+		::std::lock_guard<::std::mutex> lck(m_Mtx);
+		
+		const auto t_it = ::std::find_if(m_Lanes.begin(), m_Lanes.end(),
+			[&p_name, &p_options](const pooled_lane& p_lane)
+			{
+				if(!p_name.empty())
+					return !p_lane.m_Anonymous && p_lane.m_Lane->name() == p_name;
+					
+				// Idle anonymous lanes are left behind by removed targets
+				const auto& t_options = p_lane.m_Lane->options();
+				
+				return p_lane.m_Anonymous
+					&& t_options.m_MaxBacklog == p_options.m_MaxBacklog
+					&& t_options.m_Policy == p_options.m_Policy
+					&& p_lane.m_Lane->target_count() == 0;
+			}
+		);
+		
+		// Reserving the target while still holding the lock keeps concurrent
+		// callers from picking the same idle anonymous lane
+		if(t_it != m_Lanes.end())
+		{
+			t_it->m_Lane->reserve_target();
+			return *t_it->m_Lane;
+		}
+			
+		// Anonymous lanes are named after their index
+		const auto t_name = p_name.empty() ? ("#" + ::std::to_string(m_Lanes.size())) : p_name;
+		
+		m_Lanes.push_back(pooled_lane{ ::std::make_unique<internal::dispatch_lane>(t_name, p_options), p_name.empty() });
+		m_Lanes.back().m_Lane->reserve_target();
+		return *m_Lanes.back().m_Lane;
+	}
+}
@@ -0,0 +1,119 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "doorbell.hxx"
+
+#if defined(__linux__)
+#	include <ctime>
+#	include <climits>
+#	include <unistd.h>
+#	include <sys/syscall.h>
+#	include <linux/futex.h>
+#endif
+
+namespace lg
+{
+	namespace internal
+	{
+		constexpr ::std::uint32_t doorbell::awake;
+		
+#if defined(__linux__)
+		namespace
+		{
+			// The futex word has to be a plain 32 bit integer, which std::atomic<std::uint32_t>
+			// is laid out as on all supported platforms
+			auto futex_word(::std::atomic<::std::uint32_t>& p_atomic)
+				-> ::std::uint32_t*
+			{
+				static_assert(sizeof(::std::atomic<::std::uint32_t>) == sizeof(::std::uint32_t), "Atomic can not be used as futex word");
+				return reinterpret_cast<::std::uint32_t*>(&p_atomic);
+			}
+		}
+#endif
+
+		auto doorbell::prepare_park(::std::uint32_t p_state)
+			-> ::std::uint32_t
+		{
+			const auto t_ticket = m_Epoch.load();
+			
+			// Pairs with the fence of the producers
+			m_State.store(p_state);
+			::std::atomic_thread_fence(::std::memory_order_seq_cst);
+			
+			return t_ticket;
+		}
+		
+		auto doorbell::park(::std::uint32_t p_ticket, ::std::chrono::nanoseconds p_timeout)
+			-> void
+		{
+			using clock_type = ::std::chrono::steady_clock;
+			
+			const bool t_timed = p_timeout.count() > 0;
+			const auto t_deadline = clock_type::now() + p_timeout;
+		
+#if defined(__linux__)
+			// Spurious wakeups are possible, so wait until the epoch actually changed
+			while(m_Epoch.load() == p_ticket)
+			{
+				::timespec t_spec{ };
+				::timespec* t_specPtr{ nullptr };
+				
+				if(t_timed)
+				{
+					const auto t_left = t_deadline - clock_type::now();
+					
+					if(t_left <= clock_type::duration::zero())
+						break;
+						
+					const auto t_ns = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(t_left).count();
+					t_spec.tv_sec = static_cast<::time_t>(t_ns / 1000000000);
+					t_spec.tv_nsec = static_cast<long>(t_ns % 1000000000);
+					t_specPtr = &t_spec;
+				}
+				
+				::syscall(SYS_futex, futex_word(m_Epoch), FUTEX_WAIT_PRIVATE, p_ticket, t_specPtr, nullptr, 0);
+			}
+#else
+			{
+				::std::unique_lock<::std::mutex> lck(m_Mtx);
+				
+				const auto t_rung = [this, p_ticket](){ return m_Epoch.load() != p_ticket; };
+				
+				if(t_timed)
+					m_Cv.wait_until(lck, t_deadline, t_rung);
+				else m_Cv.wait(lck, t_rung);
+			}
+#endif
+			
+			m_State.store(awake, ::std::memory_order_relaxed);
+		}
+		
+		auto doorbell::wake()
+			-> void
+		{
+#if defined(__linux__)
+			m_Epoch.fetch_add(1);
+			::syscall(SYS_futex, futex_word(m_Epoch), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+			{
+				::std::lock_guard<::std::mutex> lck(m_Mtx);
+				m_Epoch.fetch_add(1);
+			}
+			
+			m_Cv.notify_one();
+#endif
+		}
+	}
+}
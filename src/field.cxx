@@ -0,0 +1,250 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+
+#include "field.hxx"
+
+namespace lg
+{
+	auto operator<<(::std::ostream& p_str, const field& p_field)
+		-> ::std::ostream&
+	{
+		const auto t_key = p_field.key();
+		p_str.write(t_key.data(), t_key.length());
+		p_str << '=';
+
+		switch(p_field.type())
+		{
+			case field_type::boolean:
+				p_str << (p_field.as_bool() ? "true" : "false");
+				break;
+
+			case field_type::signed_integer:
+				p_str << p_field.as_signed();
+				break;
+
+			case field_type::unsigned_integer:
+				p_str << p_field.as_unsigned();
+				break;
+
+			case field_type::floating_point:
+				p_str << p_field.as_double();
+				break;
+
+			case field_type::string:
+			{
+				const auto t_val = p_field.as_string();
+				p_str.write(t_val.data(), t_val.length());
+				break;
+			}
+		}
+
+		return p_str;
+	}
+
+	namespace internal
+	{
+		namespace
+		{
+			auto value_size(field_type p_type, const char* p_value)
+				-> ::std::size_t
+			{
+				switch(p_type)
+				{
+					case field_type::boolean:
+						return 1;
+
+					case field_type::string:
+					{
+						::std::uint32_t t_len;
+						::std::memcpy(&t_len, p_value, sizeof(t_len));
+						return sizeof(t_len) + t_len;
+					}
+
+					default:
+						return sizeof(::std::uint64_t);
+				}
+			}
+		}
+
+		auto field_record::const_iterator::operator*() const
+			-> field
+		{
+			const auto t_type = static_cast<field_type>(m_Pos[0]);
+			const auto t_keyLen = static_cast<::std::uint8_t>(m_Pos[1]);
+			const char* t_value = m_Pos + 2 + t_keyLen;
+
+			const ut::string_view t_key{ m_Pos + 2, t_keyLen };
+
+			switch(t_type)
+			{
+				case field_type::boolean:
+					return field{ t_key, t_type, t_value[0] != 0 ? 1u : 0u, ut::string_view{ } };
+
+				case field_type::string:
+				{
+					::std::uint32_t t_len;
+					::std::memcpy(&t_len, t_value, sizeof(t_len));
+					return field{ t_key, t_type, 0, ut::string_view{ t_value + sizeof(t_len), t_len } };
+				}
+
+				default:
+				{
+					::std::uint64_t t_bits;
+					::std::memcpy(&t_bits, t_value, sizeof(t_bits));
+					return field{ t_key, t_type, t_bits, ut::string_view{ } };
+				}
+			}
+		}
+
+		auto field_record::const_iterator::operator++()
+			-> const_iterator&
+		{
+			const auto t_keyLen = static_cast<::std::uint8_t>(m_Pos[1]);
+			const char* t_value = m_Pos + 2 + t_keyLen;
+
+			m_Pos = t_value + value_size(static_cast<field_type>(m_Pos[0]), t_value);
+			return *this;
+		}
+
+		field_record::field_record(field_record&& p_other)
+			:	m_Size{p_other.m_Size},
+				m_Capacity{p_other.m_Capacity},
+				m_Count{p_other.m_Count},
+				m_Heap{p_other.m_Heap}
+		{
+			if(!m_Heap.m_Data)
+				::std::memcpy(m_Inline, p_other.m_Inline, m_Size);
+
+			p_other.m_Size = 0;
+			p_other.m_Count = 0;
+			p_other.m_Capacity = LIBLOG_INLINE_FIELD_SIZE;
+			p_other.m_Heap = arena_block{ };
+		}
+
+		field_record& field_record::operator=(field_record&& p_other)
+		{
+			if(this != &p_other)
+			{
+				release();
+
+				m_Size = p_other.m_Size;
+				m_Capacity = p_other.m_Capacity;
+				m_Count = p_other.m_Count;
+				m_Heap = p_other.m_Heap;
+
+				if(!m_Heap.m_Data)
+					::std::memcpy(m_Inline, p_other.m_Inline, m_Size);
+
+				p_other.m_Size = 0;
+				p_other.m_Count = 0;
+				p_other.m_Capacity = LIBLOG_INLINE_FIELD_SIZE;
+				p_other.m_Heap = arena_block{ };
+			}
+
+			return *this;
+		}
+
+		field_record::~field_record()
+		{
+			release();
+		}
+
+		auto field_record::append(const kv_t& p_field)
+			-> void
+		{
+			const auto t_keyLen = ::std::min<::std::size_t>(::std::char_traits<char>::length(p_field.m_Key), 0xFF);
+
+			::std::size_t t_valueSize{ };
+
+			switch(p_field.m_Type)
+			{
+				case field_type::boolean:
+					t_valueSize = 1;
+					break;
+
+				case field_type::string:
+					t_valueSize = sizeof(::std::uint32_t) + p_field.m_Length;
+					break;
+
+				default:
+					t_valueSize = sizeof(::std::uint64_t);
+					break;
+			}
+
+			auto* t_out = reserve(2 + t_keyLen + t_valueSize);
+
+			*t_out++ = static_cast<char>(p_field.m_Type);
+			*t_out++ = static_cast<char>(t_keyLen);
+			::std::memcpy(t_out, p_field.m_Key, t_keyLen);
+			t_out += t_keyLen;
+
+			switch(p_field.m_Type)
+			{
+				case field_type::boolean:
+					*t_out = static_cast<char>(p_field.m_Bits != 0 ? 1 : 0);
+					break;
+
+				case field_type::string:
+				{
+					const auto t_len = static_cast<::std::uint32_t>(p_field.m_Length);
+					::std::memcpy(t_out, &t_len, sizeof(t_len));
+					::std::memcpy(t_out + sizeof(t_len), p_field.m_String, p_field.m_Length);
+					break;
+				}
+
+				default:
+					::std::memcpy(t_out, &p_field.m_Bits, sizeof(p_field.m_Bits));
+					break;
+			}
+
+			++m_Count;
+		}
+
+		auto field_record::reserve(::std::size_t p_required)
+			-> char*
+		{
+			const auto t_size = m_Size + p_required;
+
+			if(t_size > m_Capacity)
+			{
+				const auto t_capacity = ::std::max<::std::size_t>(t_size, m_Capacity * 2);
+				const auto t_heap = arena_allocate(t_capacity);
+
+				::std::memcpy(t_heap.m_Data, data(), m_Size);
+
+				release();
+				m_Heap = t_heap;
+				m_Capacity = static_cast<::std::uint32_t>(t_capacity);
+			}
+
+			auto* t_out = (m_Heap.m_Data ? m_Heap.m_Data : m_Inline) + m_Size;
+			m_Size = static_cast<::std::uint32_t>(t_size);
+
+			return t_out;
+		}
+
+		auto field_record::release()
+			-> void
+		{
+			if(m_Heap.m_Data)
+			{
+				arena_release(m_Heap);
+				m_Heap = arena_block{ };
+			}
+		}
+	}
+}
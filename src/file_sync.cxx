@@ -0,0 +1,102 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cerrno>
+
+#include "file_sync.hxx"
+
+#if defined(_WIN32)
+#	include <io.h>
+#else
+#	include <sys/types.h>
+#	include <unistd.h>
+#endif
+
+namespace lg
+{
+	namespace internal
+	{
+		output_file::output_file(const ::std::string& p_path, bool p_append, bool p_binary)
+		{
+			const char* t_mode = p_append ? (p_binary ? "ab" : "a") : (p_binary ? "wb" : "w");
+			m_File = ::std::fopen(p_path.c_str(), t_mode);
+		}
+		
+		output_file::~output_file()
+		{
+			if(m_File != nullptr)
+				::std::fclose(m_File);
+		}
+		
+		auto output_file::write(const char* p_data, ::std::size_t p_len)
+			-> void
+		{
+			// Failures are sticky and reported by the next sync
+			if(m_File != nullptr && p_len > 0)
+				::std::fwrite(p_data, 1, p_len, m_File);
+		}
+		
+		auto output_file::flush()
+			-> bool
+		{
+			return m_File != nullptr && ::std::fflush(m_File) == 0;
+		}
+		
+		auto output_file::sync()
+			-> bool
+		{
+			if(m_File == nullptr)
+				return false;
+				
+			bool t_success = flush() && !::std::ferror(m_File);
+			::std::clearerr(m_File);
+			
+#if defined(_WIN32)
+			t_success = ::_commit(::_fileno(m_File)) == 0 && t_success;
+#else
+			int t_result{ };
+			
+			do
+				t_result = ::fsync(::fileno(m_File));
+			while(t_result != 0 && errno == EINTR);
+			
+			t_success = t_result == 0 && t_success;
+#endif
+			return t_success;
+		}
+		
+		auto output_file::size()
+			-> ::std::uint64_t
+		{
+			if(m_File == nullptr)
+				return 0;
+				
+#if defined(_WIN32)
+			::_fseeki64(m_File, 0, SEEK_END);
+			const auto t_size = ::_ftelli64(m_File);
+#else
+			::fseeko(m_File, 0, SEEK_END);
+			const auto t_size = ::ftello(m_File);
+#endif
+			return t_size > 0 ? static_cast<::std::uint64_t>(t_size) : 0;
+		}
+		
+		auto output_file::is_open() const
+			-> bool
+		{
+			return m_File != nullptr;
+		}
+	}
+}
@@ -0,0 +1,414 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#if !defined(_WIN32)
+
+#include <new>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <csignal>
+#include <algorithm>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ut/cast.hxx>
+
+#include "flight_recorder_target.hxx"
+
+namespace lg
+{
+	namespace
+	{
+		// Recorder dumped by the crash handler
+		::std::atomic<const flight_recorder_target*> g_Recorder{nullptr};
+		::std::atomic_bool g_HandlerInstalled{false};
+
+		const int g_Signals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+		struct sigaction g_Previous[sizeof(g_Signals) / sizeof(g_Signals[0])];
+
+		extern "C" void crash_handler(int p_signal)
+		{
+			const auto t_errno = errno;
+
+			// Only the first crashing thread dumps
+			if(const auto* t_recorder = g_Recorder.exchange(nullptr))
+				t_recorder->dump();
+
+			// Let the previous handler, or the default action, deal with the signal
+			for(::std::size_t t_i = 0; t_i < sizeof(g_Signals) / sizeof(g_Signals[0]); ++t_i)
+			{
+				if(g_Signals[t_i] == p_signal)
+					::sigaction(p_signal, &g_Previous[t_i], nullptr);
+			}
+
+			errno = t_errno;
+			::raise(p_signal);
+		}
+
+		// Alternate signal stack of a thread. SA_ONSTACK only takes effect on threads that
+		// registered one, which lets the crash handler run even if the thread overflowed its stack.
+		class signal_stack
+		{
+			public:
+				signal_stack() = default;
+
+				signal_stack(const signal_stack&) = delete;
+				signal_stack& operator=(const signal_stack&) = delete;
+
+				// The memory must not be freed while it is still registered
+				~signal_stack()
+				{
+					if(!m_Memory)
+						return;
+
+					stack_t t_current{ };
+
+					if(::sigaltstack(nullptr, &t_current) == 0 && t_current.ss_sp == m_Memory.get())
+					{
+						stack_t t_disable{ };
+						t_disable.ss_flags = SS_DISABLE;
+						::sigaltstack(&t_disable, nullptr);
+					}
+				}
+
+			public:
+				// Register an alternate stack for the calling thread, unless it already has one
+				auto install()
+					-> void
+				{
+					stack_t t_current{ };
+
+					if(::sigaltstack(nullptr, &t_current) != 0 || !(t_current.ss_flags & SS_DISABLE))
+						return;
+
+					// SIGSTKSZ is not a constant on all systems
+					const auto t_size = ::std::max<::std::size_t>(SIGSTKSZ, 64u << 10);
+					m_Memory.reset(new char[t_size]);
+
+					stack_t t_stack{ };
+					t_stack.ss_sp = m_Memory.get();
+					t_stack.ss_size = t_size;
+
+					if(::sigaltstack(&t_stack, nullptr) != 0)
+						m_Memory.reset();
+				}
+
+			private:
+				::std::unique_ptr<char[]> m_Memory;
+		};
+
+		// Copy given number of bytes starting at given position out of a circular buffer
+		auto copy_from(const char* p_data, ::std::uint64_t p_capacity, ::std::uint64_t p_pos, void* p_out, ::std::size_t p_len)
+			-> void
+		{
+			const auto t_offset = static_cast<::std::size_t>(p_pos % p_capacity);
+			const auto t_first = ::std::min<::std::size_t>(p_len, static_cast<::std::size_t>(p_capacity) - t_offset);
+
+			::std::memcpy(p_out, p_data + t_offset, t_first);
+			::std::memcpy(static_cast<char*>(p_out) + t_first, p_data, p_len - t_first);
+		}
+
+		auto read_u32(const char* p_data)
+			-> ::std::uint32_t
+		{
+			::std::uint32_t t_val;
+			::std::memcpy(&t_val, p_data, sizeof(t_val));
+			return t_val;
+		}
+
+		auto read_u64(const char* p_data)
+			-> ::std::uint64_t
+		{
+			::std::uint64_t t_val;
+			::std::memcpy(&t_val, p_data, sizeof(t_val));
+			return t_val;
+		}
+
+		// Decode all complete records of a single recorder region
+		auto read_region(const char* p_data, ::std::uint64_t p_capacity, ::std::uint64_t p_end, ::std::vector<decoded_record>& p_records)
+			-> void
+		{
+			using internal::flight_record;
+
+			// Everything older than one capacity was overwritten. The first record that is still
+			// intact is found by checking every possible record start for a matching position.
+			auto t_pos = (p_end > p_capacity) ? ((p_end - p_capacity + 7) & ~::std::uint64_t{7}) : 0;
+
+			while(t_pos + sizeof(flight_record) <= p_end)
+			{
+				flight_record t_rec;
+				copy_from(p_data, p_capacity, t_pos, &t_rec, sizeof(t_rec));
+
+				const ::std::uint64_t t_strings = ::std::uint64_t{t_rec.m_FileLength} + t_rec.m_TagLength + t_rec.m_MessageLength;
+
+				const bool t_valid = t_rec.m_Position == static_cast<::std::uint32_t>(t_pos)
+					&& t_rec.m_Length >= sizeof(flight_record)
+					&& t_rec.m_Length % 8 == 0
+					&& t_pos + t_rec.m_Length <= p_end
+					&& sizeof(flight_record) + t_strings <= t_rec.m_Length
+					&& t_rec.m_Level <= ut::enum_cast(severity_level::debug);
+
+				if(!t_valid)
+				{
+					t_pos += 8;
+					continue;
+				}
+
+				decoded_record t_record{ };
+				t_record.m_Level = static_cast<severity_level>(t_rec.m_Level);
+				t_record.m_Bare = (t_rec.m_Flags & 0x1) != 0;
+				t_record.m_Time = timestamp{ t_rec.m_Time };
+				t_record.m_ThreadId = t_rec.m_Thread;
+				t_record.m_Line = t_rec.m_Line;
+
+				auto t_cur = t_pos + sizeof(flight_record);
+
+				const auto t_read = [&](::std::string& p_str, ::std::size_t p_len)
+				{
+					p_str.resize(p_len);
+
+					if(p_len > 0)
+						copy_from(p_data, p_capacity, t_cur, &p_str[0], p_len);
+
+					t_cur += p_len;
+				};
+
+				t_read(t_record.m_File, t_rec.m_FileLength);
+				t_read(t_record.m_Tag, t_rec.m_TagLength);
+				t_read(t_record.m_Message, t_rec.m_MessageLength);
+
+				p_records.push_back(::std::move(t_record));
+				t_pos += t_rec.m_Length;
+			}
+		}
+	}
+
+	flight_recorder_target::flight_recorder_target(::std::size_t p_capacity, const ::std::string& p_dumpPath, severity_level p_lvl)
+		:	log_target(p_lvl),
+			m_Capacity{ ::std::max<::std::size_t>((p_capacity + 7) & ~::std::size_t{7}, 4096) },
+			m_DumpPath{p_dumpPath}
+	{
+		const auto t_words = (sizeof(internal::flight_header) + m_Capacity) / sizeof(::std::uint64_t);
+
+		// Zeroed memory never contains a valid record
+		m_Storage.reset(new ::std::uint64_t[t_words]());
+
+		m_Header = new (m_Storage.get()) internal::flight_header{ };
+		m_Data = reinterpret_cast<char*>(m_Storage.get()) + sizeof(internal::flight_header);
+
+		::std::memcpy(m_Header->m_Magic, internal::flight_magic, sizeof(internal::flight_magic));
+		m_Header->m_Version = internal::flight_version;
+		m_Header->m_ByteOrder = internal::flight_byte_order;
+		m_Header->m_Capacity = m_Capacity;
+		m_Header->m_Position.store(0, ::std::memory_order_relaxed);
+	}
+
+	flight_recorder_target::~flight_recorder_target()
+	{
+		// Make sure the crash handler does not use this recorder anymore
+		const flight_recorder_target* t_self = this;
+		g_Recorder.compare_exchange_strong(t_self, nullptr);
+
+		m_Header->~flight_header();
+	}
+
+	void flight_recorder_target::write(const log_entry& entry)
+	{
+		record(entry);
+
+		if(entry.level() == severity_level::fatal)
+			dump();
+	}
+
+	void flight_recorder_target::write_batch(entry_span entries)
+	{
+		bool t_fatal{false};
+
+		for(const auto& t_entry : entries)
+		{
+			record(t_entry);
+			t_fatal = t_fatal || t_entry.level() == severity_level::fatal;
+		}
+
+		// The process is likely about to die
+		if(t_fatal)
+			dump();
+	}
+
+	auto flight_recorder_target::record(const log_entry& p_entry)
+		-> void
+	{
+		const auto t_msg = p_entry.message_view();
+		const auto* t_file = p_entry.file();
+
+		// A single record, including padding, may not displace more than a quarter of the buffer.
+		// The capacity is at least 4096 bytes, so there is always space left for the strings.
+		// File and tag get up to a quarter of that space each, the message gets the rest.
+		const auto t_space = ((m_Capacity / 4) & ~::std::size_t{7}) - sizeof(internal::flight_record);
+		const auto t_fileLen = ::std::min<::std::size_t>({ ::std::char_traits<char>::length(t_file), t_space / 4, 0xFFFF });
+		const auto t_tagLen = ::std::min<::std::size_t>({ p_entry.tag().length(), t_space / 4, 0xFFFF });
+		const auto t_msgLen = ::std::min<::std::size_t>(t_msg.length(), t_space - t_fileLen - t_tagLen);
+
+		const auto t_length = (sizeof(internal::flight_record) + t_fileLen + t_tagLen + t_msgLen + 7) & ~::std::size_t{7};
+
+		// Reserving the space is the only synchronization between writers
+		const auto t_pos = m_Header->m_Position.fetch_add(t_length, ::std::memory_order_relaxed);
+
+		const internal::flight_record t_rec{
+			~static_cast<::std::uint32_t>(t_pos),
+			static_cast<::std::uint32_t>(t_length),
+			p_entry.time_point().nanoseconds(),
+			p_entry.thread_id(),
+			static_cast<::std::uint32_t>(p_entry.line()),
+			static_cast<::std::uint8_t>(ut::enum_cast(p_entry.level())),
+			static_cast<::std::uint8_t>(p_entry.bare() ? 0x1 : 0x0),
+			static_cast<::std::uint16_t>(t_fileLen),
+			static_cast<::std::uint16_t>(t_tagLen),
+			0,
+			static_cast<::std::uint32_t>(t_msgLen),
+			0
+		};
+
+		auto t_cur = t_pos;
+
+		const auto t_copy = [this, &t_cur](const void* p_data, ::std::size_t p_len)
+		{
+			copy_to(t_cur, p_data, p_len);
+			t_cur += p_len;
+		};
+
+		t_copy(&t_rec, sizeof(t_rec));
+		t_copy(t_file, t_fileLen);
+		t_copy(p_entry.tag().data(), t_tagLen);
+		t_copy(t_msg.data(), t_msgLen);
+
+		// Commit the record. The position field is aligned and thus never wraps around.
+		::std::atomic_thread_fence(::std::memory_order_release);
+
+		const auto t_commit = static_cast<::std::uint32_t>(t_pos);
+		copy_to(t_pos, &t_commit, sizeof(t_commit));
+	}
+
+	auto flight_recorder_target::copy_to(::std::uint64_t p_pos, const void* p_data, ::std::size_t p_len)
+		-> void
+	{
+		const auto t_offset = static_cast<::std::size_t>(p_pos % m_Capacity);
+		const auto t_first = ::std::min(p_len, m_Capacity - t_offset);
+
+		::std::memcpy(m_Data + t_offset, p_data, t_first);
+		::std::memcpy(m_Data, static_cast<const char*>(p_data) + t_first, p_len - t_first);
+	}
+
+	auto flight_recorder_target::dump() const
+		-> bool
+	{
+		const int t_fd = ::open(m_DumpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+		if(t_fd < 0)
+			return false;
+
+		const char* t_cur = reinterpret_cast<const char*>(m_Header);
+		auto t_left = sizeof(internal::flight_header) + m_Capacity;
+
+		while(t_left > 0)
+		{
+			const auto t_written = ::write(t_fd, t_cur, t_left);
+
+			if(t_written < 0)
+			{
+				if(errno == EINTR)
+					continue;
+
+				::close(t_fd);
+				return false;
+			}
+
+			t_cur += t_written;
+			t_left -= static_cast<::std::size_t>(t_written);
+		}
+
+		return ::close(t_fd) == 0;
+	}
+
+	auto flight_recorder_target::install_crash_handler()
+		-> void
+	{
+		g_Recorder.store(this);
+
+		if(g_HandlerInstalled.exchange(true))
+			return;
+
+		install_signal_stack();
+
+		struct sigaction t_action;
+		::std::memset(&t_action, 0, sizeof(t_action));
+
+		t_action.sa_handler = &crash_handler;
+		t_action.sa_flags = SA_ONSTACK;
+		sigemptyset(&t_action.sa_mask);
+
+		for(::std::size_t t_i = 0; t_i < sizeof(g_Signals) / sizeof(g_Signals[0]); ++t_i)
+			::sigaction(g_Signals[t_i], &t_action, &g_Previous[t_i]);
+	}
+
+	auto flight_recorder_target::install_signal_stack()
+		-> void
+	{
+		thread_local signal_stack t_stack{ };
+		t_stack.install();
+	}
+
+	auto read_flight_records(const char* p_data, ::std::size_t p_len, ::std::vector<decoded_record>& p_records)
+		-> ::std::size_t
+	{
+		using internal::flight_header;
+
+		const char* const t_end = p_data + p_len;
+		const char* t_cur = p_data;
+		::std::size_t t_found{0};
+
+		while((t_cur = ::std::search(t_cur, t_end, ::std::begin(internal::flight_magic), ::std::end(internal::flight_magic))) != t_end)
+		{
+			const auto t_remaining = static_cast<::std::size_t>(t_end - t_cur);
+
+			if(t_remaining >= sizeof(flight_header))
+			{
+				const auto t_capacity = read_u64(t_cur + offsetof(flight_header, m_Capacity));
+
+				const bool t_valid = read_u32(t_cur + offsetof(flight_header, m_Version)) == internal::flight_version
+					&& read_u32(t_cur + offsetof(flight_header, m_ByteOrder)) == internal::flight_byte_order
+					&& t_capacity > 0
+					&& t_capacity % 8 == 0
+					&& t_capacity <= t_remaining - sizeof(flight_header);
+
+				if(t_valid)
+				{
+					read_region(t_cur + sizeof(flight_header), t_capacity, read_u64(t_cur + offsetof(flight_header, m_Position)), p_records);
+
+					++t_found;
+					t_cur += sizeof(flight_header) + t_capacity;
+					continue;
+				}
+			}
+
+			++t_cur;
+		}
+
+		return t_found;
+	}
+}
+
+#endif
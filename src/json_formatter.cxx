@@ -0,0 +1,333 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ut/cast.hxx>
+
+#include "json_formatter.hxx"
+#include "log_entry.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		namespace
+		{
+			// Two digit decimal representations of all numbers below 100
+			const char g_DigitPairs[] =
+				"00010203040506070809"
+				"10111213141516171819"
+				"20212223242526272829"
+				"30313233343536373839"
+				"40414243444546474849"
+				"50515253545556575859"
+				"60616263646566676869"
+				"70717273747576777879"
+				"80818283848586878889"
+				"90919293949596979899";
+
+			const char g_Hex[] = "0123456789abcdef";
+
+			// Write decimal representation of given number ending right before given position.
+			// Returns the position of the first digit.
+			auto write_digits(char* p_end, ::std::uint64_t p_val)
+				-> char*
+			{
+				while(p_val >= 100)
+				{
+					const auto t_pair = static_cast<::std::size_t>(p_val % 100) * 2;
+					p_val /= 100;
+					*--p_end = g_DigitPairs[t_pair + 1];
+					*--p_end = g_DigitPairs[t_pair];
+				}
+
+				if(p_val >= 10)
+				{
+					const auto t_pair = static_cast<::std::size_t>(p_val) * 2;
+					*--p_end = g_DigitPairs[t_pair + 1];
+					*--p_end = g_DigitPairs[t_pair];
+				}
+				else *--p_end = static_cast<char>('0' + p_val);
+
+				return p_end;
+			}
+		}
+
+		auto json_writer::reserve(::std::size_t p_len)
+			-> char*
+		{
+			if(sizeof(m_Buffer) - m_Pos < p_len)
+				flush();
+
+			return m_Buffer + m_Pos;
+		}
+
+		auto json_writer::flush()
+			-> void
+		{
+			if(m_Pos > 0)
+			{
+				m_Str.write(m_Buffer, static_cast<::std::streamsize>(m_Pos));
+				m_Pos = 0;
+			}
+		}
+
+		auto json_writer::raw(const char* p_str, ::std::size_t p_len)
+			-> void
+		{
+			while(p_len > 0)
+			{
+				if(m_Pos == sizeof(m_Buffer))
+					flush();
+
+				const auto t_len = ::std::min(p_len, sizeof(m_Buffer) - m_Pos);
+				::std::memcpy(m_Buffer + m_Pos, p_str, t_len);
+
+				m_Pos += t_len;
+				p_str += t_len;
+				p_len -= t_len;
+			}
+		}
+
+		auto json_writer::string(ut::string_view p_str)
+			-> void
+		{
+			raw('"');
+
+			const char* t_cur = p_str.data();
+			const char* const t_end = t_cur + p_str.length();
+
+			while(t_cur != t_end)
+			{
+				// Copy everything that does not need escaping at once
+				const char* t_run = t_cur;
+
+				while(t_run != t_end && static_cast<unsigned char>(*t_run) >= 0x20 && *t_run != '"' && *t_run != '\\')
+					++t_run;
+
+				raw(t_cur, static_cast<::std::size_t>(t_run - t_cur));
+
+				if(t_run == t_end)
+					break;
+
+				const auto t_chr = static_cast<unsigned char>(*t_run);
+				auto* t_out = reserve(6);
+
+				switch(t_chr)
+				{
+					case '"':	::std::memcpy(t_out, "\\\"", 2); m_Pos += 2; break;
+					case '\\':	::std::memcpy(t_out, "\\\\", 2); m_Pos += 2; break;
+					case '\n':	::std::memcpy(t_out, "\\n", 2); m_Pos += 2; break;
+					case '\r':	::std::memcpy(t_out, "\\r", 2); m_Pos += 2; break;
+					case '\t':	::std::memcpy(t_out, "\\t", 2); m_Pos += 2; break;
+					default:
+						::std::memcpy(t_out, "\\u00", 4);
+						t_out[4] = g_Hex[t_chr >> 4];
+						t_out[5] = g_Hex[t_chr & 0xF];
+						m_Pos += 6;
+						break;
+				}
+
+				t_cur = t_run + 1;
+			}
+
+			raw('"');
+		}
+
+		auto json_writer::number(::std::int64_t p_val)
+			-> void
+		{
+			// Negate in unsigned arithmetic, which is also defined for the smallest value
+			const auto t_abs = (p_val < 0) ? (0 - static_cast<::std::uint64_t>(p_val)) : static_cast<::std::uint64_t>(p_val);
+
+			if(p_val < 0)
+				raw('-');
+
+			number(t_abs);
+		}
+
+		auto json_writer::number(::std::uint64_t p_val)
+			-> void
+		{
+			char t_digits[20];
+			auto* const t_end = t_digits + sizeof(t_digits);
+			const auto* t_begin = write_digits(t_end, p_val);
+
+			raw(t_begin, static_cast<::std::size_t>(t_end - t_begin));
+		}
+
+		auto json_writer::number(double p_val)
+			-> void
+		{
+			if(!::std::isfinite(p_val))
+			{
+				raw("null", 4);
+				return;
+			}
+
+			// Integral values are common and can be written without going through printf
+			if(::std::fabs(p_val) < 1e15 && p_val == ::std::trunc(p_val))
+			{
+				number(static_cast<::std::int64_t>(p_val));
+				raw(".0", 2);
+				return;
+			}
+
+			// Use the shortest of the two representations that still round-trips
+			auto* t_out = reserve(32);
+			auto t_len = ::std::snprintf(t_out, 32, "%.15g", p_val);
+
+			if(::std::strtod(t_out, nullptr) != p_val)
+				t_len = ::std::snprintf(t_out, 32, "%.17g", p_val);
+
+			m_Pos += static_cast<::std::size_t>(t_len);
+		}
+
+		auto json_writer::boolean(bool p_val)
+			-> void
+		{
+			if(p_val)
+				raw("true", 4);
+			else raw("false", 5);
+		}
+
+		auto json_writer::key(const char* p_key, ::std::size_t p_len)
+			-> void
+		{
+			if(!m_First)
+				raw(',');
+
+			m_First = false;
+
+			string(ut::string_view{ p_key, p_len });
+			raw(':');
+		}
+
+		auto json_writer::begin_object()
+			-> void
+		{
+			raw('{');
+			m_First = true;
+		}
+
+		auto json_writer::end_object()
+			-> void
+		{
+			raw('}');
+			m_First = false;
+		}
+	}
+
+	namespace
+	{
+		const ut::string_view g_Levels[] =
+		{
+			ut::string_view{ "fatal", 5 },
+			ut::string_view{ "error", 5 },
+			ut::string_view{ "warning", 7 },
+			ut::string_view{ "info", 4 },
+			ut::string_view{ "debug", 5 }
+		};
+
+		// Key given as string literal
+		template< ::std::size_t N >
+		auto write_key(internal::json_writer& p_writer, const char (&p_key)[N])
+			-> void
+		{
+			p_writer.key(p_key, N - 1);
+		}
+	}
+
+	void json_formatter::operator()(::std::ostream& str, const log_entry& entry)
+	{
+		internal::json_writer t_writer{ str };
+
+		t_writer.begin_object();
+
+		write_key(t_writer, "ts");
+		t_writer.number(static_cast<::std::int64_t>(entry.time_point().nanoseconds()));
+
+		write_key(t_writer, "level");
+		t_writer.string(g_Levels[ut::enum_cast(entry.level())]);
+
+		write_key(t_writer, "thread");
+		t_writer.number(static_cast<::std::uint64_t>(entry.thread_id()));
+
+		write_key(t_writer, "file");
+		t_writer.string(ut::string_view{ entry.file(), ::std::char_traits<char>::length(entry.file()) });
+
+		write_key(t_writer, "line");
+		t_writer.number(static_cast<::std::uint64_t>(entry.line()));
+
+		if(entry.bare())
+		{
+			write_key(t_writer, "bare");
+			t_writer.boolean(true);
+		}
+
+		if(!entry.tag().empty())
+		{
+			write_key(t_writer, "tag");
+			t_writer.string(ut::string_view{ entry.tag().data(), entry.tag().length() });
+		}
+
+		write_key(t_writer, "msg");
+		t_writer.string(entry.message_view());
+
+		if(!entry.fields().empty())
+		{
+			write_key(t_writer, "fields");
+			t_writer.begin_object();
+
+			for(const auto& t_field : entry.fields())
+			{
+				const auto t_key = t_field.key();
+				t_writer.key(t_key.data(), t_key.length());
+
+				switch(t_field.type())
+				{
+					case field_type::boolean:
+						t_writer.boolean(t_field.as_bool());
+						break;
+
+					case field_type::signed_integer:
+						t_writer.number(t_field.as_signed());
+						break;
+
+					case field_type::unsigned_integer:
+						t_writer.number(t_field.as_unsigned());
+						break;
+
+					case field_type::floating_point:
+						t_writer.number(t_field.as_double());
+						break;
+
+					case field_type::string:
+						t_writer.string(t_field.as_string());
+						break;
+				}
+			}
+
+			t_writer.end_object();
+		}
+
+		t_writer.end_object();
+		t_writer.raw('\n');
+	}
+}
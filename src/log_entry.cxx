@@ -19,89 +19,209 @@
 #include <iomanip>
 #include <vector>
 #include <chrono>
+#include <atomic>
+#include <cstdint>
 #include <ut/cast.hxx>
 #include <ut/string_view.hxx>
 
 #include "log_entry.hxx"
+#include "tag_registry.hxx"
 
 namespace lg
 {
-	log_entry::log_entry(std::string file, size_t line)
-		:	log_entry(std::move(file), line, false)
+	namespace
 	{
-
+		// Threads are numbered in the order they create their first entry
+		auto current_thread_id()
+			-> ::std::uint32_t
+		{
+			static ::std::atomic<::std::uint32_t> g_NextId{1};
+			thread_local const ::std::uint32_t t_id = g_NextId.fetch_add(1, ::std::memory_order_relaxed);
+			
+			return t_id;
+		}
 	}
 
-	log_entry::log_entry(std::string file, size_t line, bool is_bare)
-		:	m_File{ std::move(file) }, 
-			m_Line{ line },
-			m_IsBare{ is_bare },
-			m_Color{ ut::console_color::reset },
-			m_Level{ severity_level::info },
-			m_Time{ std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()) }
+	log_entry::log_entry(const call_site* site)
+		:	m_Site{ site },
+			m_IsBare{ site->m_IsBare },
+			m_Level{ site->m_Level },
+			m_Color{ site->m_Color },
+			m_ThreadId{ current_thread_id() },
+			m_Time{ timestamp::now() }
+	{
+		// Only the raw time is recorded here. It is rendered when a formatter asks for it.
+	}
+	
+	log_entry::log_entry(const call_site* site, ::lg::timestamp p_time, ::std::uint32_t p_threadId)
+		:	m_Site{ site },
+			m_IsBare{ site->m_IsBare },
+			m_Level{ site->m_Level },
+			m_Color{ site->m_Color },
+			m_ThreadId{ p_threadId },
+			m_Time{ p_time }
 	{
-		// Get timestamp
-		std::tm* tm = std::localtime(&m_Time);
-
-		// Format timestamp
-		std::ostringstream ss;
-		ss << std::put_time(tm, /*"%T"*/"%H:%M:%S"); // TODO "hack".. libstdc++ is still not compatible with c++11, it doesnt support %T
-
-		m_Timestamp = ss.str();
 	}
 
-	log_entry log_entry::operator<< (const std::exception& ex) &&
+	log_entry&& log_entry::operator<< (const std::exception& ex) &&
 	{
-		m_Message << ex.what();
+		append(ex.what());
 		return std::move(*this);
 	}
 
-	log_entry log_entry::operator<< (severity_level lvl) &&
+	log_entry&& log_entry::operator<< (severity_level lvl) &&
 	{
 		m_Level = lvl;
 		return std::move(*this);
 	}
 
-	log_entry log_entry::operator<< (ut::console_color clr) &&
+	log_entry&& log_entry::operator<< (ut::console_color clr) &&
 	{
 		m_Color = clr;
 		return std::move(*this);
 	}
 	
-	log_entry log_entry::operator<< (internal::tag_t tag) &&
+	log_entry&& log_entry::operator<< (internal::tag_t tag) &&
 	{
-		m_Tag = tag.value();
+		m_Tag = tag.id();
 		return std::move(*this);
 	}
 
+	log_entry&& log_entry::operator<< (deferred_format&& fmt) &&
+	{
+		// Only one deferred format is kept per entry. Any further ones are rendered right away.
+		if(m_Deferred.empty())
+		{
+			m_DeferredPos = m_Message.size();
+			m_Deferred = std::move(fmt);
+		}
+		else append(fmt.str());
+		
+		return std::move(*this);
+	}
+	
+	log_entry&& log_entry::operator<< (const internal::kv_t& kv) &&
+	{
+		m_Fields.append(kv);
+		return std::move(*this);
+	}
+	
+	log_entry&& log_entry::operator<< (internal::sync_t) &&
+	{
+		m_Sync = true;
+		return std::move(*this);
+	}
+	
+	void log_entry::append(const char* str)
+	{
+		if(str == nullptr)
+			stream() << str;
+		else m_Message.append(str, std::char_traits<char>::length(str));
+	}
+	
+	void log_entry::append(const std::string& str)
+	{
+		m_Message.append(str.data(), str.length());
+	}
+	
+	void log_entry::append(char chr)
+	{
+		m_Message.push_back(chr);
+	}
+	
+	std::ostream& log_entry::stream()
+	{
+		// The formatting state of the thread's stream is reset once per entry
+		const bool t_reset = !m_StreamUsed;
+		m_StreamUsed = true;
+		
+		return internal::message_stream(m_Message, t_reset);
+	}
+	
+	void log_entry::render() const
+	{
+		if(m_Deferred.empty())
+			return;
+			
+		const auto t_text = m_Deferred.str();
+		m_Message.insert(m_DeferredPos, t_text.data(), t_text.length());
+		m_Deferred = deferred_format{ };
+	}
+
+	void log_entry::prepare() const
+	{
+		render();
+		time_string();
+	}
+
 	std::string log_entry::message() const
 	{
-		return m_Message.str();
+		const auto t_view = message_view();
+		return std::string(t_view.data(), t_view.length());
+	}
+	
+	ut::string_view log_entry::message_view() const
+	{
+		render();
+		return ut::string_view(m_Message.data(), m_Message.size());
+	}
+	
+	const call_site& log_entry::site() const
+	{
+		return *m_Site;
+	}
+	
+	const internal::field_record& log_entry::fields() const
+	{
+		return m_Fields;
+	}
+	
+	bool log_entry::sync() const
+	{
+		return m_Sync;
 	}
 	
 	const std::string& log_entry::tag() const
+	{
+		return internal::tag_registry::name(m_Tag);
+	}
+	
+	tag_id log_entry::tag_index() const
 	{
 		return m_Tag;
 	}
 
-	const std::string& log_entry::file() const
+	const char* log_entry::file() const
+	{
+		return m_Site->m_File;
+	}
+
+	const char* log_entry::time_string() const
 	{
-		return m_File;
+		if(m_TimeString[0] == '\0')
+			format_time(m_Time, time_precision::seconds, m_TimeString);
+			
+		return m_TimeString;
 	}
 
-	const std::string& log_entry::time_string() const
+	::std::uint32_t log_entry::thread_id() const
 	{
-		return m_Timestamp;
+		return m_ThreadId;
 	}
 
-	const std::time_t& log_entry::time() const
+	std::time_t log_entry::time() const
+	{
+		return m_Time.to_time_t();
+	}
+	
+	timestamp log_entry::time_point() const
 	{
 		return m_Time;
 	}
 
 	size_t log_entry::line() const
 	{
-		return m_Line;
+		return m_Site->m_Line;
 	}
 
 	severity_level log_entry::level() const
@@ -15,19 +15,38 @@
 
 #include <stdexcept>
 #include <mutex>
+#include <iterator>
+#include <algorithm>
+#include <string>
+#include <map>
 
 #include "console_target.hxx"
 #include "logger.hxx"
 #include "log_target.hxx"
+#include "tag.hxx"
 
 namespace lg
 {
 	using namespace std::chrono_literals;
+	
+	namespace internal
+	{
+		std::atomic<int> g_Verbosity{-1};
+	}
+	
+	// Source of unique logger ids. Zero is never used.
+	static std::atomic<std::uint64_t> g_nextId{1};
 
-	logger::logger()
-		: m_Worker{ &logger::do_work, this }
+	logger::logger(const std::string& p_name, const channel_options& p_options, bool p_isDefault)
+		:	m_Id{g_nextId.fetch_add(1)},
+			m_Name{p_name},
+			m_IsDefault{p_isDefault},
+			m_SharedPool{static_cast<bool>(p_options.m_Pool)},
+			m_Threshold{static_cast<int>(p_options.m_Threshold)},
+			m_Pool{p_options.m_Pool ? p_options.m_Pool : std::make_shared<dispatch_pool>()}
 	{
-		
+		// The worker thread is started last, after all members were initialized
+		m_Worker = std::thread{ &logger::do_work, this };
 	}
 	
 	logger::~logger()
@@ -43,14 +62,25 @@ namespace lg
 		logger::instance().kill_thread();
 	}
 	
+	constexpr std::uint32_t logger::parked_state;
+	constexpr std::uint32_t logger::batching_state;
+	
 	// Signal the work thread to stop
 	void logger::kill_thread()
 	{
 		// Signal thread to stop
 		m_ShouldStop.store(true);
 		
+		// Release producers that are blocked on a full ring buffer
+		{
+			std::lock_guard<std::mutex> lck(m_ProducerMtx);
+			
+			for(auto& t_producer : m_Producers)
+				t_producer->m_Ring.close();
+		}
+		
 		// Wake up thread
-		notify();
+		m_Doorbell.force_ring();
 		
 		// Block until done
 		m_Worker.join();
@@ -59,81 +89,141 @@ namespace lg
 	}
 	
 	// Notify worker thread about new data
-	void logger::notify()
+	void logger::notify(std::size_t p_pending)
+	{
+		// The queued data has to be visible before the doorbell state is read.
+		// Pairs with the fence in doorbell::prepare_park.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		
+		const auto t_state = m_Doorbell.state();
+		
+		if(t_state == parked_state || (t_state == batching_state && p_pending >= m_BatchSize.load(std::memory_order_relaxed)))
+			m_Doorbell.ring();
+	}
+	
+	// Count entries the worker could collect
+	std::size_t logger::pending()
 	{
+		// Only the worker thread changes the collected count
+		std::size_t t_pending = static_cast<std::size_t>(m_Enqueued.load() - m_Collected.load(std::memory_order_relaxed));
+		
+		std::lock_guard<std::mutex> lck(m_ProducerMtx);
+		
+		for(auto& t_producer : m_Producers)
+			t_pending += t_producer->m_Ring.available();
+			
+		return t_pending;
+	}
+	
+	bool logger::has_work()
+	{
+		return pending() > 0 || m_ShouldStop.load() || m_FlushPending.load();
+	}
+	
+	// Periodic duties bound the time the worker may sleep
+	std::chrono::nanoseconds logger::idle_timeout()
+	{
+		std::chrono::nanoseconds t_timeout{0};
+		
+		const auto t_interval = m_ReportInterval.load(std::memory_order_relaxed);
+		
+		if(t_interval > 0 && !m_Empty.load())
 		{
-			::std::lock_guard<std::mutex> lck(m_CvMtx);
-			m_HasWork = true;
+			const auto t_due = m_LastReport + std::chrono::milliseconds{ t_interval } - std::chrono::steady_clock::now();
+			t_timeout = std::max(std::chrono::duration_cast<std::chrono::nanoseconds>(t_due), std::chrono::nanoseconds{1});
 		}
 		
-		m_WorkCv.notify_one();
+		// A producer waiting for room must never depend on a single wakeup
+		if(m_WaitingProducers.load() > 0 && (t_timeout.count() == 0 || t_timeout > std::chrono::milliseconds{1}))
+			t_timeout = std::chrono::milliseconds{1};
+		
+		// A run of repeated entries has to be summarized once it grows old
+		if(m_DedupFilter.active())
+		{
+			const auto t_age = std::chrono::duration_cast<std::chrono::nanoseconds>(internal::dedup_filter::max_run_age);
+			
+			if(t_timeout.count() == 0 || t_age < t_timeout)
+				t_timeout = t_age;
+		}
+		
+		return t_timeout;
 	}
 	
+	// Wait according to the wakeup strategy
+	void logger::wait_for_work()
+	{
+		const auto t_strategy = m_Strategy.load(std::memory_order_relaxed);
+		
+		// Poll for a while before giving up the CPU
+		if(t_strategy == wakeup_strategy::spin)
+		{
+			for(std::size_t t_n = m_SpinCount.load(std::memory_order_relaxed); t_n > 0; --t_n)
+			{
+				if(has_work())
+					return;
+					
+				std::this_thread::yield();
+			}
+		}
+		
+		// Park until a producer rings. Checking for entries after announcing it makes sure
+		// that no wakeup is lost.
+		const auto t_ticket = m_Doorbell.prepare_park(parked_state);
+		
+		if(has_work())
+			m_Doorbell.cancel_park();
+		else m_Doorbell.park(t_ticket, idle_timeout());
+		
+		// Give the producers some time to queue more entries, so that they are handled in one go
+		if(t_strategy == wakeup_strategy::batch)
+		{
+			const auto t_batchTicket = m_Doorbell.prepare_park(batching_state);
+			const auto t_pending = pending();
+			
+			if(t_pending == 0 || t_pending >= m_BatchSize.load(std::memory_order_relaxed) || m_ShouldStop.load() || m_FlushPending.load())
+				m_Doorbell.cancel_park();
+			else m_Doorbell.park(t_batchTicket, std::chrono::microseconds{ m_BatchDelay.load(std::memory_order_relaxed) });
+		}
+	}
 	
 	// Worker thread function
 	void logger::do_work()
 	{
-		// Maximum duration to wait on condition variable.
-		const auto t_maxWait = 30ms;
-		
-		// Local work indicator. Is used after lock is released.
-		bool t_hasWork{};
-		
 		// Loop until stop is requested
 		while(!m_ShouldStop.load())
 		{
-			// Critical section begin
+			wait_for_work();
+			
+			// Flush requests cover everything enqueued before they were made,
+			// so they have to be taken before the entries
+			take_flush_requests();
+			
+			// Take the shared queue only if something was inserted, which avoids
+			// contending with the producers for nothing
+			if(m_Enqueued.load() != m_Collected.load(std::memory_order_relaxed))
 			{
-				std::unique_lock<std::mutex> lck(m_CvMtx);
-											 
-				// Block until user thread notifies about new work.
-				m_WorkCv.wait_for(lck, t_maxWait);
-						
-				// Check if there really is work, since the block
-				// will periodically release even if there was no notification.
-				// This is done to process work items that were added in the brief period
-				// inbetween cv lock release and next cv wait (aka. time spent processing items).
-				// This is unfortunately a small inconvienience introduced by trying to spend as 
-				// little time as possible on producer side.
-				// This also happens when a worker thread stop was requested.
-				// If a worker thread stop was requested, everything is flushed out before exit.
-				if(m_HasWork)
-				{
-					// Lock mutex. This stops user threads from pushing new entries while we are
-					// dispatching.
-					std::lock_guard<std::recursive_mutex> qlck(m_Mtx);
-							
-					// Indicate that there indeed was data.
-					// We can't use m_HasWork after releasing the lock because a producer thread
-					// might change it in the meantime.
-					t_hasWork = true;
+				// Lock mutex. This stops user threads from pushing new entries while we are
+				// swapping the queues.
+				std::lock_guard<std::recursive_mutex> qlck(m_Mtx);
 				
-					// Swap empty temporary queue with current work queue. This is an O(1) operation.
-					m_WorkQueue.swap(m_TempQueue);		
-					
-					// Reset work indicator. Everything was dispatched.
-					m_HasWork = false;
-				}			
+				// Swap empty temporary queue with current work queue. This is an O(1) operation.
+				m_WorkQueue.swap(m_TempQueue);		
+				m_Collected.fetch_add(m_TempQueue.size(), std::memory_order_relaxed);
 			}
-			// Critical section end
 			
-			// Lock is now released. If there was work, dispatch it now.
-			if(t_hasWork)
-			{			
-				// Lock is released. We can now take as much time as needed to dispatch entries.
-				
-				// Lock concurrent access to log target data structure.
-				// Begin critical section
-				{
-					std::lock_guard<std::mutex> lck(m_DataMutex);
-					dispatch_all(m_TempQueue);		
-				}
-				// End critical section
-				
+			// Collect entries from the producer ring buffers. They don't need the queue lock.
+			drain_producers(m_TempQueue);
 				
-				// Reset local work indicator
-				t_hasWork = false;
-			}	
+			// The self-report is dispatched along with everything else
+			report(m_TempQueue);
+			
+			// A flush also has to write the summary of a run that is still going on
+			deduplicate(m_TempQueue, !m_Barriers.empty());
+			
+			// Lock is released. Hand the entries to the dispatch lanes, which write them
+			// to the log targets on their own threads.
+			if(!m_TempQueue.empty() || !m_Barriers.empty())
+				publish(m_TempQueue);
 		}
 		
 		// A shutdown was requested. Take queue lock and dispatch last
@@ -141,79 +231,634 @@ namespace lg
 		// since we can take as much time as we want.
 		{
 			std::lock_guard<std::recursive_mutex> qlck(m_Mtx);
-			dispatch_all(m_WorkQueue);
+			take_flush_requests();
+			m_Collected.fetch_add(m_WorkQueue.size(), std::memory_order_relaxed);
+			drain_producers(m_WorkQueue);
+			deduplicate(m_WorkQueue, true);
+			publish(m_WorkQueue);
 		}
 		
+		// Let all lanes write what they have left. Lanes of a shared pool keep serving
+		// other loggers, so only wait for them to finish the batches of this one.
+		if(m_SharedPool)
+			m_BatchPool.wait_released();
+		else
+		{
+			std::lock_guard<std::mutex> lck(m_DataMutex);
+			
+			for(auto* t_lane : m_Lanes)
+				t_lane->close();
+		}
+		
+		// Everything was written. Requests made in the meantime have nothing left to wait for.
+		{
+			std::lock_guard<std::mutex> lck(m_FlushMtx);
+			m_FlushClosed = true;
+			
+			for(auto& t_request : m_FlushRequests)
+				t_request->expect(0);
+				
+			m_FlushRequests.clear();
+		}
 	}
 	
-	// Dispatch all log entries contained in given queue
-	void logger::dispatch_all(queue_type& p_queue)
+	// Move flush requests to the worker thread
+	void logger::take_flush_requests()
 	{
-		while(!p_queue.empty())
+		if(!m_FlushPending.load())
+			return;
+			
+		std::lock_guard<std::mutex> lck(m_FlushMtx);
+		
+		m_Barriers.insert(m_Barriers.end(), m_FlushRequests.begin(), m_FlushRequests.end());
+		m_FlushRequests.clear();
+		m_FlushPending.store(false);
+	}
+	
+	// Move entries from all producer ring buffers into given queue
+	bool logger::drain_producers(queue_type& p_queue)
+	{
+		std::lock_guard<std::mutex> lck(m_ProducerMtx);
+		
+		bool t_hasWork{false};
+		
+		for(auto t_it = m_Producers.begin(); t_it != m_Producers.end(); )
 		{
-			dispatch(p_queue.front());
-			p_queue.pop();
+			auto& t_ring = (*t_it)->m_Ring;
+		
+			// Entries of one thread are kept together, which preserves LOCK/UNLOCK blocks.
+			// At most one ring's worth is taken, so a busy producer can not hold back publishing.
+			for(std::size_t t_n = t_ring.capacity(); t_n > 0 && t_ring.try_pop([&p_queue](log_entry& p_entry){ p_queue.push_back(std::move(p_entry)); }); --t_n)
+				t_hasWork = true;
+				
+			// The owning thread has exited and everything was consumed. Release the ring buffer.
+			if(t_it->use_count() == 1 && t_ring.empty())
+			{
+				m_DetachedDrops += t_ring.dropped();
+				m_DetachedPushes += t_ring.pushed();
+				t_it = m_Producers.erase(t_it);
+			}
+			else ++t_it;
 		}
+		
+		return t_hasWork;
 	}
 	
-	// Write entry to all registered log targets
-	void logger::dispatch(const log_entry& p_entry)
+	// Publish all log entries contained in given queue. Every lane receives
+	// the whole queue contents as a single, shared batch.
+	void logger::publish(queue_type& p_queue)
 	{
-		if(m_Empty.load())
-			return;
-		else
+		if(!m_Empty.load() && (!p_queue.empty() || !m_Barriers.empty()))
 		{
-			// Iterate through all targets to dispatch entry
-			for (auto& target : m_Targets)
+			auto t_batch = m_BatchPool.acquire();
+			t_batch->m_Entries.swap(p_queue);
+			t_batch->m_Barriers.swap(m_Barriers);
+			t_batch->m_Owner = m_Id;
+			t_batch->m_Pointers.reserve(t_batch->m_Entries.size());
+			
+			const auto t_now = timestamp::now().nanoseconds();
+			
+			for(const auto& t_entry : t_batch->m_Entries)
+			{
+				// Lanes read the entries concurrently, so nothing may be rendered lazily anymore
+				t_entry.prepare();
+				t_batch->m_Pointers.push_back(&t_entry);
+				
+				m_Latency.record(t_now - t_entry.time_point().nanoseconds());
+			}
+			
+			// Only the worker thread writes these, so there is no need for an atomic maximum
+			const auto t_size = t_batch->m_Entries.size();
+			
+			m_Dispatched.fetch_add(t_size, std::memory_order_relaxed);
+			
+			if(t_size > m_PeakDepth.load(std::memory_order_relaxed))
+				m_PeakDepth.store(t_size, std::memory_order_relaxed);
+			
+			// Lanes are owned by the pool and never destroyed before the logger, so publishing can
+			// happen without holding the lock. This keeps add_target and lanes() responsive while a lane blocks.
 			{
-				// Log only if verbosity level does not exclude entry level
-				if (target->level() >= p_entry.level())
-				{
-					target->write(p_entry);
-				}
+				std::lock_guard<std::mutex> lck(m_DataMutex);
+				
+				m_PublishLanes.assign(m_Lanes.begin(), m_Lanes.end());
 			}
+			
+			// Flush requests complete once every lane wrote the batch
+			for(auto& t_request : t_batch->m_Barriers)
+				t_request->expect(m_PublishLanes.size());
+			
+			const auto t_shared = m_BatchPool.share(std::move(t_batch));
+			
+			for(auto* t_lane : m_PublishLanes)
+				t_lane->publish(t_shared);
 		}
+		
+		p_queue.clear();
+		
+		// Without any targets there is nothing to wait for
+		for(auto& t_request : m_Barriers)
+			t_request->expect(0);
+			
+		m_Barriers.clear();
+	}
+	
+	// Queue self-report entry if the interval has elapsed
+	void logger::report(queue_type& p_queue)
+	{
+		const auto t_interval = m_ReportInterval.load(std::memory_order_relaxed);
+		
+		if(t_interval <= 0 || m_Empty.load())
+			return;
+			
+		const auto t_now = std::chrono::steady_clock::now();
+		
+		if(t_now - m_LastReport < std::chrono::milliseconds{ t_interval })
+			return;
+			
+		m_LastReport = t_now;
+		
+		const auto t_stats = _stats();
+		const auto t_micros = [](std::chrono::nanoseconds p_time)
+		{
+			return std::chrono::duration_cast<std::chrono::microseconds>(p_time).count();
+		};
+		
+		auto t_message = ut::sprintf("enqueued=%s dispatched=%s dropped=%s lane_dropped=%s depth=%s peak=%s p50=%sus p99=%sus arena=%s/%s",
+			t_stats.m_Enqueued, t_stats.m_Dispatched, t_stats.m_Dropped, t_stats.m_LaneDropped,
+			t_stats.m_QueueDepth, t_stats.m_PeakQueueDepth,
+			t_micros(t_stats.m_Latency.percentile(0.5)), t_micros(t_stats.m_Latency.percentile(0.99)),
+			t_stats.m_Arena.m_Bytes, t_stats.m_Arena.m_Peak
+		);
+		
+		for(const auto& t_target : t_stats.m_Targets)
+		{
+			t_message += ut::sprintf(" [%s/%s writes=%s entries=%s bytes=%s time=%sus]",
+				t_target.m_Lane, t_target.m_Index, t_target.m_Writes,
+				t_target.m_Entries, t_target.m_Bytes, t_micros(t_target.m_Time)
+			);
+		}
+		
+		static constexpr call_site t_site{ __FILE__, __LINE__, severity_level::info, ut::console_color::bright_white, false };
+		
+		log_entry t_entry{ &t_site };
+		std::move(t_entry) << tag(stats_tag) << std::move(t_message);
+		
+		p_queue.push_back(std::move(t_entry));
+	}
+	
+	// Remove repeated entries from given queue
+	void logger::deduplicate(queue_type& p_queue, bool p_finish)
+	{
+		if(m_Dedup.load(std::memory_order_relaxed))
+			m_DedupFilter.apply(p_queue);
+			
+		// A run that is still going on when suppression is disabled is summarized as well
+		m_DedupFilter.flush(p_queue, p_finish || !m_Dedup.load(std::memory_order_relaxed));
+	}
+	
+	// Recompute target level and lane list after targets were removed or replaced
+	void logger::update_targets()
+	{
+		m_MaxLevel = -1;
+		
+		const auto t_end = std::remove_if(m_Lanes.begin(), m_Lanes.end(), [this](internal::dispatch_lane* p_lane)
+		{
+			const auto t_level = p_lane->max_level(m_Id);
+			m_MaxLevel = std::max(m_MaxLevel, t_level);
+			
+			return t_level < 0;
+		});
+		
+		m_Lanes.erase(t_end, m_Lanes.end());
+		m_Empty.store(m_Lanes.empty());
+		
+		update_verbosity();
+	}
+	
+	// Recompute verbosity from threshold and targets
+	void logger::update_verbosity()
+	{
+		const auto t_level = std::min(m_MaxLevel, m_Threshold.load());
+		
+		m_Verbosity.store(t_level);
+		
+		if(m_IsDefault)
+			internal::g_Verbosity.store(t_level);
 	}
 	
 	logger& logger::instance()
 	{
-		static logger instance{};
+		static logger instance{ std::string{ }, channel_options{ }, true };
 		return instance;
 	}
+	
+	logger& logger::channel_instance(const std::string& p_name, const channel_options& p_options)
+	{
+		if(p_name.empty())
+			return instance();
+	
+		// Make sure the default logger outlives all channels, which are destroyed
+		// along with the registry
+		instance();
+	
+		static std::mutex t_mtx{ };
+		static std::map<std::string, std::unique_ptr<logger, deleter>> t_channels{ };
+		
+		std::lock_guard<std::mutex> lck(t_mtx);
+		
+		auto& t_ptr = t_channels[p_name];
+		
+		if(!t_ptr)
+			t_ptr.reset(new logger{ p_name, p_options, false });
+			
+		return *t_ptr;
+	}
 
 	// Adds ConsoleTarget as default target
 	void logger::default_init(severity_level p_lvl)
 	{
 		static console_target<> target{ p_lvl };
 
-		instance()._add_target(&target);
+		instance()._add_target(&target, std::string{ }, lane_options{ });
 	}
 	
 	void logger::null_init()
 	{
 		// Make sure that the logger constructor is called
-		instance()._add_target(nullptr);
+		instance()._add_target(nullptr, std::string{ }, lane_options{ });
 	}
 
-	void logger::_add_target(ut::observer_ptr<log_target> target)
+	void logger::_add_target(ut::observer_ptr<log_target> target, const std::string& p_lane, const lane_options& p_options)
 	{
 		// Only add if target is a valid pointer
 		if(target)
 		{
 			// Enter critical section since we are accessing data
-			// that can be cocurrently accessed by the worker thread (the target vector).
+			// that can be cocurrently accessed by the worker thread (the lane vector).
 			// We want to allow adding log targets _after_ logger initialization.		
+			std::lock_guard<std::mutex> t_config(m_TargetMutex);
 			std::lock_guard<std::mutex> lck(m_DataMutex);
 	
-			// Add target to vector and atomically indicate non-emptiness
-			m_Targets.push_back(target);
+			// The lane might already exist, either serving other targets of this logger
+			// or those of another logger sharing the pool
+			auto* t_lane = &m_Pool->lane(p_lane, p_options);
+			
+			if(std::find(m_Lanes.begin(), m_Lanes.end(), t_lane) == m_Lanes.end())
+				m_Lanes.push_back(t_lane);
+	
+			// Add target to lane and atomically indicate non-emptiness
+			t_lane->add_target(target, m_Id);
 			m_Empty.store(false);
+			
+			// Let the LOG_* macros know that entries of this level are now accepted
+			m_MaxLevel = std::max(m_MaxLevel, static_cast<int>(target->level()));
+			update_verbosity();
 		}
 	}
 
-	void logger::add_target(ut::observer_ptr<log_target> target)
+	void logger::add_target(ut::observer_ptr<log_target> target, const std::string& p_lane, const lane_options& p_options)
+	{
+		instance()._add_target(target, p_lane, p_options);
+	}
+	
+	bool logger::_remove_target(ut::observer_ptr<log_target> p_target)
+	{
+		std::lock_guard<std::mutex> t_config(m_TargetMutex);
+		
+		// The lanes wait for their threads to let go of the target. This must not happen while
+		// holding m_DataMutex, since the worker thread needs it in order to publish.
+		lane_container_type t_lanes{ };
+		{
+			std::lock_guard<std::mutex> lck(m_DataMutex);
+			t_lanes = m_Lanes;
+		}
+		
+		// The same target might have been added more than once
+		bool t_removed{false};
+		
+		for(auto* t_lane : t_lanes)
+			while(t_lane->remove_target(p_target, m_Id))
+				t_removed = true;
+				
+		if(t_removed)
+		{
+			std::lock_guard<std::mutex> lck(m_DataMutex);
+			update_targets();
+		}
+		
+		return t_removed;
+	}
+	
+	bool logger::remove_target(ut::observer_ptr<log_target> p_target)
+	{
+		return instance()._remove_target(p_target);
+	}
+	
+	bool logger::_replace_target(ut::observer_ptr<log_target> p_old, ut::observer_ptr<log_target> p_new)
+	{
+		if(!p_new)
+			return false;
+			
+		std::lock_guard<std::mutex> t_config(m_TargetMutex);
+		
+		lane_container_type t_lanes{ };
+		{
+			std::lock_guard<std::mutex> lck(m_DataMutex);
+			t_lanes = m_Lanes;
+		}
+		
+		bool t_replaced{false};
+		
+		for(auto* t_lane : t_lanes)
+			while(t_lane->replace_target(p_old, p_new, m_Id))
+				t_replaced = true;
+				
+		// The new target might accept a different range of levels
+		if(t_replaced)
+		{
+			std::lock_guard<std::mutex> lck(m_DataMutex);
+			update_targets();
+		}
+		
+		return t_replaced;
+	}
+	
+	bool logger::replace_target(ut::observer_ptr<log_target> p_old, ut::observer_ptr<log_target> p_new)
+	{
+		return instance()._replace_target(p_old, p_new);
+	}
+	
+	std::vector<lane_info> logger::_lanes()
+	{
+		std::lock_guard<std::mutex> lck(m_DataMutex);
+		
+		std::vector<lane_info> t_info{ };
+		t_info.reserve(m_Lanes.size());
+		
+		for(auto& t_lane : m_Lanes)
+			t_info.push_back(t_lane->info());
+			
+		return t_info;
+	}
+	
+	std::vector<lane_info> logger::lanes()
+	{
+		return instance()._lanes();
+	}
+	
+	void logger::_set_threshold(severity_level p_lvl)
+	{
+		std::lock_guard<std::mutex> lck(m_DataMutex);
+		
+		m_Threshold.store(static_cast<int>(p_lvl));
+		update_verbosity();
+	}
+	
+	void logger::set_threshold(severity_level p_lvl)
+	{
+		instance()._set_threshold(p_lvl);
+	}
+	
+	severity_level logger::threshold()
+	{
+		return static_cast<severity_level>(instance().m_Threshold.load());
+	}
+	
+	void logger::_set_wakeup(const wakeup_options& p_options)
+	{
+		m_SpinCount.store(p_options.m_SpinCount, std::memory_order_relaxed);
+		m_BatchSize.store(p_options.m_BatchSize, std::memory_order_relaxed);
+		m_BatchDelay.store(p_options.m_BatchDelay.count(), std::memory_order_relaxed);
+		m_Strategy.store(p_options.m_Strategy);
+		
+		// Let the worker thread pick up the new strategy
+		m_Doorbell.force_ring();
+	}
+	
+	void logger::set_wakeup(const wakeup_options& p_options)
+	{
+		instance()._set_wakeup(p_options);
+	}
+	
+	bool logger::_flush(std::chrono::nanoseconds p_timeout)
+	{
+		auto t_request = std::make_shared<internal::flush_barrier>();
+		
+		{
+			std::lock_guard<std::mutex> lck(m_FlushMtx);
+			
+			// The worker thread already wrote everything during shutdown
+			if(m_FlushClosed)
+				return true;
+				
+			m_FlushRequests.push_back(t_request);
+			m_FlushPending.store(true);
+		}
+		
+		// The worker thread might be parked without looking at the flush requests
+		m_Doorbell.force_ring();
+		
+		return t_request->wait_for(p_timeout);
+	}
+	
+	bool logger::flush(std::chrono::milliseconds p_timeout)
+	{
+		return instance()._flush(p_timeout);
+	}
+	
+	void logger::wait_delivery()
+	{
+		_flush(std::chrono::milliseconds{ m_SyncTimeout.load(std::memory_order_relaxed) });
+	}
+	
+	void logger::_use_sync_delivery(severity_level p_lvl, std::chrono::milliseconds p_timeout)
+	{
+		m_SyncTimeout.store(p_timeout.count(), std::memory_order_relaxed);
+		m_SyncLevel.store(static_cast<int>(p_lvl), std::memory_order_relaxed);
+	}
+	
+	void logger::use_sync_delivery(severity_level p_lvl, std::chrono::milliseconds p_timeout)
+	{
+		instance()._use_sync_delivery(p_lvl, p_timeout);
+	}
+	
+	void logger::use_async_delivery()
+	{
+		instance().m_SyncLevel.store(-1, std::memory_order_relaxed);
+	}
+	
+	void logger::_use_ring_buffers(std::size_t p_capacity, overflow_policy p_policy)
+	{
+		{
+			std::lock_guard<std::mutex> lck(m_ProducerMtx);
+			m_RingCapacity = p_capacity;
+			m_RingPolicy = p_policy;
+		}
+		
+		m_UseRings.store(true);
+	}
+	
+	void logger::use_ring_buffers(std::size_t p_capacity, overflow_policy p_policy)
+	{
+		instance()._use_ring_buffers(p_capacity, p_policy);
+	}
+	
+	void logger::use_shared_queue()
+	{
+		instance().m_UseRings.store(false);
+	}
+	
+	std::vector<producer_info> logger::_producers()
+	{
+		std::lock_guard<std::mutex> lck(m_ProducerMtx);
+		
+		std::vector<producer_info> t_info{ };
+		t_info.reserve(m_Producers.size());
+		
+		for(auto& t_producer : m_Producers)
+		{
+			t_info.push_back(producer_info{
+				t_producer->m_Thread,
+				t_producer->m_Ring.capacity(),
+				t_producer->m_Ring.dropped()
+			});
+		}
+		
+		return t_info;
+	}
+	
+	std::vector<producer_info> logger::producers()
+	{
+		return instance()._producers();
+	}
+	
+	std::size_t logger::_dropped()
+	{
+		std::lock_guard<std::mutex> lck(m_ProducerMtx);
+		
+		std::size_t t_sum = m_DetachedDrops;
+		
+		for(auto& t_producer : m_Producers)
+			t_sum += t_producer->m_Ring.dropped();
+			
+		return t_sum;
+	}
+	
+	std::size_t logger::dropped()
+	{
+		return instance()._dropped();
+	}
+	
+	logger_stats logger::_stats()
+	{
+		logger_stats t_stats{ };
+		
+		// Read the collected count first, so that the depth can not become negative
+		const auto t_collected = m_Collected.load(std::memory_order_relaxed);
+		const auto t_enqueued = m_Enqueued.load(std::memory_order_relaxed);
+		
+		t_stats.m_Enqueued = t_enqueued;
+		t_stats.m_QueueDepth = static_cast<std::size_t>(t_enqueued > t_collected ? t_enqueued - t_collected : 0);
+		
+		{
+			std::lock_guard<std::mutex> lck(m_ProducerMtx);
+			
+			t_stats.m_Enqueued += m_DetachedPushes;
+			t_stats.m_Dropped = m_DetachedDrops;
+			
+			for(auto& t_producer : m_Producers)
+			{
+				t_stats.m_Enqueued += t_producer->m_Ring.pushed();
+				t_stats.m_Dropped += t_producer->m_Ring.dropped();
+				t_stats.m_QueueDepth += t_producer->m_Ring.size();
+			}
+		}
+		
+		t_stats.m_Dispatched = m_Dispatched.load(std::memory_order_relaxed);
+		t_stats.m_PeakQueueDepth = m_PeakDepth.load(std::memory_order_relaxed);
+		t_stats.m_Deduplicated = m_DedupFilter.removed();
+		t_stats.m_Latency = m_Latency.snapshot();
+		t_stats.m_Arena = internal::arena_statistics();
+		
+		std::lock_guard<std::mutex> lck(m_DataMutex);
+		
+		for(auto& t_lane : m_Lanes)
+		{
+			t_stats.m_Lanes.push_back(t_lane->info());
+			t_stats.m_LaneDropped += t_stats.m_Lanes.back().m_Dropped;
+			
+			t_lane->collect_stats(t_stats.m_Targets, m_Id);
+		}
+		
+		return t_stats;
+	}
+	
+	logger_stats logger::stats()
+	{
+		return instance()._stats();
+	}
+	
+	void logger::_self_report(std::chrono::milliseconds p_interval)
+	{
+		m_ReportInterval.store(p_interval.count(), std::memory_order_relaxed);
+		
+		// The worker thread might be parked without a timeout
+		m_Doorbell.force_ring();
+	}
+	
+	void logger::self_report(std::chrono::milliseconds p_interval)
+	{
+		instance()._self_report(p_interval);
+	}
+	
+	void logger::configure_arenas(const arena_options& p_options)
+	{
+		internal::configure_arenas(p_options);
+	}
+	
+	void logger::deduplicate(bool p_enable)
+	{
+		instance().m_Dedup.store(p_enable, std::memory_order_relaxed);
+	}
+	
+	// Retrieve ring buffer of calling thread
+	logger::producer& logger::local_producer()
+	{
+		// The logger keeps a second reference. Once the thread exits, the worker thread
+		// will notice that it holds the last one and release the ring buffer after
+		// all remaining entries were dispatched.
+		if(auto* t_producer = find_producer())
+			return *t_producer;
+		
+		std::lock_guard<std::mutex> lck(m_ProducerMtx);
+		
+		auto t_ring = std::make_shared<producer>(m_RingCapacity, m_RingPolicy);
+		
+		if(m_ShouldStop.load())
+			t_ring->m_Ring.close();
+		
+		m_Producers.push_back(t_ring);
+		thread_rings().emplace_back(m_Id, t_ring);
+		
+		return *t_ring;
+	}
+	
+	logger::producer* logger::find_producer()
+	{
+		// There are only a few loggers, so a linear search is sufficient
+		for(auto& t_ring : thread_rings())
+		{
+			if(t_ring.first == m_Id)
+				return t_ring.second.get();
+		}
+		
+		return nullptr;
+	}
+	
+	logger::ring_list& logger::thread_rings()
 	{
-		instance()._add_target(target);
+		thread_local ring_list t_rings{ };
+		return t_rings;
 	}
 
 	// Insert log entry
@@ -222,34 +867,115 @@ namespace lg
 		// Avoid locking when logger is disabled / empty
 		if(m_Empty.load())
 			return;
+			
+		// Entries tagged using lg::tag instead of the LOG_*_TAG macros are filtered here
+		if(!internal::tag_registry::enabled(p_entry.tag_index(), p_entry.level()))
+			return;
+			
+		const bool t_sync = p_entry.sync() || static_cast<int>(p_entry.level()) <= m_SyncLevel.load(std::memory_order_relaxed);
+			
+		// Lock-free path: Push into the ring buffer of this thread. The worker is only
+		// notified if nobody else did so since it last drained the ring buffers.
+		if(m_UseRings.load(std::memory_order_relaxed))
+		{
+			auto& t_producer = local_producer();
+			
+			// A blocking insertion waits for the worker thread to make room. It has to be woken up
+			// even inside of a block, since it takes the entries of a full ring buffer regardless.
+			const bool t_waits = t_producer.m_Ring.policy() == overflow_policy::block && t_producer.m_Ring.full();
+			
+			if(t_waits)
+			{
+				m_WaitingProducers.fetch_add(1);
+				notify(t_producer.m_Ring.available());
+			}
+			
+			t_producer.m_Ring.push(std::move(p_entry));
+			
+			if(t_waits)
+				m_WaitingProducers.fetch_sub(1);
+			
+			// The worker thread does not take the entries of a block before it ended
+			if(t_producer.m_InBlock)
+				t_producer.m_BlockSync = t_producer.m_BlockSync || t_sync;
+			else if(t_sync)
+				wait_delivery();
+			else notify(t_producer.m_Ring.available());
+				
+			return;
+		}
+		
+		std::uint64_t t_enqueued{ };
+		bool t_inBlock{ };
 		
 		// Scope to automatically release mutex lock
 		{
 			// Lock queue lock and push log entry
 			std::lock_guard<std::recursive_mutex> lck(m_Mtx);
-			m_WorkQueue.push(std::move(p_entry));
+			m_WorkQueue.push_back(std::move(p_entry));
+			t_enqueued = m_Enqueued.fetch_add(1, std::memory_order_relaxed) + 1;
+			
+			// Only the thread owning the block can see it set, since it holds the lock throughout
+			t_inBlock = m_IsLocked;
+			
+			if(t_inBlock)
+				m_BlockSync = m_BlockSync || t_sync;
 		}
 		
-		// If we are in a surrounding LOCK/UNLOCK block, notifying here would
-		// lead to a deadlock.
-		if(!m_IsLocked)
-			// Otherwise, notify the working thread that new data is available.
-			notify();
+		// If we are in a surrounding LOCK/UNLOCK block, waking the worker thread would
+		// only make it wait for the queue lock. It is notified once the block ends,
+		// which also is when waiting for synchronous delivery happens.
+		if(t_inBlock)
+			return;
+		
+		// Flushing wakes the worker thread anyway
+		if(t_sync)
+			wait_delivery();
+		// Otherwise, notify the working thread that new data is available.
+		else notify(static_cast<std::size_t>(t_enqueued - m_Collected.load(std::memory_order_relaxed)));
 	}
 
 	void logger::lock()
 	{
+		// In ring buffer mode, the worker thread holds back all entries of this thread
+		// until the block ends. This keeps them together without blocking other producers.
+		if(m_UseRings.load(std::memory_order_relaxed))
+		{
+			auto& t_producer = local_producer();
+			t_producer.m_Ring.begin_block();
+			t_producer.m_InBlock = true;
+			return;
+		}
+	
 		m_Mtx.lock();
 		m_IsLocked = true;
 	}
 
 	void logger::unlock()
 	{
-		m_IsLocked = false;
-		m_Mtx.unlock();
+		auto* t_producer = find_producer();
+	
+		bool t_sync{false};
+	
+		if(t_producer && t_producer->m_InBlock)
+		{
+			t_sync = t_producer->m_BlockSync;
+			t_producer->m_InBlock = false;
+			t_producer->m_BlockSync = false;
+			t_producer->m_Ring.end_block();
+		}
+		else
+		{
+			t_sync = m_BlockSync;
+			m_BlockSync = false;
+			m_IsLocked = false;
+			m_Mtx.unlock();
+		}
 		
 		// We have to notify here to make sure that the working thread is aware of
-		// the data that was inserted in the previous LOCK/UNLOCK block.		
-		notify();
+		// the data that was inserted in the previous LOCK/UNLOCK block.
+		if(t_sync)
+			wait_delivery();
+		else notify();
 	}
 }
@@ -0,0 +1,89 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "logger_stats.hxx"
+
+namespace lg
+{
+	constexpr ::std::size_t latency_histogram::bucket_count;
+
+	auto latency_histogram::total() const
+		-> ::std::uint64_t
+	{
+		::std::uint64_t t_sum{0};
+
+		for(const auto t_count : m_Buckets)
+			t_sum += t_count;
+
+		return t_sum;
+	}
+
+	auto latency_histogram::percentile(double p_quantile) const
+		-> ::std::chrono::nanoseconds
+	{
+		const auto t_total = total();
+
+		if(t_total == 0)
+			return ::std::chrono::nanoseconds{0};
+
+		// Number of values that have to be at or below the result
+		const auto t_rank = static_cast<::std::uint64_t>(p_quantile * static_cast<double>(t_total - 1)) + 1;
+		::std::uint64_t t_seen{0};
+
+		for(::std::size_t t_i = 0; t_i < bucket_count; ++t_i)
+		{
+			t_seen += m_Buckets[t_i];
+
+			if(t_seen >= t_rank)
+				return ::std::chrono::nanoseconds{ t_i == 0 ? 0 : (::std::int64_t{1} << t_i) - 1 };
+		}
+
+		return ::std::chrono::nanoseconds{ (::std::int64_t{1} << (bucket_count - 1)) - 1 };
+	}
+
+	auto latency_histogram::bucket_of(::std::int64_t p_ns)
+		-> ::std::size_t
+	{
+		// Clock adjustments can make durations negative
+		if(p_ns <= 0)
+			return 0;
+
+		// Number of significant bits
+#if defined(__GNUC__)
+		const auto t_bits = static_cast<::std::size_t>(64 - __builtin_clzll(static_cast<unsigned long long>(p_ns)));
+#else
+		::std::size_t t_bits{0};
+
+		for(auto t_value = static_cast<::std::uint64_t>(p_ns); t_value != 0; t_value >>= 1)
+			++t_bits;
+#endif
+
+		return t_bits < bucket_count ? t_bits : bucket_count - 1;
+	}
+
+	namespace internal
+	{
+		auto atomic_histogram::snapshot() const
+			-> latency_histogram
+		{
+			latency_histogram t_result{ };
+
+			for(::std::size_t t_i = 0; t_i < latency_histogram::bucket_count; ++t_i)
+				t_result.m_Buckets[t_i] = m_Buckets[t_i].load(::std::memory_order_relaxed);
+
+			return t_result;
+		}
+	}
+}
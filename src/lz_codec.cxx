@@ -0,0 +1,556 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include "lz_codec.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		namespace
+		{
+			constexpr ::std::size_t min_match = 4;			// Shortest match that can be encoded
+			constexpr ::std::size_t last_literals = 5;		// The last bytes of a block are always literals
+			constexpr ::std::size_t match_find_limit = 12;	// The last match has to start this many bytes before the end
+			constexpr ::std::size_t max_offset = 65535;
+			
+			// LZ4 frame format constants
+			constexpr ::std::uint32_t frame_magic = 0x184D2204;
+			constexpr ::std::uint32_t skippable_magic = 0x184D2A50;		// Lower four bits are arbitrary
+			constexpr ::std::uint8_t flag_version = 0x40;
+			constexpr ::std::uint8_t flag_independent = 0x20;
+			constexpr ::std::uint8_t flag_block_checksum = 0x10;
+			constexpr ::std::uint8_t flag_content_size = 0x08;
+			constexpr ::std::uint8_t flag_content_checksum = 0x04;
+			constexpr ::std::uint8_t flag_dict_id = 0x01;
+			constexpr ::std::uint32_t block_uncompressed = 0x80000000u;	// Block size flag for stored blocks
+		
+			auto read32(const unsigned char* p_ptr)
+				-> ::std::uint32_t
+			{
+				::std::uint32_t t_val;
+				::std::memcpy(&t_val, p_ptr, sizeof(t_val));
+				return t_val;
+			}
+			
+			auto hash(::std::uint32_t p_val, unsigned p_hashLog)
+				-> ::std::size_t
+			{
+				return (p_val * 2654435761u) >> (32 - p_hashLog);
+			}
+			
+			auto read32_le(const unsigned char* p_ptr)
+				-> ::std::uint32_t
+			{
+				return static_cast<::std::uint32_t>(p_ptr[0]) | (static_cast<::std::uint32_t>(p_ptr[1]) << 8)
+					| (static_cast<::std::uint32_t>(p_ptr[2]) << 16) | (static_cast<::std::uint32_t>(p_ptr[3]) << 24);
+			}
+			
+			auto append32_le(::std::string& p_out, ::std::uint32_t p_val)
+				-> void
+			{
+				for(::std::size_t t_i = 0; t_i < 4; ++t_i)
+					p_out.push_back(static_cast<char>((p_val >> (t_i * 8)) & 0xFF));
+			}
+			
+			auto rotl(::std::uint32_t p_val, unsigned p_bits)
+				-> ::std::uint32_t
+			{
+				return (p_val << p_bits) | (p_val >> (32 - p_bits));
+			}
+			
+			// xxHash32, which the LZ4 frame format uses for its checksums
+			auto xxh32(const unsigned char* p_data, ::std::size_t p_len, ::std::uint32_t p_seed)
+				-> ::std::uint32_t
+			{
+				constexpr ::std::uint32_t t_prime1 = 2654435761u;
+				constexpr ::std::uint32_t t_prime2 = 2246822519u;
+				constexpr ::std::uint32_t t_prime3 = 3266489917u;
+				constexpr ::std::uint32_t t_prime4 = 668265263u;
+				constexpr ::std::uint32_t t_prime5 = 374761393u;
+				
+				const auto* t_ptr = p_data;
+				const auto* t_end = p_data + p_len;
+				::std::uint32_t t_hash{ };
+				
+				if(p_len >= 16)
+				{
+					::std::uint32_t t_acc[4] = { p_seed + t_prime1 + t_prime2, p_seed + t_prime2, p_seed, p_seed - t_prime1 };
+					
+					for(; t_end - t_ptr >= 16; t_ptr += 16)
+					{
+						for(::std::size_t t_i = 0; t_i < 4; ++t_i)
+							t_acc[t_i] = rotl(t_acc[t_i] + read32_le(t_ptr + t_i * 4) * t_prime2, 13) * t_prime1;
+					}
+					
+					t_hash = rotl(t_acc[0], 1) + rotl(t_acc[1], 7) + rotl(t_acc[2], 12) + rotl(t_acc[3], 18);
+				}
+				else t_hash = p_seed + t_prime5;
+				
+				t_hash += static_cast<::std::uint32_t>(p_len);
+				
+				for(; t_end - t_ptr >= 4; t_ptr += 4)
+					t_hash = rotl(t_hash + read32_le(t_ptr) * t_prime3, 17) * t_prime4;
+					
+				for(; t_ptr < t_end; ++t_ptr)
+					t_hash = rotl(t_hash + (*t_ptr) * t_prime5, 11) * t_prime1;
+					
+				t_hash ^= t_hash >> 15;
+				t_hash *= t_prime2;
+				t_hash ^= t_hash >> 13;
+				t_hash *= t_prime3;
+				t_hash ^= t_hash >> 16;
+				
+				return t_hash;
+			}
+			
+			// Header checksum of a frame descriptor
+			auto descriptor_checksum(const unsigned char* p_descriptor, ::std::size_t p_len)
+				-> ::std::uint8_t
+			{
+				return static_cast<::std::uint8_t>((xxh32(p_descriptor, p_len, 0) >> 8) & 0xFF);
+			}
+			
+			// Maximum block size for given block size id of the frame descriptor
+			auto block_size_of(unsigned p_id)
+				-> ::std::size_t
+			{
+				return ::std::size_t{1} << (8 + 2 * p_id);
+			}
+			
+			// Settings of a frame, as read from its header
+			struct frame_header
+			{
+				::std::uint8_t m_Flags{0};
+				::std::size_t m_BlockSize{0};
+				::std::uint64_t m_ContentSize{0};
+			};
+			
+			// Parse the header of the non-skippable frame at the start of given data. Returns the size of the
+			// header, or zero if the data ends before it does.
+			auto read_header(const unsigned char* p_ptr, ::std::size_t p_len, frame_header& p_header)
+				-> ::std::size_t
+			{
+				if(p_len < 7)
+					return 0;
+					
+				if(read32_le(p_ptr) != frame_magic)
+					throw ::std::runtime_error("lz_codec: Invalid frame magic");
+					
+				const auto t_flags = p_ptr[4];
+				const auto t_id = static_cast<unsigned>((p_ptr[5] >> 4) & 0x7);
+				
+				if((t_flags & 0xC0) != flag_version || t_id < 4)
+					throw ::std::runtime_error("lz_codec: Unsupported frame descriptor");
+					
+				if((t_flags & flag_independent) == 0)
+					throw ::std::runtime_error("lz_codec: Linked blocks are not supported");
+					
+				const ::std::size_t t_descLen = 2 + ((t_flags & flag_content_size) ? 8 : 0) + ((t_flags & flag_dict_id) ? 4 : 0);
+				
+				if(p_len < 4 + t_descLen + 1)
+					return 0;
+					
+				if(descriptor_checksum(p_ptr + 4, t_descLen) != p_ptr[4 + t_descLen])
+					throw ::std::runtime_error("lz_codec: Header checksum mismatch");
+					
+				p_header.m_Flags = t_flags;
+				p_header.m_BlockSize = block_size_of(t_id);
+				p_header.m_ContentSize = 0;
+				
+				if(t_flags & flag_content_size)
+					p_header.m_ContentSize = static_cast<::std::uint64_t>(read32_le(p_ptr + 6)) | (static_cast<::std::uint64_t>(read32_le(p_ptr + 10)) << 32);
+					
+				return 4 + t_descLen + 1;
+			}
+			
+			// Size of the skippable frame at the start of given data, or zero if the data ends before it does
+			auto skippable_size(const unsigned char* p_ptr, ::std::size_t p_len)
+				-> ::std::size_t
+			{
+				if(p_len < 8)
+					return 0;
+					
+				const auto t_size = 8 + static_cast<::std::size_t>(read32_le(p_ptr + 4));
+				return p_len >= t_size ? t_size : 0;
+			}
+			
+			auto is_skippable(const unsigned char* p_ptr, ::std::size_t p_len)
+				-> bool
+			{
+				return p_len >= 4 && (read32_le(p_ptr) & 0xFFFFFFF0u) == skippable_magic;
+			}
+			
+			// Lengths that do not fit into the 4 bits of the token are continued in bytes of 255
+			auto write_length(::std::string& p_out, ::std::size_t p_len)
+				-> void
+			{
+				for(; p_len >= 255; p_len -= 255)
+					p_out.push_back(static_cast<char>(255));
+					
+				p_out.push_back(static_cast<char>(p_len));
+			}
+			
+			auto write_sequence(::std::string& p_out, const unsigned char* p_literals, ::std::size_t p_litLen, ::std::size_t p_offset, ::std::size_t p_matchLen)
+				-> void
+			{
+				const auto t_litToken = (p_litLen >= 15) ? 15 : p_litLen;
+				const auto t_matchToken = (p_matchLen == 0) ? 0 : ((p_matchLen - min_match >= 15) ? 15 : p_matchLen - min_match);
+				
+				p_out.push_back(static_cast<char>((t_litToken << 4) | t_matchToken));
+				
+				if(p_litLen >= 15)
+					write_length(p_out, p_litLen - 15);
+					
+				p_out.append(reinterpret_cast<const char*>(p_literals), p_litLen);
+				
+				// The final sequence only consists of literals
+				if(p_matchLen == 0)
+					return;
+					
+				p_out.push_back(static_cast<char>(p_offset & 0xFF));
+				p_out.push_back(static_cast<char>(p_offset >> 8));
+				
+				if(p_matchLen - min_match >= 15)
+					write_length(p_out, p_matchLen - min_match - 15);
+			}
+			
+			auto read_length(const unsigned char*& p_ptr, const unsigned char* p_end, ::std::size_t& p_len)
+				-> bool
+			{
+				while(true)
+				{
+					if(p_ptr == p_end)
+						return false;
+						
+					const auto t_byte = *p_ptr++;
+					p_len += t_byte;
+					
+					if(t_byte != 255)
+						return true;
+				}
+			}
+		}
+	
+		auto lz_compress(const char* p_src, ::std::size_t p_len, ::std::string& p_out, unsigned p_level)
+			-> void
+		{
+			const auto t_src = reinterpret_cast<const unsigned char*>(p_src);
+			const unsigned t_hashLog = 9 + ::std::min(::std::max(p_level, lz_min_level), lz_max_level);
+			
+			// Worst case: everything is stored as literals
+			p_out.reserve(p_out.size() + p_len + p_len / 255 + 16);
+			
+			::std::size_t t_anchor{0};
+			
+			if(p_len > match_find_limit)
+			{
+				// Positions are stored plus one, so that zero means "no entry". The table
+				// is kept per thread, since the larger ones do not fit on the stack.
+				thread_local ::std::vector<::std::uint32_t> t_table{ };
+				t_table.assign(::std::size_t{1} << t_hashLog, 0u);
+			
+				const auto t_limit = p_len - match_find_limit;
+				const auto t_matchLimit = p_len - last_literals;
+				::std::size_t t_pos{0};
+				
+				while(t_pos <= t_limit)
+				{
+					const auto t_val = read32(t_src + t_pos);
+					auto& t_entry = t_table[hash(t_val, t_hashLog)];
+					const ::std::size_t t_ref = t_entry;
+					t_entry = static_cast<::std::uint32_t>(t_pos + 1);
+					
+					if(t_ref == 0 || t_pos - (t_ref - 1) > max_offset || read32(t_src + t_ref - 1) != t_val)
+					{
+						++t_pos;
+						continue;
+					}
+					
+					const auto t_match = t_ref - 1;
+					::std::size_t t_matchLen{min_match};
+					
+					while(t_pos + t_matchLen < t_matchLimit && t_src[t_match + t_matchLen] == t_src[t_pos + t_matchLen])
+						++t_matchLen;
+						
+					write_sequence(p_out, t_src + t_anchor, t_pos - t_anchor, t_pos - t_match, t_matchLen);
+					
+					t_pos += t_matchLen;
+					t_anchor = t_pos;
+				}
+			}
+			
+			write_sequence(p_out, t_src + t_anchor, p_len - t_anchor, 0, 0);
+		}
+		
+		auto lz_decompress(const char* p_src, ::std::size_t p_len, char* p_dst, ::std::size_t p_dstLen)
+			-> bool
+		{
+			::std::size_t t_size{ };
+			return lz_decompress_bounded(p_src, p_len, p_dst, p_dstLen, t_size) && t_size == p_dstLen;
+		}
+		
+		auto lz_decompress_bounded(const char* p_src, ::std::size_t p_len, char* p_dst, ::std::size_t p_dstLen, ::std::size_t& p_size)
+			-> bool
+		{
+			auto t_ip = reinterpret_cast<const unsigned char*>(p_src);
+			const auto t_ipEnd = t_ip + p_len;
+			::std::size_t t_op{0};
+			
+			while(t_ip < t_ipEnd)
+			{
+				const auto t_token = *t_ip++;
+				
+				// Literals
+				::std::size_t t_litLen = t_token >> 4;
+				
+				if(t_litLen == 15 && !read_length(t_ip, t_ipEnd, t_litLen))
+					return false;
+					
+				if(static_cast<::std::size_t>(t_ipEnd - t_ip) < t_litLen || p_dstLen - t_op < t_litLen)
+					return false;
+					
+				::std::memcpy(p_dst + t_op, t_ip, t_litLen);
+				t_ip += t_litLen;
+				t_op += t_litLen;
+				
+				// The last sequence ends after its literals
+				if(t_ip == t_ipEnd)
+					break;
+					
+				// Match
+				if(t_ipEnd - t_ip < 2)
+					return false;
+					
+				const ::std::size_t t_offset = t_ip[0] | (t_ip[1] << 8);
+				t_ip += 2;
+				
+				::std::size_t t_matchLen = t_token & 0xF;
+				
+				if(t_matchLen == 15 && !read_length(t_ip, t_ipEnd, t_matchLen))
+					return false;
+					
+				t_matchLen += min_match;
+				
+				if(t_offset == 0 || t_offset > t_op || p_dstLen - t_op < t_matchLen)
+					return false;
+				
+				// Source and destination may overlap, so this has to be copied byte by byte
+				for(::std::size_t t_i = 0; t_i < t_matchLen; ++t_i, ++t_op)
+					p_dst[t_op] = p_dst[t_op - t_offset];
+			}
+			
+			p_size = t_op;
+			return true;
+		}
+		
+		auto lz_frame_compress(const char* p_src, ::std::size_t p_len, ::std::string& p_out, unsigned p_level)
+			-> void
+		{
+			// Use the smallest block size that holds all data, up to 4 MiB
+			unsigned t_id{4};
+			
+			while(t_id < 7 && block_size_of(t_id) < p_len)
+				++t_id;
+				
+			const auto t_blockSize = block_size_of(t_id);
+			
+			append32_le(p_out, frame_magic);
+			
+			const auto t_descriptor = p_out.size();
+			p_out.push_back(static_cast<char>(flag_version | flag_independent | flag_content_size));
+			p_out.push_back(static_cast<char>(t_id << 4));
+			append32_le(p_out, static_cast<::std::uint32_t>(static_cast<::std::uint64_t>(p_len) & 0xFFFFFFFFu));
+			append32_le(p_out, static_cast<::std::uint32_t>(static_cast<::std::uint64_t>(p_len) >> 32));
+			p_out.push_back(static_cast<char>(descriptor_checksum(reinterpret_cast<const unsigned char*>(p_out.data() + t_descriptor), p_out.size() - t_descriptor)));
+			
+			for(::std::size_t t_pos = 0; t_pos < p_len; t_pos += t_blockSize)
+			{
+				const auto t_len = ::std::min(t_blockSize, p_len - t_pos);
+				
+				// The size is filled in once known. Blocks that do not shrink are stored as they are.
+				const auto t_header = p_out.size();
+				append32_le(p_out, 0u);
+				
+				lz_compress(p_src + t_pos, t_len, p_out, p_level);
+				
+				auto t_size = static_cast<::std::uint32_t>(p_out.size() - t_header - 4);
+				
+				if(t_size >= t_len)
+				{
+					p_out.resize(t_header + 4);
+					p_out.append(p_src + t_pos, t_len);
+					t_size = static_cast<::std::uint32_t>(t_len) | block_uncompressed;
+				}
+				
+				for(::std::size_t t_i = 0; t_i < 4; ++t_i)
+					p_out[t_header + t_i] = static_cast<char>((t_size >> (t_i * 8)) & 0xFF);
+			}
+			
+			append32_le(p_out, 0u);
+		}
+		
+		auto lz_frame_decompress(const char* p_src, ::std::size_t p_len, ::std::string& p_out)
+			-> ::std::size_t
+		{
+			const auto* t_begin = reinterpret_cast<const unsigned char*>(p_src);
+			const auto* t_end = t_begin + p_len;
+			
+			// Skippable frames carry user data, e.g. seek tables of other tools
+			if(is_skippable(t_begin, p_len))
+				return skippable_size(t_begin, p_len);
+				
+			frame_header t_header{ };
+			const auto t_headerLen = read_header(t_begin, p_len, t_header);
+			
+			if(t_headerLen == 0)
+				return 0;
+				
+			const auto* t_ptr = t_begin + t_headerLen;
+			
+			const auto t_available = [&t_ptr, t_end](::std::size_t p_count)
+			{
+				return static_cast<::std::size_t>(t_end - t_ptr) >= p_count;
+			};
+			
+			const auto t_flags = t_header.m_Flags;
+			const auto t_blockSize = t_header.m_BlockSize;
+			const auto t_outBegin = p_out.size();
+			
+			while(true)
+			{
+				if(!t_available(4))
+				{
+					p_out.resize(t_outBegin);
+					return 0;
+				}
+				
+				const auto t_size = read32_le(t_ptr);
+				t_ptr += 4;
+				
+				// End mark
+				if(t_size == 0)
+					break;
+					
+				const auto t_len = static_cast<::std::size_t>(t_size & ~block_uncompressed);
+				const ::std::size_t t_checksum = (t_flags & flag_block_checksum) ? 4 : 0;
+				
+				if(t_len > t_blockSize)
+					throw ::std::runtime_error("lz_codec: Block exceeds maximum size");
+				
+				if(!t_available(t_len + t_checksum))
+				{
+					p_out.resize(t_outBegin);
+					return 0;
+				}
+				
+				if(t_size & block_uncompressed)
+					p_out.append(reinterpret_cast<const char*>(t_ptr), t_len);
+				else
+				{
+					const auto t_offset = p_out.size();
+					::std::size_t t_produced{ };
+					
+					p_out.resize(t_offset + t_blockSize);
+					
+					if(!lz_decompress_bounded(reinterpret_cast<const char*>(t_ptr), t_len, &p_out[t_offset], t_blockSize, t_produced))
+						throw ::std::runtime_error("lz_codec: Malformed block");
+						
+					p_out.resize(t_offset + t_produced);
+				}
+				
+				t_ptr += t_len + t_checksum;
+			}
+			
+			if(t_flags & flag_content_checksum)
+			{
+				if(!t_available(4))
+				{
+					p_out.resize(t_outBegin);
+					return 0;
+				}
+				
+				t_ptr += 4;
+			}
+			
+			return static_cast<::std::size_t>(t_ptr - t_begin);
+		}
+		
+		auto lz_frame_inspect(const char* p_src, ::std::size_t p_len, lz_frame_info& p_info)
+			-> bool
+		{
+			const auto* t_begin = reinterpret_cast<const unsigned char*>(p_src);
+			
+			p_info = lz_frame_info{ };
+			
+			if(is_skippable(t_begin, p_len))
+			{
+				p_info.m_Skippable = true;
+				p_info.m_Size = skippable_size(t_begin, p_len);
+				return p_info.m_Size != 0;
+			}
+			
+			frame_header t_header{ };
+			auto t_pos = read_header(t_begin, p_len, t_header);
+			
+			if(t_pos == 0)
+				return false;
+				
+			const ::std::size_t t_checksum = (t_header.m_Flags & flag_block_checksum) ? 4 : 0;
+			
+			// Only the block headers are read, so that skipping a frame costs a few reads per block
+			while(true)
+			{
+				if(p_len - t_pos < 4)
+					return false;
+					
+				const auto t_size = read32_le(t_begin + t_pos);
+				t_pos += 4;
+				
+				if(t_size == 0)
+					break;
+					
+				const auto t_len = static_cast<::std::size_t>(t_size & ~block_uncompressed);
+				
+				if(t_len > t_header.m_BlockSize)
+					throw ::std::runtime_error("lz_codec: Block exceeds maximum size");
+					
+				if(p_len - t_pos < t_len + t_checksum)
+					return false;
+					
+				t_pos += t_len + t_checksum;
+			}
+			
+			if(t_header.m_Flags & flag_content_checksum)
+			{
+				if(p_len - t_pos < 4)
+					return false;
+					
+				t_pos += 4;
+			}
+			
+			p_info.m_Size = t_pos;
+			p_info.m_HasContentSize = (t_header.m_Flags & flag_content_size) != 0;
+			p_info.m_ContentSize = t_header.m_ContentSize;
+			return true;
+		}
+	}
+}
@@ -0,0 +1,144 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <utility>
+#include <algorithm>
+
+#include "message_buffer.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		message_buffer::message_buffer(message_buffer&& p_other)
+			:	m_Size{p_other.m_Size},
+				m_Capacity{p_other.m_Capacity},
+				m_Heap{p_other.m_Heap},
+				m_UseArena{p_other.m_UseArena}
+		{
+			// Only the used part of the inline storage is copied
+			if(!m_Heap.m_Data)
+				::std::char_traits<char>::copy(m_Inline, p_other.m_Inline, m_Size);
+				
+			p_other.m_Size = 0;
+			p_other.m_Capacity = LIBLOG_INLINE_MESSAGE_SIZE;
+			p_other.m_Heap = arena_block{ };
+		}
+		
+		message_buffer& message_buffer::operator=(message_buffer&& p_other)
+		{
+			if(this != &p_other)
+			{
+				release();
+			
+				m_Size = p_other.m_Size;
+				m_Capacity = p_other.m_Capacity;
+				m_Heap = p_other.m_Heap;
+				m_UseArena = p_other.m_UseArena;
+				
+				if(!m_Heap.m_Data)
+					::std::char_traits<char>::copy(m_Inline, p_other.m_Inline, m_Size);
+					
+				p_other.m_Size = 0;
+				p_other.m_Capacity = LIBLOG_INLINE_MESSAGE_SIZE;
+				p_other.m_Heap = arena_block{ };
+			}
+			
+			return *this;
+		}
+		
+		message_buffer::~message_buffer()
+		{
+			release();
+		}
+		
+		void message_buffer::grow(::std::size_t p_required)
+		{
+			const auto t_capacity = ::std::max(p_required, m_Capacity * 2);
+			
+			arena_block t_heap{ };
+			
+			if(m_UseArena)
+				t_heap = arena_allocate(t_capacity);
+			else t_heap.m_Data = new char[t_capacity];
+			
+			::std::char_traits<char>::copy(t_heap.m_Data, data(), m_Size);
+			
+			release();
+			m_Heap = t_heap;
+			m_Capacity = t_capacity;
+		}
+		
+		void message_buffer::release()
+		{
+			if(m_Heap.m_Data)
+			{
+				arena_release(m_Heap);
+				m_Heap = arena_block{ };
+			}
+		}
+		
+		void message_buffer::insert(::std::size_t p_pos, const char* p_str, ::std::size_t p_len)
+		{
+			p_pos = ::std::min(p_pos, m_Size);
+		
+			if(m_Size + p_len > m_Capacity)
+				grow(m_Size + p_len);
+				
+			auto t_data = data();
+			
+			::std::char_traits<char>::move(t_data + p_pos + p_len, t_data + p_pos, m_Size - p_pos);
+			::std::char_traits<char>::copy(t_data + p_pos, p_str, p_len);
+			m_Size += p_len;
+		}
+	
+		namespace
+		{
+			// Per-thread stream state. Constructing a std::ostream is expensive,
+			// so it is only done once per thread.
+			struct local_stream
+			{
+				local_stream()
+					: m_Stream{&m_Buffer}
+				{
+				}
+			
+				message_streambuf m_Buffer;
+				::std::ostream m_Stream;
+			};
+		}
+		
+		auto message_stream(message_buffer& p_buffer, bool p_reset)
+			-> ::std::ostream&
+		{
+			thread_local local_stream t_stream{ };
+			
+			t_stream.m_Buffer.attach(&p_buffer);
+			
+			if(p_reset)
+			{
+				auto& t_str = t_stream.m_Stream;
+				
+				t_str.clear();
+				t_str.flags(::std::ios_base::dec | ::std::ios_base::skipws);
+				t_str.width(0);
+				t_str.precision(6);
+				t_str.fill(' ');
+			}
+			
+			return t_stream.m_Stream;
+		}
+	}
+}
@@ -0,0 +1,310 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#if !defined(_WIN32)
+
+#include <vector>
+#include <utility>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <ut/throwf.hxx>
+
+#include "mmap_file_target.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		namespace
+		{
+			// Split path into directory and file name
+			auto split_path(const ::std::string& p_path)
+				-> ::std::pair<::std::string, ::std::string>
+			{
+				const auto t_pos = p_path.find_last_of('/');
+				
+				if(t_pos == ::std::string::npos)
+					return { ".", p_path };
+				else return { (t_pos == 0) ? "/" : p_path.substr(0, t_pos), p_path.substr(t_pos + 1) };
+			}
+			
+			// Find all existing segment files belonging to given base path, sorted by index
+			auto find_segments(const ::std::string& p_path)
+				-> ::std::vector<::std::pair<::std::uint64_t, ::std::string>>
+			{
+				const auto t_split = split_path(p_path);
+				const auto t_prefix = t_split.second + ".";
+				
+				::std::vector<::std::pair<::std::uint64_t, ::std::string>> t_segments{ };
+				
+				DIR* t_dir = ::opendir(t_split.first.c_str());
+				
+				if(t_dir == nullptr)
+					return t_segments;
+					
+				while(dirent* t_ent = ::readdir(t_dir))
+				{
+					const ::std::string t_name{ t_ent->d_name };
+					
+					if(t_name.size() <= t_prefix.size() || t_name.compare(0, t_prefix.size(), t_prefix) != 0)
+						continue;
+						
+					const auto t_suffix = t_name.substr(t_prefix.size());
+					
+					if(!::std::all_of(t_suffix.begin(), t_suffix.end(), [](char c){ return c >= '0' && c <= '9'; }))
+						continue;
+						
+					t_segments.emplace_back(::std::strtoull(t_suffix.c_str(), nullptr, 10), t_split.first + "/" + t_name);
+				}
+				
+				::closedir(t_dir);
+				
+				::std::sort(t_segments.begin(), t_segments.end());
+				return t_segments;
+			}
+			
+			auto page_size()
+				-> ::std::size_t
+			{
+				static const ::std::size_t t_size = static_cast<::std::size_t>(::sysconf(_SC_PAGESIZE));
+				return t_size;
+			}
+		}
+	
+		mmap_writer::mmap_writer(const ::std::string& p_path, const mmap_file_options& p_options)
+			: m_Path{p_path}, m_Options{p_options}
+		{
+			// Continue numbering after the newest existing segment
+			const auto t_segments = find_segments(m_Path);
+			
+			if(!t_segments.empty())
+				m_Index = t_segments.back().first + 1;
+		
+			if(!open_segment(m_Options.m_SegmentSize))
+			{
+				ut::throwf<::std::runtime_error>(
+					"mmap_file_target: Failed to create segment file \"%s\"",
+					segment_path(m_Index)
+				);
+			}
+			
+			apply_retention();
+			
+			m_Worker = ::std::thread{ &mmap_writer::do_sync, this };
+		}
+		
+		mmap_writer::~mmap_writer()
+		{
+			{
+				::std::lock_guard<::std::mutex> lck(m_Mtx);
+				m_ShouldStop = true;
+			}
+			
+			m_Cv.notify_one();
+			m_Worker.join();
+			
+			close_segment();
+		}
+		
+		auto mmap_writer::append(const char* p_data, ::std::size_t p_len)
+			-> void
+		{
+			::std::lock_guard<::std::mutex> lck(m_Mtx);
+			
+			const bool t_full = (m_Offset + p_len > m_Size);
+			const bool t_expired = m_Options.m_Interval.count() > 0
+								&& (::std::chrono::steady_clock::now() - m_Opened) >= m_Options.m_Interval;
+			
+			if(m_Map == nullptr || t_full || (t_expired && m_Offset > 0))
+				rotate(p_len);
+				
+			if(m_Map == nullptr)
+			{
+				m_Discarded.fetch_add(p_len, ::std::memory_order_relaxed);
+				return;
+			}
+			
+			::std::memcpy(m_Map + m_Offset, p_data, p_len);
+			m_Offset += p_len;
+		}
+		
+		auto mmap_writer::sync()
+			-> void
+		{
+			::std::lock_guard<::std::mutex> lck(m_Mtx);
+			
+			// Previous segments were already synced when they were closed
+			if(m_Map != nullptr && m_Offset > 0)
+				::msync(m_Map, m_Offset, MS_SYNC);
+		}
+		
+		auto mmap_writer::rotate(::std::size_t p_minSize)
+			-> void
+		{
+			close_segment();
+			
+			++m_Index;
+			open_segment(::std::max(p_minSize, m_Options.m_SegmentSize));
+			
+			apply_retention();
+		}
+		
+		auto mmap_writer::open_segment(::std::size_t p_size)
+			-> bool
+		{
+			const auto t_path = segment_path(m_Index);
+		
+			m_Fd = ::open(t_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+			
+			if(m_Fd < 0)
+				return false;
+				
+			// Reserve all blocks up front, so that writing into the mapping can not fail later on
+#if defined(__linux__)
+			const bool t_allocated = (::posix_fallocate(m_Fd, 0, static_cast<off_t>(p_size)) == 0);
+#else
+			const bool t_allocated = (::ftruncate(m_Fd, static_cast<off_t>(p_size)) == 0);
+#endif
+
+			void* t_map = t_allocated ? ::mmap(nullptr, p_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_Fd, 0) : MAP_FAILED;
+			
+			if(t_map == MAP_FAILED)
+			{
+				::close(m_Fd);
+				::unlink(t_path.c_str());
+				m_Fd = -1;
+				return false;
+			}
+			
+			m_Map = static_cast<char*>(t_map);
+			m_Size = p_size;
+			m_Offset = 0;
+			m_Synced = 0;
+			m_Opened = ::std::chrono::steady_clock::now();
+			
+			return true;
+		}
+		
+		auto mmap_writer::close_segment()
+			-> void
+		{
+			if(m_Map != nullptr)
+			{
+				::msync(m_Map, m_Size, MS_ASYNC);
+				::munmap(m_Map, m_Size);
+				m_Map = nullptr;
+			}
+		
+			if(m_Fd >= 0)
+			{
+				// Cut off the preallocated space that was never used
+				if(::ftruncate(m_Fd, static_cast<off_t>(m_Offset)) != 0)
+				{
+					// Nothing sensible to do here. The segment just keeps trailing zero bytes.
+				}
+				
+				// Most of the data was already written back by the background thread. This makes
+				// sure that a later sync also covers the contents of all previous segments.
+				::fsync(m_Fd);
+			
+				::close(m_Fd);
+				m_Fd = -1;
+			}
+		}
+		
+		auto mmap_writer::apply_retention()
+			-> void
+		{
+			if(m_Options.m_MaxFiles == 0 && m_Options.m_MaxTotalBytes == 0)
+				return;
+				
+			auto t_segments = find_segments(m_Path);
+			
+			::std::vector<::std::uint64_t> t_sizes{ };
+			::std::uint64_t t_total{ };
+			
+			for(const auto& t_segment : t_segments)
+			{
+				struct stat t_stat{ };
+				const auto t_size = (::stat(t_segment.second.c_str(), &t_stat) == 0) ? static_cast<::std::uint64_t>(t_stat.st_size) : 0u;
+				
+				t_sizes.push_back(t_size);
+				t_total += t_size;
+			}
+			
+			// Remove oldest segments first, but never the one currently written to
+			for(::std::size_t t_i = 0; t_i < t_segments.size() && t_segments[t_i].first != m_Index; ++t_i)
+			{
+				const auto t_count = t_segments.size() - t_i;
+				
+				const bool t_tooMany = m_Options.m_MaxFiles > 0 && t_count > m_Options.m_MaxFiles;
+				const bool t_tooBig = m_Options.m_MaxTotalBytes > 0 && t_total > m_Options.m_MaxTotalBytes;
+				
+				if(!t_tooMany && !t_tooBig)
+					break;
+					
+				::unlink(t_segments[t_i].second.c_str());
+				t_total -= t_sizes[t_i];
+			}
+		}
+		
+		auto mmap_writer::segment_path(::std::uint64_t p_index) const
+			-> ::std::string
+		{
+			char t_suffix[24];
+			::std::snprintf(t_suffix, sizeof(t_suffix), ".%06llu", static_cast<unsigned long long>(p_index));
+			
+			return m_Path + t_suffix;
+		}
+		
+		auto mmap_writer::do_sync()
+			-> void
+		{
+			::std::unique_lock<::std::mutex> lck(m_Mtx);
+			
+			while(!m_ShouldStop)
+			{
+				m_Cv.wait_for(lck, m_Options.m_SyncInterval);
+				
+				if(m_Map == nullptr || m_Offset <= m_Synced)
+					continue;
+					
+				// Start writeback of everything written since the last run
+				const auto t_begin = m_Synced & ~(page_size() - 1);
+				::msync(m_Map + t_begin, m_Offset - t_begin, MS_ASYNC);
+				
+				// Pages that are completely written are never touched again. Drop them
+				// from this process, the data stays in the page cache.
+				const auto t_end = m_Offset & ~(page_size() - 1);
+				
+				if(t_end > t_begin)
+				{
+					::madvise(m_Map + t_begin, t_end - t_begin, MADV_DONTNEED);
+					m_Synced = t_end;
+				}
+			}
+		}
+	}
+}
+
+#endif
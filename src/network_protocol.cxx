@@ -0,0 +1,270 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <ut/cast.hxx>
+
+#include "network_protocol.hxx"
+#include "lz_codec.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		namespace
+		{
+			template< typename T >
+			auto append_be(::std::string& p_out, T p_val)
+				-> void
+			{
+				for(::std::size_t t_i = sizeof(T); t_i > 0; --t_i)
+					p_out.push_back(static_cast<char>((p_val >> ((t_i - 1) * 8)) & 0xFF));
+			}
+			
+			// The string length fields are only 1 byte wide, so strings need to be truncated
+			auto truncated_length(::std::size_t p_len)
+				-> ::std::size_t
+			{
+				return ::std::min<::std::size_t>(p_len, ::std::numeric_limits<::std::uint8_t>::max());
+			}
+		}
+	
+		auto encode_packet(::std::string& p_out, const log_entry& p_entry, const ::std::string& p_src)
+			-> void
+		{
+			const auto t_msg = p_entry.message_view();
+		
+			const ::std::size_t t_szStr = truncated_length(t_msg.length());
+			const ::std::size_t t_szSrc = truncated_length(p_src.length());
+			const ::std::size_t t_szTag = truncated_length(p_entry.tag().length());
+			
+			p_out.reserve(p_out.size() + packet_header_size + t_szStr + t_szSrc + t_szTag);
+			
+			append_be<::std::uint8_t>(p_out, t_szStr);
+			append_be<::std::uint8_t>(p_out, t_szSrc);
+			append_be<::std::uint8_t>(p_out, t_szTag);
+			append_be<::std::uint8_t>(p_out, ut::enum_cast(p_entry.level()));
+			append_be<::std::uint8_t>(p_out, (p_entry.bare() ? 1u : 0u));
+			append_be<::std::uint64_t>(p_out, p_entry.time());
+			
+			p_out.append(t_msg.data(), t_szStr);
+			p_out.append(p_src.data(), t_szSrc);
+			p_out.append(p_entry.tag().data(), t_szTag);
+		}
+		
+		auto append_varint(::std::string& p_out, ::std::uint64_t p_val)
+			-> void
+		{
+			while(p_val >= 0x80)
+			{
+				p_out.push_back(static_cast<char>((p_val & 0x7F) | 0x80));
+				p_val >>= 7;
+			}
+			
+			p_out.push_back(static_cast<char>(p_val));
+		}
+		
+		namespace
+		{
+			auto append_string(::std::string& p_out, const char* p_str, ::std::size_t p_len)
+				-> void
+			{
+				append_varint(p_out, p_len);
+				p_out.append(p_str, p_len);
+			}
+			
+			auto zigzag(::std::int64_t p_val)
+				-> ::std::uint64_t
+			{
+				return (static_cast<::std::uint64_t>(p_val) << 1) ^ static_cast<::std::uint64_t>(p_val >> 63);
+			}
+		}
+		
+		protocol_encoder::protocol_encoder(const ::std::string& p_src, const protocol_options& p_options)
+			: m_Src{p_src}, m_Options{p_options}
+		{
+		}
+		
+		auto protocol_encoder::encode(::std::string& p_out, entry_span p_entries, ::std::vector<frame_info>& p_frames)
+			-> void
+		{
+			if(m_Options.m_Version == protocol_version::v1)
+			{
+				for(const auto& t_entry : p_entries)
+				{
+					encode_packet(p_out, t_entry, m_Src);
+					p_frames.push_back(frame_info{ p_out.size(), 1 });
+				}
+				
+				return;
+			}
+			
+			for(const auto& t_entry : p_entries)
+			{
+				encode_record(t_entry);
+				
+				if(m_Payload.size() >= m_Options.m_MaxFrameSize)
+					finish_frame(p_out, p_frames);
+			}
+			
+			finish_frame(p_out, p_frames);
+		}
+		
+		auto protocol_encoder::encode_record(const log_entry& p_entry)
+			-> void
+		{
+			const auto t_msg = p_entry.message_view();
+			const auto t_time = p_entry.time_point().nanoseconds();
+			const auto* t_file = p_entry.file();
+			
+			const auto t_tag = p_entry.tag_index();
+			
+			if(m_TagSlots.size() <= t_tag)
+				m_TagSlots.resize(static_cast<::std::size_t>(t_tag) + 1, 0u);
+				
+			// Every tag is sent inline once per frame, so that frames can be decoded on their own
+			const auto t_slot = m_TagSlots[t_tag];
+			
+			m_Payload.push_back(static_cast<char>(ut::enum_cast(p_entry.level())));
+			m_Payload.push_back(static_cast<char>((p_entry.bare() ? record_flag_bare : 0u) | (p_entry.fields().empty() ? 0u : record_flag_fields) | (t_slot != 0 ? record_flag_tag_ref : 0u)));
+			
+			// Records of one frame are usually close in time, which makes the difference a lot shorter
+			append_varint(m_Payload, (m_Records == 0) ? static_cast<::std::uint64_t>(t_time) : zigzag(t_time - m_LastTime));
+			append_varint(m_Payload, p_entry.thread_id());
+			append_varint(m_Payload, p_entry.line());
+			
+			append_string(m_Payload, t_file, ::std::char_traits<char>::length(t_file));
+			
+			if(t_slot != 0)
+				append_varint(m_Payload, t_slot - 1);
+			else
+			{
+				append_string(m_Payload, p_entry.tag().data(), p_entry.tag().length());
+				
+				if(t_tag != 0)
+				{
+					m_FrameTags.push_back(t_tag);
+					m_TagSlots[t_tag] = static_cast<::std::uint32_t>(m_FrameTags.size());
+				}
+			}
+			
+			append_string(m_Payload, t_msg.data(), t_msg.length());
+			
+			if(!p_entry.fields().empty())
+				encode_fields(p_entry);
+			
+			m_LastTime = t_time;
+			++m_Records;
+		}
+		
+		auto protocol_encoder::encode_fields(const log_entry& p_entry)
+			-> void
+		{
+			append_varint(m_Payload, p_entry.fields().size());
+			
+			// Values are copied in their binary form, they are never converted to text
+			for(const auto& t_field : p_entry.fields())
+			{
+				const auto t_key = t_field.key();
+			
+				m_Payload.push_back(static_cast<char>(t_field.type()));
+				append_string(m_Payload, t_key.data(), t_key.length());
+				
+				switch(t_field.type())
+				{
+					case field_type::boolean:
+						m_Payload.push_back(static_cast<char>(t_field.as_bool() ? 1 : 0));
+						break;
+						
+					case field_type::signed_integer:
+						append_varint(m_Payload, zigzag(t_field.as_signed()));
+						break;
+						
+					case field_type::unsigned_integer:
+						append_varint(m_Payload, t_field.as_unsigned());
+						break;
+						
+					case field_type::floating_point:
+					{
+						const auto t_val = t_field.as_double();
+						::std::uint64_t t_bits;
+						::std::memcpy(&t_bits, &t_val, sizeof(t_bits));
+						append_be<::std::uint64_t>(m_Payload, t_bits);
+						break;
+					}
+						
+					case field_type::string:
+					{
+						const auto t_val = t_field.as_string();
+						append_string(m_Payload, t_val.data(), t_val.length());
+						break;
+					}
+				}
+			}
+		}
+		
+		auto protocol_encoder::finish_frame(::std::string& p_out, ::std::vector<frame_info>& p_frames)
+			-> void
+		{
+			if(m_Records == 0)
+				return;
+				
+			// Only send compressed payload if it actually is smaller
+			bool t_compressed{false};
+			
+			if(m_Options.m_Compress)
+			{
+				m_Compressed.clear();
+				lz_compress(m_Payload.data(), m_Payload.size(), m_Compressed);
+				
+				t_compressed = m_Compressed.size() < m_Payload.size();
+			}
+			
+			const auto& t_payload = t_compressed ? m_Compressed : m_Payload;
+				
+			const auto t_begin = p_out.size();
+			
+			p_out.push_back(static_cast<char>(frame_magic_0));
+			p_out.push_back(static_cast<char>(frame_magic_1));
+			p_out.push_back(static_cast<char>(ut::enum_cast(protocol_version::v2)));
+			p_out.push_back(static_cast<char>(t_compressed ? frame_flag_compressed : 0u));
+			append_be<::std::uint32_t>(p_out, 0u);	// Length is filled in below
+			
+			append_varint(p_out, m_Records);
+			append_varint(p_out, m_Payload.size());
+			append_string(p_out, m_Src.data(), m_Src.length());
+			p_out.append(t_payload);
+			
+			// Fill in length of the remaining frame
+			const auto t_length = p_out.size() - t_begin - frame_header_size;
+			
+			for(::std::size_t t_i = 0; t_i < 4; ++t_i)
+				p_out[t_begin + 4 + t_i] = static_cast<char>((t_length >> ((3 - t_i) * 8)) & 0xFF);
+			
+			p_frames.push_back(frame_info{ p_out.size(), m_Records });
+			
+			m_Payload.clear();
+			m_Records = 0;
+			
+			for(const auto t_tag : m_FrameTags)
+				m_TagSlots[t_tag] = 0u;
+				
+			m_FrameTags.clear();
+			m_LastTime = 0;
+		}
+	}
+}
@@ -1,12 +1,7 @@
 #define ASIO_STANDALONE 1
 
-#include <limits>
-#include <cstdint>
-#include <sstream>
 #include <stdexcept>
 #include <ut/throwf.hxx>
-#include <ut/cast.hxx>
-#include <ut/utility.hxx>
 #include <asio.hpp>
 
 #include <network_target.hxx>
@@ -39,8 +34,8 @@ namespace lg
 	}
 
 
-	network_target::network_target(severity_level p_lvl, const ::std::string& p_host, const ::std::string& p_port, const ::std::string& p_src)
-		: log_target(p_lvl), m_Host{p_host}, m_Port{p_port}, m_Src{p_src}, m_InternalData{ new network_target_data() }
+	network_target::network_target(severity_level p_lvl, const ::std::string& p_host, const ::std::string& p_port, const ::std::string& p_src, const protocol_options& p_protocol)
+		: log_target(p_lvl), m_Host{p_host}, m_Port{p_port}, m_Src{p_src}, m_InternalData{ new network_target_data() }, m_Encoder{p_src, p_protocol}
 	{
 		connect();
 	}
@@ -88,45 +83,18 @@ namespace lg
 
 	void network_target::write(const log_entry& p_entry)
 	{
-		// Calculate size of packet
-		
-		// The string length field is only 1 byte wide, so we need
-		// to truncate the message if needed
-		const ::std::size_t t_szStr = ::std::min<::std::size_t>(
-			p_entry.message().length(),
-			::std::numeric_limits<::std::uint8_t>::max()
-		);
-
-		const ::std::size_t t_szSrc = ::std::min<::std::size_t>(
-			m_Src.length(),
-			::std::numeric_limits<::std::uint8_t>::max()
-		);
-		
-		const ::std::size_t t_szTag = ::std::min<::std::size_t>(
-			p_entry.tag().length(),
-			::std::numeric_limits<::std::uint8_t>::max()
-		);
-
-		const ::std::size_t t_szFixed = 13; // Fixed part of packet
-		const ::std::size_t t_sz = t_szStr + t_szSrc + t_szTag + t_szFixed;
-
-		// Create buffer for packet
-		::std::ostringstream t_stream{};
-
-		// Write data
-		ut::to_bytes_be<::std::uint8_t>(t_stream, t_szStr);
-		ut::to_bytes_be<::std::uint8_t>(t_stream, t_szSrc);
-		ut::to_bytes_be<::std::uint8_t>(t_stream, t_szTag);
-		ut::to_bytes_be<::std::uint8_t>(t_stream, ut::enum_cast(p_entry.level()));
-		ut::to_bytes_be<::std::uint8_t>(t_stream, (p_entry.bare() ? 1u : 0u));
-		ut::to_bytes_be<::std::uint64_t>(t_stream, p_entry.time());
+		const log_entry* t_entry = &p_entry;
+		write_batch(entry_span{ &t_entry, 1 });
+	}
+	
+	void network_target::write_batch(entry_span p_entries)
+	{
+		m_Packet.clear();
+		m_Frames.clear();
 		
-		t_stream.write(p_entry.message().data(), t_szStr);
-		t_stream.write(m_Src.data(), t_szSrc);
-		t_stream.write(p_entry.tag().data(), t_szTag);
-
-		const auto t_result = t_stream.str();
+		m_Encoder.encode(m_Packet, p_entries, m_Frames);
 
-		cast(m_InternalData)->m_Socket.write_some(asio::buffer(t_result.data(), t_sz));
+		// asio::write loops until everything was sent, so short writes are not an issue
+		asio::write(cast(m_InternalData)->m_Socket, asio::buffer(m_Packet.data(), m_Packet.size()));
 	}
 }
@@ -0,0 +1,248 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <array>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "pattern_formatter.hxx"
+#include "field.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		namespace
+		{
+			struct text_constant
+			{
+				const char* m_Data;
+				::std::size_t m_Length;
+			};
+			
+			// Indexed by severity level
+			constexpr ::std::array<text_constant, 5> g_paddedLevels =
+			{{
+				{ "  Fatal", 7 },
+				{ "  Error", 7 },
+				{ "Warning", 7 },
+				{ "   Info", 7 },
+				{ "  Debug", 7 }
+			}};
+			
+			constexpr ::std::array<text_constant, 5> g_lowerLevels =
+			{{
+				{ "fatal", 5 },
+				{ "error", 5 },
+				{ "warning", 7 },
+				{ "info", 4 },
+				{ "debug", 5 }
+			}};
+			
+			constexpr text_constant g_resetSequence{ "\x1b[0m", 4 };
+			
+			auto color_sequence(ut::console_color p_clr)
+				-> text_constant
+			{
+				using ut::console_color;
+			
+				switch(p_clr)
+				{
+					case console_color::black:			return { "\x1b[30m", 5 };
+					case console_color::red:			return { "\x1b[31m", 5 };
+					case console_color::green:			return { "\x1b[32m", 5 };
+					case console_color::yellow:			return { "\x1b[33m", 5 };
+					case console_color::blue:			return { "\x1b[34m", 5 };
+					case console_color::magenta:		return { "\x1b[35m", 5 };
+					case console_color::cyan:			return { "\x1b[36m", 5 };
+					case console_color::white:			return { "\x1b[37m", 5 };
+					case console_color::bright_black:	return { "\x1b[90m", 5 };
+					case console_color::bright_red:		return { "\x1b[91m", 5 };
+					case console_color::bright_green:	return { "\x1b[92m", 5 };
+					case console_color::bright_yellow:	return { "\x1b[93m", 5 };
+					case console_color::bright_blue:	return { "\x1b[94m", 5 };
+					case console_color::bright_magenta:	return { "\x1b[95m", 5 };
+					case console_color::bright_cyan:	return { "\x1b[96m", 5 };
+					case console_color::bright_white:	return { "\x1b[97m", 5 };
+					default:							return g_resetSequence;
+				}
+			}
+			
+			auto level_index(severity_level p_lvl)
+				-> ::std::size_t
+			{
+				const auto t_index = static_cast<::std::size_t>(p_lvl);
+				return t_index < g_paddedLevels.size() ? t_index : g_paddedLevels.size() - 1;
+			}
+		}
+		
+		auto padded_level_string(severity_level p_lvl)
+			-> ut::string_view
+		{
+			const auto& t_str = g_paddedLevels[level_index(p_lvl)];
+			return ut::string_view{ t_str.m_Data, t_str.m_Length };
+		}
+		
+		auto lower_level_string(severity_level p_lvl)
+			-> ut::string_view
+		{
+			const auto& t_str = g_lowerLevels[level_index(p_lvl)];
+			return ut::string_view{ t_str.m_Data, t_str.m_Length };
+		}
+	
+		auto text_buffer::raw(const char* p_str, ::std::size_t p_len)
+			-> void
+		{
+			m_Visible += p_len;
+		
+			// Long text is handed to the stream directly instead of being copied piecewise
+			if(p_len > sizeof(m_Buffer))
+			{
+				flush();
+				m_Str.write(p_str, static_cast<::std::streamsize>(p_len));
+				return;
+			}
+			
+			::std::memcpy(reserve(p_len), p_str, p_len);
+			m_Pos += p_len;
+		}
+		
+		auto text_buffer::escape(const char* p_str, ::std::size_t p_len)
+			-> void
+		{
+			::std::memcpy(reserve(p_len), p_str, p_len);
+			m_Pos += p_len;
+		}
+		
+		auto text_buffer::fill(char p_chr, ::std::size_t p_count)
+			-> void
+		{
+			while(p_count > 0)
+			{
+				const auto t_len = ::std::min(p_count, sizeof(m_Buffer));
+				::std::memset(reserve(t_len), p_chr, t_len);
+				m_Pos += t_len;
+				m_Visible += t_len;
+				p_count -= t_len;
+			}
+		}
+		
+		auto text_buffer::number(::std::uint64_t p_val)
+			-> void
+		{
+			char t_digits[20];
+			::std::size_t t_len{0};
+			
+			do
+			{
+				t_digits[sizeof(t_digits) - ++t_len] = static_cast<char>('0' + p_val % 10);
+				p_val /= 10;
+			}
+			while(p_val != 0);
+			
+			raw(t_digits + sizeof(t_digits) - t_len, t_len);
+		}
+		
+		auto text_buffer::time(timestamp p_time, time_precision p_precision)
+			-> void
+		{
+			char t_buffer[time_buffer_size];
+			raw(t_buffer, format_time(p_time, p_precision, t_buffer));
+		}
+		
+		auto text_buffer::color(ut::console_color p_clr)
+			-> void
+		{
+			const auto t_seq = color_sequence(p_clr);
+			escape(t_seq.m_Data, t_seq.m_Length);
+		}
+		
+		auto text_buffer::reset_color()
+			-> void
+		{
+			escape(g_resetSequence.m_Data, g_resetSequence.m_Length);
+		}
+		
+		auto text_buffer::fields(const log_entry& p_entry)
+			-> void
+		{
+			for(const auto& t_field : p_entry.fields())
+			{
+				raw(' ');
+				raw(t_field.key());
+				raw('=');
+				
+				switch(t_field.type())
+				{
+					case field_type::boolean:
+						if(t_field.as_bool())
+							raw("true", 4);
+						else raw("false", 5);
+						break;
+						
+					case field_type::signed_integer:
+					{
+						const auto t_val = t_field.as_signed();
+						
+						if(t_val < 0)
+						{
+							raw('-');
+							number(static_cast<::std::uint64_t>(0) - static_cast<::std::uint64_t>(t_val));
+						}
+						else number(static_cast<::std::uint64_t>(t_val));
+						break;
+					}
+						
+					case field_type::unsigned_integer:
+						number(t_field.as_unsigned());
+						break;
+						
+					case field_type::floating_point:
+					{
+						// Same representation as the default stream formatting
+						char t_buffer[32];
+						const auto t_len = ::std::snprintf(t_buffer, sizeof(t_buffer), "%g", t_field.as_double());
+						raw(t_buffer, static_cast<::std::size_t>(t_len));
+						break;
+					}
+						
+					case field_type::string:
+						raw(t_field.as_string());
+						break;
+				}
+			}
+		}
+		
+		auto text_buffer::flush()
+			-> void
+		{
+			if(m_Pos > 0)
+			{
+				m_Str.write(m_Buffer, static_cast<::std::streamsize>(m_Pos));
+				m_Pos = 0;
+			}
+		}
+		
+		auto text_buffer::reserve(::std::size_t p_len)
+			-> char*
+		{
+			if(m_Pos + p_len > sizeof(m_Buffer))
+				flush();
+				
+			return m_Buffer + m_Pos;
+		}
+	}
+}
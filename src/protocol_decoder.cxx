@@ -0,0 +1,354 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <cstring>
+
+#include "protocol_decoder.hxx"
+#include "lz_codec.hxx"
+
+namespace lg
+{
+	namespace
+	{
+		// Bounds checked reading from a byte range
+		class reader
+		{
+			public:
+				reader(const char* p_begin, const char* p_end)
+					: m_Cur{p_begin}, m_End{p_end}
+				{
+				}
+				
+			public:
+				auto remaining() const
+					-> ::std::size_t
+				{
+					return static_cast<::std::size_t>(m_End - m_Cur);
+				}
+				
+				auto position() const
+					-> const char*
+				{
+					return m_Cur;
+				}
+			
+				auto read_u8()
+					-> ::std::uint8_t
+				{
+					require(1);
+					return static_cast<::std::uint8_t>(*m_Cur++);
+				}
+				
+				template< typename T >
+				auto read_be()
+					-> T
+				{
+					T t_val{ };
+					
+					for(::std::size_t t_i = 0; t_i < sizeof(T); ++t_i)
+						t_val = static_cast<T>((t_val << 8) | read_u8());
+						
+					return t_val;
+				}
+				
+				auto read_varint()
+					-> ::std::uint64_t
+				{
+					::std::uint64_t t_val{0};
+					
+					for(unsigned t_shift = 0; t_shift < 64; t_shift += 7)
+					{
+						const auto t_byte = read_u8();
+						t_val |= static_cast<::std::uint64_t>(t_byte & 0x7F) << t_shift;
+						
+						if((t_byte & 0x80) == 0)
+							return t_val;
+					}
+					
+					throw ::std::runtime_error("protocol_decoder: Malformed varint");
+				}
+				
+				auto read_string(::std::size_t p_len)
+					-> ::std::string
+				{
+					require(p_len);
+					
+					::std::string t_str(m_Cur, p_len);
+					m_Cur += p_len;
+					return t_str;
+				}
+				
+				auto read_string()
+					-> ::std::string
+				{
+					return read_string(static_cast<::std::size_t>(read_varint()));
+				}
+				
+			private:
+				auto require(::std::size_t p_len)
+					-> void
+				{
+					if(remaining() < p_len)
+						throw ::std::runtime_error("protocol_decoder: Unexpected end of data");
+				}
+				
+			private:
+				const char* m_Cur;
+				const char* m_End;
+		};
+		
+		auto to_level(::std::uint8_t p_val)
+			-> severity_level
+		{
+			if(p_val > static_cast<::std::uint8_t>(severity_level::debug))
+				throw ::std::runtime_error("protocol_decoder: Invalid severity level");
+				
+			return static_cast<severity_level>(p_val);
+		}
+		
+		auto unzigzag(::std::uint64_t p_val)
+			-> ::std::int64_t
+		{
+			return static_cast<::std::int64_t>(p_val >> 1) ^ -static_cast<::std::int64_t>(p_val & 1);
+		}
+		
+		auto read_fields(reader& p_reader, ::std::vector<decoded_field>& p_fields)
+			-> void
+		{
+			const auto t_count = p_reader.read_varint();
+			
+			for(::std::uint64_t t_i = 0; t_i < t_count; ++t_i)
+			{
+				decoded_field t_field{ };
+				
+				const auto t_type = p_reader.read_u8();
+				
+				if(t_type > static_cast<::std::uint8_t>(field_type::string))
+					throw ::std::runtime_error("protocol_decoder: Invalid field type");
+					
+				t_field.m_Type = static_cast<field_type>(t_type);
+				t_field.m_Key = p_reader.read_string();
+				
+				switch(t_field.m_Type)
+				{
+					case field_type::boolean:
+						t_field.m_Bool = (p_reader.read_u8() != 0);
+						break;
+						
+					case field_type::signed_integer:
+						t_field.m_Signed = unzigzag(p_reader.read_varint());
+						break;
+						
+					case field_type::unsigned_integer:
+						t_field.m_Unsigned = p_reader.read_varint();
+						break;
+						
+					case field_type::floating_point:
+					{
+						const auto t_bits = p_reader.read_be<::std::uint64_t>();
+						::std::memcpy(&t_field.m_Double, &t_bits, sizeof(t_bits));
+						break;
+					}
+						
+					case field_type::string:
+						t_field.m_String = p_reader.read_string();
+						break;
+				}
+				
+				p_fields.push_back(::std::move(t_field));
+			}
+		}
+	}
+
+	protocol_decoder::protocol_decoder(protocol_version p_version)
+		: m_Version{p_version}
+	{
+	}
+	
+	auto protocol_decoder::feed(const char* p_data, ::std::size_t p_len)
+		-> void
+	{
+		// Drop data that was already decoded before the buffer grows
+		if(m_Offset > 0)
+		{
+			m_Buffer.erase(0, m_Offset);
+			m_Offset = 0;
+		}
+		
+		m_Buffer.append(p_data, p_len);
+	}
+	
+	auto protocol_decoder::next(decoded_record& p_record)
+		-> bool
+	{
+		while(m_Records.empty())
+		{
+			const bool t_decoded = (m_Version == protocol_version::v1) ? decode_packet() : decode_frame();
+			
+			if(!t_decoded)
+				return false;
+		}
+		
+		p_record = ::std::move(m_Records.front());
+		m_Records.pop_front();
+		return true;
+	}
+	
+	auto protocol_decoder::pending() const
+		-> ::std::size_t
+	{
+		return m_Buffer.size() - m_Offset;
+	}
+	
+	auto protocol_decoder::decode_packet()
+		-> bool
+	{
+		if(pending() < internal::packet_header_size)
+			return false;
+			
+		reader t_reader{ m_Buffer.data() + m_Offset, m_Buffer.data() + m_Buffer.size() };
+		
+		const auto t_szStr = t_reader.read_u8();
+		const auto t_szSrc = t_reader.read_u8();
+		const auto t_szTag = t_reader.read_u8();
+		
+		if(pending() < internal::packet_header_size + t_szStr + t_szSrc + t_szTag)
+			return false;
+		
+		decoded_record t_record{ };
+		t_record.m_Level = to_level(t_reader.read_u8());
+		t_record.m_Bare = (t_reader.read_u8() != 0);
+		t_record.m_Time = timestamp{ static_cast<::std::int64_t>(t_reader.read_be<::std::uint64_t>()) * 1000000000 };
+		t_record.m_Message = t_reader.read_string(t_szStr);
+		t_record.m_Source = t_reader.read_string(t_szSrc);
+		t_record.m_Tag = t_reader.read_string(t_szTag);
+		
+		m_Offset = static_cast<::std::size_t>(t_reader.position() - m_Buffer.data());
+		m_Records.push_back(::std::move(t_record));
+		return true;
+	}
+	
+	auto protocol_decoder::decode_frame()
+		-> bool
+	{
+		if(pending() < internal::frame_header_size)
+			return false;
+			
+		reader t_header{ m_Buffer.data() + m_Offset, m_Buffer.data() + m_Buffer.size() };
+		
+		if(t_header.read_u8() != internal::frame_magic_0 || t_header.read_u8() != internal::frame_magic_1)
+			throw ::std::runtime_error("protocol_decoder: Invalid frame magic");
+			
+		if(t_header.read_u8() != static_cast<::std::uint8_t>(protocol_version::v2))
+			throw ::std::runtime_error("protocol_decoder: Unsupported protocol version");
+			
+		const auto t_flags = t_header.read_u8();
+		const auto t_length = t_header.read_be<::std::uint32_t>();
+		
+		// The length is checked before waiting for the frame, which would otherwise buffer any amount of data
+		if(t_length > internal::max_frame_size)
+			throw ::std::runtime_error("protocol_decoder: Frame too large");
+		
+		if(t_header.remaining() < t_length)
+			return false;
+			
+		reader t_frame{ t_header.position(), t_header.position() + t_length };
+		
+		const auto t_count = t_frame.read_varint();
+		const auto t_size = static_cast<::std::size_t>(t_frame.read_varint());
+		const auto t_source = t_frame.read_string();
+		
+		// Decompress payload, if needed
+		const char* t_payload = t_frame.position();
+		
+		if((t_flags & internal::frame_flag_compressed) != 0)
+		{
+			// The size is untrusted. A single LZ4 byte never expands to more than 255 bytes.
+			if(t_size > internal::max_frame_size || t_size > t_frame.remaining() * 255)
+				throw ::std::runtime_error("protocol_decoder: Invalid uncompressed payload size");
+				
+			m_Payload.resize(t_size);
+			
+			if(!internal::lz_decompress(t_frame.position(), t_frame.remaining(), &m_Payload[0], t_size))
+				throw ::std::runtime_error("protocol_decoder: Malformed compressed payload");
+				
+			t_payload = m_Payload.data();
+		}
+		else if(t_frame.remaining() != t_size)
+			throw ::std::runtime_error("protocol_decoder: Payload size mismatch");
+			
+		reader t_reader{ t_payload, t_payload + t_size };
+		::std::int64_t t_time{0};
+		
+		// Distinct tags sent inline in this frame, which later records refer to by index
+		m_Tags.clear();
+		
+		// Records only become available once the whole frame was decoded successfully
+		m_Frame.clear();
+		
+		for(::std::uint64_t t_i = 0; t_i < t_count; ++t_i)
+		{
+			decoded_record t_record{ };
+			t_record.m_Level = to_level(t_reader.read_u8());
+			const auto t_recordFlags = t_reader.read_u8();
+			t_record.m_Bare = (t_recordFlags & internal::record_flag_bare) != 0;
+			
+			const auto t_rawTime = t_reader.read_varint();
+			t_time = (t_i == 0) ? static_cast<::std::int64_t>(t_rawTime) : t_time + unzigzag(t_rawTime);
+			
+			t_record.m_Time = timestamp{ t_time };
+			t_record.m_ThreadId = static_cast<::std::uint32_t>(t_reader.read_varint());
+			t_record.m_Line = t_reader.read_varint();
+			t_record.m_File = t_reader.read_string();
+			
+			if((t_recordFlags & internal::record_flag_tag_ref) != 0)
+			{
+				const auto t_index = t_reader.read_varint();
+				
+				if(t_index >= m_Tags.size())
+					throw ::std::runtime_error("protocol_decoder: Invalid tag reference");
+					
+				t_record.m_Tag = m_Tags[static_cast<::std::size_t>(t_index)];
+			}
+			else
+			{
+				t_record.m_Tag = t_reader.read_string();
+				
+				if(!t_record.m_Tag.empty())
+					m_Tags.push_back(t_record.m_Tag);
+			}
+			
+			t_record.m_Message = t_reader.read_string();
+			t_record.m_Source = t_source;
+			
+			if((t_recordFlags & internal::record_flag_fields) != 0)
+				read_fields(t_reader, t_record.m_Fields);
+			
+			m_Frame.push_back(::std::move(t_record));
+		}
+		
+		if(t_reader.remaining() != 0)
+			throw ::std::runtime_error("protocol_decoder: Trailing data in frame payload");
+		
+		for(auto& t_record : m_Frame)
+			m_Records.push_back(::std::move(t_record));
+		
+		m_Offset += internal::frame_header_size + t_length;
+		return true;
+	}
+}
@@ -0,0 +1,270 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "slab_arena.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		namespace
+		{
+			::std::atomic<::std::size_t> g_SlabSize{ arena_options{ }.m_SlabSize };
+			::std::atomic<::std::size_t> g_MaxBytes{ arena_options{ }.m_MaxBytes };
+			::std::atomic<::std::size_t> g_Bytes{0};
+			::std::atomic<::std::size_t> g_Peak{0};
+			::std::atomic<::std::size_t> g_Slabs{0};
+			::std::atomic<::std::uint64_t> g_HeapFallbacks{0};
+
+			// Slabs of a single thread that are ready for reuse. Shared with the slabs
+			// themselves, since these might outlive the thread.
+			struct arena_state
+			{
+				::std::mutex m_Mtx;
+				::std::vector<slab*> m_Free;
+				bool m_Detached{false};		//< Whether the owning thread has exited
+			};
+		}
+
+		// Header of a slab. The slab data directly follows it.
+		struct slab
+		{
+			slab(::std::shared_ptr<arena_state> p_arena, ::std::size_t p_size)
+				: m_Arena{::std::move(p_arena)}, m_Size{p_size}
+			{
+			}
+
+			auto data()
+				-> char*
+			{
+				return reinterpret_cast<char*>(this + 1);
+			}
+
+			::std::shared_ptr<arena_state> m_Arena;		//< Arena the slab is returned to
+			::std::atomic<::std::size_t> m_Live{1};		//< Number of unreleased blocks, plus one while the slab is still being filled
+			const ::std::size_t m_Size;					//< Size of the slab data
+			::std::size_t m_Used{0};					//< Number of bytes already handed out. Only used by the owning thread.
+		};
+
+		namespace
+		{
+			auto create_slab(const ::std::shared_ptr<arena_state>& p_arena)
+				-> slab*
+			{
+				const auto t_size = g_SlabSize.load(::std::memory_order_relaxed);
+
+				// Respect the high-water mark
+				const auto t_bytes = g_Bytes.fetch_add(t_size, ::std::memory_order_relaxed) + t_size;
+
+				if(t_bytes > g_MaxBytes.load(::std::memory_order_relaxed))
+				{
+					g_Bytes.fetch_sub(t_size, ::std::memory_order_relaxed);
+					return nullptr;
+				}
+
+				auto t_peak = g_Peak.load(::std::memory_order_relaxed);
+
+				while(t_bytes > t_peak && !g_Peak.compare_exchange_weak(t_peak, t_bytes, ::std::memory_order_relaxed));
+
+				g_Slabs.fetch_add(1, ::std::memory_order_relaxed);
+
+				return new (::operator new(sizeof(slab) + t_size)) slab{ p_arena, t_size };
+			}
+
+			auto destroy_slab(slab* p_slab)
+				-> void
+			{
+				g_Bytes.fetch_sub(p_slab->m_Size, ::std::memory_order_relaxed);
+				g_Slabs.fetch_sub(1, ::std::memory_order_relaxed);
+
+				p_slab->~slab();
+				::operator delete(p_slab);
+			}
+
+			// Return slab all blocks of which were released to its arena
+			auto recycle_slab(slab* p_slab)
+				-> void
+			{
+				// Keep the arena alive until the lock is released
+				const auto t_arena = p_slab->m_Arena;
+
+				{
+					::std::lock_guard<::std::mutex> lck(t_arena->m_Mtx);
+
+					if(!t_arena->m_Detached)
+					{
+						p_slab->m_Used = 0;
+						p_slab->m_Live.store(1, ::std::memory_order_relaxed);
+						t_arena->m_Free.push_back(p_slab);
+						return;
+					}
+				}
+
+				destroy_slab(p_slab);
+			}
+
+			// Drop reference to given slab
+			auto unref_slab(slab* p_slab)
+				-> void
+			{
+				if(p_slab->m_Live.fetch_sub(1, ::std::memory_order_acq_rel) == 1)
+					recycle_slab(p_slab);
+			}
+
+			// Arena of a single thread
+			class local_arena
+			{
+				public:
+					local_arena()
+						: m_State{::std::make_shared<arena_state>()}
+					{
+					}
+
+					~local_arena()
+					{
+						if(m_Current)
+							unref_slab(m_Current);
+
+						::std::vector<slab*> t_free{ };
+
+						{
+							::std::lock_guard<::std::mutex> lck(m_State->m_Mtx);
+							m_State->m_Detached = true;
+							t_free.swap(m_State->m_Free);
+						}
+
+						for(auto* t_slab : t_free)
+							destroy_slab(t_slab);
+					}
+
+					local_arena(const local_arena&) = delete;
+					local_arena& operator=(const local_arena&) = delete;
+
+				public:
+					auto allocate(::std::size_t p_size)
+						-> arena_block
+					{
+						if(!m_Current || m_Current->m_Size - m_Current->m_Used < p_size)
+						{
+							if(m_Current)
+								unref_slab(m_Current);
+
+							m_Current = next_slab();
+
+							// The slab size might have been lowered after the caller checked it
+							if(!m_Current || m_Current->m_Size < p_size)
+								return arena_block{ };
+						}
+
+						arena_block t_block{ m_Current->data() + m_Current->m_Used, m_Current };
+
+						m_Current->m_Used += p_size;
+						m_Current->m_Live.fetch_add(1, ::std::memory_order_relaxed);
+
+						return t_block;
+					}
+
+				private:
+					// Reuse released slab or create a new one. Released slabs that are smaller
+					// than the current slab size stem from earlier settings and are freed.
+					auto next_slab()
+						-> slab*
+					{
+						const auto t_size = g_SlabSize.load(::std::memory_order_relaxed);
+
+						slab* t_slab{nullptr};
+						::std::vector<slab*> t_outdated{ };
+
+						{
+							::std::lock_guard<::std::mutex> lck(m_State->m_Mtx);
+
+							while(!t_slab && !m_State->m_Free.empty())
+							{
+								t_slab = m_State->m_Free.back();
+								m_State->m_Free.pop_back();
+
+								if(t_slab->m_Size < t_size)
+								{
+									t_outdated.push_back(t_slab);
+									t_slab = nullptr;
+								}
+							}
+						}
+
+						for(auto* t_old : t_outdated)
+							destroy_slab(t_old);
+
+						return t_slab ? t_slab : create_slab(m_State);
+					}
+
+				private:
+					::std::shared_ptr<arena_state> m_State;
+					slab* m_Current{nullptr};		//< Slab currently being filled
+			};
+		}
+
+		auto arena_allocate(::std::size_t p_size)
+			-> arena_block
+		{
+			thread_local local_arena t_arena{ };
+
+			arena_block t_block{ };
+
+			// Large messages would waste most of a slab
+			if(p_size <= g_SlabSize.load(::std::memory_order_relaxed) / 4)
+				t_block = t_arena.allocate(p_size);
+
+			if(!t_block.m_Data)
+			{
+				g_HeapFallbacks.fetch_add(1, ::std::memory_order_relaxed);
+				t_block.m_Data = new char[p_size];
+			}
+
+			return t_block;
+		}
+
+		auto arena_release(const arena_block& p_block)
+			-> void
+		{
+			if(p_block.m_Slab)
+				unref_slab(p_block.m_Slab);
+			else delete[] p_block.m_Data;
+		}
+
+		auto configure_arenas(const arena_options& p_options)
+			-> void
+		{
+			g_SlabSize.store(p_options.m_SlabSize, ::std::memory_order_relaxed);
+			g_MaxBytes.store(p_options.m_MaxBytes, ::std::memory_order_relaxed);
+		}
+
+		auto arena_statistics()
+			-> arena_stats
+		{
+			return arena_stats{
+				g_Bytes.load(::std::memory_order_relaxed),
+				g_Peak.load(::std::memory_order_relaxed),
+				g_Slabs.load(::std::memory_order_relaxed),
+				g_HeapFallbacks.load(::std::memory_order_relaxed)
+			};
+		}
+	}
+}
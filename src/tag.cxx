@@ -1,10 +1,11 @@
 #include <tag.hxx>
+#include <tag_registry.hxx>
 
 namespace lg
 {
-	auto tag(::std::string p_str)
+	auto tag(const ::std::string& p_str)
 		-> internal::tag_t
 	{
-		return { ::std::move(p_str) };
+		return internal::tag_t{ internal::tag_registry::intern(p_str) };
 	}
 }
@@ -0,0 +1,124 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <mutex>
+#include <unordered_map>
+
+#include "tag_registry.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		::std::atomic<tag_info*> g_TagChunks[max_tags / tag_chunk_size]{ };
+		
+		namespace
+		{
+			struct registry_state
+			{
+				::std::mutex m_Mtx;
+				::std::unordered_map<::std::string, tag_id> m_Ids;
+				::std::size_t m_Count{1};		//< Number of ids handed out, including zero
+			};
+			
+			// Never destroyed, since entries may be formatted during static destruction
+			auto state()
+				-> registry_state&
+			{
+				static registry_state* t_state = new registry_state{ };
+				return *t_state;
+			}
+		}
+		
+		auto tag_registry::intern(const ::std::string& p_name)
+			-> tag_id
+		{
+			if(p_name.empty())
+				return 0;
+				
+			auto& t_state = state();
+			::std::lock_guard<::std::mutex> t_lock{t_state.m_Mtx};
+			
+			const auto t_it = t_state.m_Ids.find(p_name);
+			
+			if(t_it != t_state.m_Ids.end())
+				return t_it->second;
+				
+			if(t_state.m_Count == max_tags)
+				return 0;
+				
+			const auto t_id = t_state.m_Count++;
+			auto& t_chunk = g_TagChunks[t_id / tag_chunk_size];
+			
+			if(t_chunk.load(::std::memory_order_relaxed) == nullptr)
+				t_chunk.store(new tag_info[tag_chunk_size], ::std::memory_order_release);
+				
+			// The name is written before the id is handed out, which happens under the lock or
+			// through the release store of a tag_cache
+			t_chunk.load(::std::memory_order_relaxed)[t_id % tag_chunk_size].m_Name = p_name;
+			t_state.m_Ids.emplace(p_name, static_cast<tag_id>(t_id));
+			
+			return static_cast<tag_id>(t_id);
+		}
+		
+		auto tag_registry::intern(const char* p_name)
+			-> tag_id
+		{
+			return intern(::std::string{ p_name });
+		}
+		
+		auto tag_registry::set_threshold(const ::std::string& p_name, int p_lvl)
+			-> void
+		{
+			const auto t_id = intern(p_name);
+			
+			if(t_id != 0)
+				info(t_id).m_Threshold.store(p_lvl, ::std::memory_order_relaxed);
+		}
+		
+		auto tag_registry::names()
+			-> ::std::vector<::std::string>
+		{
+			auto& t_state = state();
+			::std::lock_guard<::std::mutex> t_lock{t_state.m_Mtx};
+			
+			::std::vector<::std::string> t_names{ };
+			t_names.reserve(t_state.m_Count);
+			
+			for(::std::size_t t_id = 0; t_id < t_state.m_Count; ++t_id)
+				t_names.push_back(name(static_cast<tag_id>(t_id)));
+				
+			return t_names;
+		}
+	}
+	
+	auto set_tag_threshold(const ::std::string& p_tag, severity_level p_lvl)
+		-> void
+	{
+		internal::tag_registry::set_threshold(p_tag, static_cast<int>(p_lvl));
+	}
+	
+	auto disable_tag(const ::std::string& p_tag)
+		-> void
+	{
+		internal::tag_registry::set_threshold(p_tag, -1);
+	}
+	
+	auto enable_tag(const ::std::string& p_tag)
+		-> void
+	{
+		internal::tag_registry::set_threshold(p_tag, static_cast<int>(severity_level::debug));
+	}
+}
@@ -0,0 +1,105 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <ctime>
+#include <cstring>
+
+#include "timestamp.hxx"
+
+namespace lg
+{
+	namespace
+	{
+		// Write given value as a fixed number of decimal digits
+		auto write_digits(char* p_out, ::std::uint32_t p_value, ::std::size_t p_digits)
+			-> void
+		{
+			for(::std::size_t t_i = p_digits; t_i > 0; --t_i)
+			{
+				p_out[t_i - 1] = static_cast<char>('0' + (p_value % 10));
+				p_value /= 10;
+			}
+		}
+		
+		// Time of day of the last second that was rendered by this thread
+		struct time_cache
+		{
+			::std::time_t m_Second{-1};
+			char m_Prefix[8];
+		};
+	}
+
+	auto format_time(timestamp p_time, time_precision p_precision, char* p_buffer)
+		-> ::std::size_t
+	{
+		thread_local time_cache t_cache{ };
+		
+		const auto t_second = p_time.to_time_t();
+		
+		// Only consult the time zone once per second
+		if(t_second != t_cache.m_Second)
+		{
+			std::tm t_tm{ };
+			
+#if defined(_WIN32)
+			localtime_s(&t_tm, &t_second);
+#else
+			localtime_r(&t_second, &t_tm);
+#endif
+
+			write_digits(&t_cache.m_Prefix[0], t_tm.tm_hour, 2);
+			t_cache.m_Prefix[2] = ':';
+			write_digits(&t_cache.m_Prefix[3], t_tm.tm_min, 2);
+			t_cache.m_Prefix[5] = ':';
+			write_digits(&t_cache.m_Prefix[6], t_tm.tm_sec, 2);
+			
+			t_cache.m_Second = t_second;
+		}
+		
+		::std::memcpy(p_buffer, t_cache.m_Prefix, sizeof(t_cache.m_Prefix));
+		::std::size_t t_length = sizeof(t_cache.m_Prefix);
+		
+		// Append sub-second digits, if requested
+		::std::size_t t_digits{ };
+		::std::uint32_t t_fraction = p_time.subsecond();
+		
+		switch(p_precision)
+		{
+			case time_precision::milliseconds:
+				t_digits = 3;
+				t_fraction /= 1000000;
+				break;
+			case time_precision::microseconds:
+				t_digits = 6;
+				t_fraction /= 1000;
+				break;
+			case time_precision::nanoseconds:
+				t_digits = 9;
+				break;
+			default:
+				break;
+		}
+		
+		if(t_digits > 0)
+		{
+			p_buffer[t_length++] = '.';
+			write_digits(&p_buffer[t_length], t_fraction, t_digits);
+			t_length += t_digits;
+		}
+		
+		p_buffer[t_length] = '\0';
+		return t_length;
+	}
+}
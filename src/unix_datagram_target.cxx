@@ -0,0 +1,282 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#if !defined(_WIN32)
+
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <ut/throwf.hxx>
+
+#include "unix_datagram_target.hxx"
+
+namespace lg
+{
+	namespace internal
+	{
+		// Address of the receiver and the message headers handed to the kernel,
+		// one per datagram. Hidden from the header in order to not expose the socket API.
+		struct unix_datagram_data
+		{
+			::sockaddr_un m_Address{ };
+			::std::vector<::iovec> m_Vectors{ };
+#if defined(__linux__)
+			::std::vector<::mmsghdr> m_Messages{ };
+#else
+			::std::vector<::msghdr> m_Messages{ };
+#endif
+		};
+		
+		namespace
+		{
+			// Upper bound for the number of datagrams passed to a single system call
+			constexpr ::std::size_t max_messages = 1024;
+			
+			// A receiver that went away must not kill the process using SIGPIPE
+#if defined(MSG_NOSIGNAL)
+			constexpr int send_flags = MSG_NOSIGNAL;
+#else
+			constexpr int send_flags = 0;
+#endif
+
+			// Send given number of datagrams, starting at given index. Returns the number of datagrams
+			// that were sent, or -1 if sending the first one failed, in which case errno is set.
+			auto send_messages(int p_fd, unix_datagram_data& p_data, ::std::size_t p_first, ::std::size_t p_count, int p_flags)
+				-> int
+			{
+#if defined(__linux__)
+				return ::sendmmsg(p_fd, &p_data.m_Messages[p_first], static_cast<unsigned int>(p_count), p_flags);
+#else
+				int t_sent{0};
+				
+				for(; static_cast<::std::size_t>(t_sent) < p_count; ++t_sent)
+				{
+					if(::sendmsg(p_fd, &p_data.m_Messages[p_first + t_sent], p_flags) < 0)
+						return (t_sent > 0) ? t_sent : -1;
+				}
+				
+				return t_sent;
+#endif
+			}
+			
+			// Plain message header of an entry of unix_datagram_data::m_Messages
+#if defined(__linux__)
+			auto header(::mmsghdr& p_msg)
+				-> ::msghdr&
+			{
+				return p_msg.msg_hdr;
+			}
+#else
+			auto header(::msghdr& p_msg)
+				-> ::msghdr&
+			{
+				return p_msg;
+			}
+#endif
+		}
+	}
+	
+	unix_datagram_target::unix_datagram_target(severity_level p_lvl, const ::std::string& p_path, const ::std::string& p_src, const unix_datagram_options& p_options)
+		:	log_target(p_lvl),
+			m_Path{p_path},
+			m_Options{p_options},
+			m_Encoder{p_src, p_options.m_Protocol},
+			m_Data{ new internal::unix_datagram_data() }
+	{
+		auto& t_addr = m_Data->m_Address;
+		
+		if(p_path.empty() || p_path.size() >= sizeof(t_addr.sun_path))
+		{
+			ut::throwf<::std::runtime_error>(
+				"unix_datagram_target: Invalid socket path \"%s\"",
+				p_path
+			);
+		}
+		
+		t_addr.sun_family = AF_UNIX;
+		::std::memcpy(t_addr.sun_path, p_path.c_str(), p_path.size() + 1);
+		
+		// The receiver might not be running yet, which is not an error
+		connect();
+	}
+	
+	unix_datagram_target::~unix_datagram_target()
+	{
+		disconnect();
+	}
+	
+	auto unix_datagram_target::connect()
+		-> bool
+	{
+		const auto t_now = ::std::chrono::steady_clock::now();
+		
+		if(m_LastAttempt != decltype(m_LastAttempt){ } && t_now - m_LastAttempt < m_Options.m_RetryInterval)
+			return false;
+			
+		m_LastAttempt = t_now;
+		
+		const int t_fd = ::socket(AF_UNIX, m_Options.m_SeqPacket ? SOCK_SEQPACKET : SOCK_DGRAM, 0);
+		
+		if(t_fd < 0)
+			return false;
+			
+		::fcntl(t_fd, F_SETFD, FD_CLOEXEC);
+		
+#if defined(SO_NOSIGPIPE)
+		const int t_on{1};
+		::setsockopt(t_fd, SOL_SOCKET, SO_NOSIGPIPE, &t_on, sizeof(t_on));
+#endif
+		
+		if(::connect(t_fd, reinterpret_cast<const ::sockaddr*>(&m_Data->m_Address), sizeof(m_Data->m_Address)) != 0)
+		{
+			::close(t_fd);
+			return false;
+		}
+		
+		m_Fd = t_fd;
+		m_Connected.store(true);
+		
+		return true;
+	}
+	
+	auto unix_datagram_target::disconnect()
+		-> void
+	{
+		if(m_Fd >= 0)
+		{
+			::close(m_Fd);
+			m_Fd = -1;
+			m_Connected.store(false);
+		}
+	}
+	
+	void unix_datagram_target::write(const log_entry& p_entry)
+	{
+		const log_entry* t_entry = &p_entry;
+		write_batch(entry_span{ &t_entry, 1 });
+	}
+	
+	void unix_datagram_target::write_batch(entry_span p_entries)
+	{
+		// Encoding is pointless if the receiver is absent
+		if(m_Fd < 0 && !connect())
+		{
+			m_Dropped.fetch_add(p_entries.size(), ::std::memory_order_relaxed);
+			return;
+		}
+		
+		m_Packets.clear();
+		m_Frames.clear();
+		
+		m_Encoder.encode(m_Packets, p_entries, m_Frames);
+		
+		send();
+	}
+	
+	auto unix_datagram_target::send()
+		-> void
+	{
+		const auto t_count = m_Frames.size();
+		auto& t_vectors = m_Data->m_Vectors;
+		auto& t_messages = m_Data->m_Messages;
+		
+		// The buffer is not modified anymore, so the vectors can point right into it
+		t_vectors.resize(t_count);
+		t_messages.resize(t_count);
+		
+		for(::std::size_t t_i = 0, t_begin = 0; t_i < t_count; t_begin = m_Frames[t_i++].m_End)
+		{
+			t_vectors[t_i].iov_base = &m_Packets[t_begin];
+			t_vectors[t_i].iov_len = m_Frames[t_i].m_End - t_begin;
+			
+			t_messages[t_i] = { };
+			internal::header(t_messages[t_i]).msg_iov = &t_vectors[t_i];
+			internal::header(t_messages[t_i]).msg_iovlen = 1;
+		}
+		
+		const int t_flags = internal::send_flags | (m_Options.m_NonBlocking ? MSG_DONTWAIT : 0);
+		
+		for(::std::size_t t_next = 0; t_next < t_count; )
+		{
+			const auto t_sent = internal::send_messages(m_Fd, *m_Data, t_next, ::std::min(t_count - t_next, internal::max_messages), t_flags);
+			
+			if(t_sent > 0)
+			{
+				t_next += static_cast<::std::size_t>(t_sent);
+				m_Sent.fetch_add(static_cast<::std::uint64_t>(t_sent), ::std::memory_order_relaxed);
+				continue;
+			}
+			
+			const auto t_error = errno;
+			
+			if(t_error == EINTR)
+				continue;
+			
+			// A datagram exceeding the limits of the socket is dropped on its own
+			if(t_error == EMSGSIZE)
+			{
+				drop(t_next, t_next + 1);
+				++t_next;
+				continue;
+			}
+			
+			drop(t_next, t_count);
+			
+			// Anything but a full receive queue means that the receiver went away.
+			// Connecting is tried again with the next batch.
+			if(t_error != EAGAIN && t_error != EWOULDBLOCK)
+				disconnect();
+				
+			return;
+		}
+	}
+	
+	auto unix_datagram_target::drop(::std::size_t p_begin, ::std::size_t p_end)
+		-> void
+	{
+		::std::uint64_t t_entries{0};
+		
+		for(auto t_i = p_begin; t_i < p_end; ++t_i)
+			t_entries += m_Frames[t_i].m_Records;
+			
+		m_Dropped.fetch_add(t_entries, ::std::memory_order_relaxed);
+	}
+	
+	auto unix_datagram_target::connected() const
+		-> bool
+	{
+		return m_Connected.load();
+	}
+	
+	auto unix_datagram_target::dropped() const
+		-> ::std::uint64_t
+	{
+		return m_Dropped.load(::std::memory_order_relaxed);
+	}
+	
+	auto unix_datagram_target::sent() const
+		-> ::std::uint64_t
+	{
+		return m_Sent.load(::std::memory_order_relaxed);
+	}
+}
+
+#endif
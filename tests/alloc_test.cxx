@@ -0,0 +1,123 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Constructing a log entry whose message fits into its inline storage must not allocate.
+// Logging it must not allocate on the calling thread either, apart from the occasional
+// growth of the shared queue.
+
+#include <new>
+#include <cstdlib>
+#include <string>
+#include <log.hxx>
+
+#include "check.hxx"
+#include "fixtures.hxx"
+
+namespace
+{
+	thread_local ::std::size_t t_allocations{0};
+	
+	// Number of allocations performed by the calling thread while logging given number of short messages
+	template< typename F >
+	auto count_allocations(::std::size_t p_count, F&& p_func)
+		-> ::std::size_t
+	{
+		const auto t_begin = t_allocations;
+		
+		for(::std::size_t t_i = 0; t_i < p_count; ++t_i)
+			p_func(t_i);
+			
+		return t_allocations - t_begin;
+	}
+}
+
+// Count all heap allocations of the calling thread
+void* operator new(::std::size_t p_size)
+{
+	++t_allocations;
+
+	if(void* t_ptr = ::std::malloc(p_size ? p_size : 1))
+		return t_ptr;
+
+	throw ::std::bad_alloc{ };
+}
+
+void operator delete(void* p_ptr) noexcept
+{
+	::std::free(p_ptr);
+}
+
+void operator delete(void* p_ptr, ::std::size_t) noexcept
+{
+	::std::free(p_ptr);
+}
+
+int main()
+{
+	static test::null_target t_target{ };
+	lg::logger::add_target(&t_target);
+	
+	const auto t_entry = [](::std::size_t p_i)
+	{
+		auto t_entry = lg::log_entry(LOG_SITE_BASE(info, bright_white, false)) << "Small message " << p_i << " with a double " << 3.5;
+		t_entry.prepare();
+	};
+	
+	const auto t_stream = [](::std::size_t p_i)
+	{
+		LOG_I() << "Small message " << p_i << " with a double " << 3.5 << " and a char " << 'x';
+	};
+	
+	const auto t_format = [](::std::size_t p_i)
+	{
+		LOG_I_FMT("Small message %s with a double %s", p_i, 3.5);
+	};
+	
+	// The first entries create the per-thread and per-call site state
+	count_allocations(1000, t_entry);
+	count_allocations(1000, t_stream);
+	count_allocations(1000, t_format);
+	lg::logger::flush();
+	
+	CHECK(count_allocations(1000, t_entry) == 0);
+	
+	// The shared queue only grows now and then, if the worker thread swapped it with a smaller one
+	CHECK(count_allocations(1000, t_stream) <= 1000 / 16);
+	CHECK(count_allocations(1000, t_format) <= 1000 / 16);
+	
+	// Ring buffer slots are preallocated
+	lg::logger::use_ring_buffers(4096);
+	count_allocations(1000, t_stream);
+	lg::logger::flush();
+	
+	CHECK(count_allocations(1000, t_stream) == 0);
+	CHECK(count_allocations(1000, t_format) == 0);
+	
+	// Long messages are placed into slabs, which are reused once the entries were written.
+	// A new slab is only needed if the batch holding the old one was not released yet.
+	const ::std::string t_long(LIBLOG_INLINE_MESSAGE_SIZE + 16, 'x');
+	const auto t_slab = [&t_long](::std::size_t)
+	{
+		LOG_I() << t_long;
+	};
+	
+	count_allocations(1000, t_slab);
+	lg::logger::flush();
+	
+	CHECK(count_allocations(100, t_slab) <= 1);
+	
+	lg::logger::shutdown();
+	return test::result();
+}
@@ -0,0 +1,59 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Minimal checks shared by the test executables. A failed check is reported, but does
+// not abort the test. The exit code tells ctest whether all checks passed.
+
+#pragma once
+
+#include <cstdio>
+
+namespace test
+{
+	inline auto failures()
+		-> int&
+	{
+		static int t_failures{0};
+		return t_failures;
+	}
+	
+	inline auto fail(const char* p_file, int p_line, const char* p_expr)
+		-> void
+	{
+		++failures();
+		::std::fprintf(stderr, "%s:%d: Check failed: %s\n", p_file, p_line, p_expr);
+	}
+	
+	// Exit code of the test executable
+	inline auto result()
+		-> int
+	{
+		if(failures() > 0)
+			::std::fprintf(stderr, "%d check(s) failed\n", failures());
+			
+		return (failures() == 0) ? 0 : 1;
+	}
+}
+
+#define CHECK(_expr) \
+	do { if(!(_expr)) ::test::fail(__FILE__, __LINE__, #_expr); } while(false)
+
+// Check that evaluating given expression throws an exception of given type
+#define CHECK_THROWS(_type, _expr) \
+	do { \
+		bool t_thrown{false}; \
+		try { (void)(_expr); } catch(const _type&) { t_thrown = true; } \
+		if(!t_thrown) ::test::fail(__FILE__, __LINE__, "throws " #_type ": " #_expr); \
+	} while(false)
@@ -0,0 +1,378 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Round trips through the LZ4 codec and the wire protocol, and malformed input,
+// which has to be rejected using std::runtime_error.
+
+#include <string>
+#include <vector>
+#include <random>
+#include <stdexcept>
+#include <log.hxx>
+#include <log/lz_codec.hxx>
+#include <log/protocol_decoder.hxx>
+
+#include "check.hxx"
+
+namespace
+{
+	// Inputs of different compressibility
+	auto samples()
+		-> ::std::vector<::std::string>
+	{
+		::std::mt19937 t_rng{ 42 };
+		::std::string t_random(100000, '\0');
+		
+		for(auto& t_c : t_random)
+			t_c = static_cast<char>(t_rng());
+			
+		::std::string t_text{ };
+		
+		for(int t_i = 0; t_i < 5000; ++t_i)
+			t_text += "[12:00:00] [Info] Handled request " + ::std::to_string(t_i) + " in 0.25ms\n";
+			
+		return { ::std::string{ }, "x", "abcabcabcabcabcabc", ::std::string(70000, 'a'), t_random, t_text };
+	}
+	
+	auto test_block_round_trip()
+		-> void
+	{
+		for(const auto& t_sample : samples())
+		{
+			for(auto t_level = lg::internal::lz_min_level; t_level <= lg::internal::lz_max_level; ++t_level)
+			{
+				::std::string t_compressed{ };
+				lg::internal::lz_compress(t_sample.data(), t_sample.size(), t_compressed, t_level);
+				
+				::std::string t_result(t_sample.size(), '\0');
+				CHECK(lg::internal::lz_decompress(t_compressed.data(), t_compressed.size(), &t_result[0], t_result.size()));
+				CHECK(t_result == t_sample);
+			}
+		}
+	}
+	
+	// Truncated and corrupted blocks are reported, and never written beyond the output buffer
+	auto test_block_malformed()
+		-> void
+	{
+		const auto t_sample = samples().back();
+		
+		::std::string t_compressed{ };
+		lg::internal::lz_compress(t_sample.data(), t_sample.size(), t_compressed);
+		
+		::std::string t_result(t_sample.size(), '\0');
+		
+		for(::std::size_t t_len = 0; t_len < t_compressed.size(); t_len += 97)
+			CHECK(!lg::internal::lz_decompress(t_compressed.data(), t_len, &t_result[0], t_result.size()));
+			
+		// Output buffer too small
+		::std::size_t t_size{ };
+		CHECK(!lg::internal::lz_decompress_bounded(t_compressed.data(), t_compressed.size(), &t_result[0], t_result.size() / 2, t_size));
+		
+		// Garbage has to be survived, whatever the result
+		::std::mt19937 t_rng{ 7 };
+		
+		for(int t_i = 0; t_i < 1000; ++t_i)
+		{
+			::std::string t_garbage(1 + t_rng() % 64, '\0');
+			
+			for(auto& t_c : t_garbage)
+				t_c = static_cast<char>(t_rng());
+				
+			lg::internal::lz_decompress_bounded(t_garbage.data(), t_garbage.size(), &t_result[0], 256, t_size);
+			CHECK(t_size <= 256);
+		}
+	}
+	
+	auto test_frame_round_trip()
+		-> void
+	{
+		::std::string t_frames{ };
+		::std::string t_expected{ };
+		
+		for(const auto& t_sample : samples())
+		{
+			lg::internal::lz_frame_compress(t_sample.data(), t_sample.size(), t_frames);
+			t_expected += t_sample;
+		}
+		
+		// Concatenated frames decode to the concatenated contents
+		::std::string t_result{ };
+		
+		for(::std::size_t t_pos = 0; t_pos < t_frames.size(); )
+		{
+			const auto t_size = lg::internal::lz_frame_decompress(t_frames.data() + t_pos, t_frames.size() - t_pos, t_result);
+			CHECK(t_size > 0);
+			
+			if(t_size == 0)
+				break;
+				
+			t_pos += t_size;
+		}
+		
+		CHECK(t_result == t_expected);
+	}
+	
+	auto test_frame_malformed()
+		-> void
+	{
+		const auto t_sample = samples().back();
+		
+		::std::string t_frame{ };
+		lg::internal::lz_frame_compress(t_sample.data(), t_sample.size(), t_frame);
+		
+		::std::string t_result{ };
+		
+		// Truncated frames need more data
+		for(::std::size_t t_len = 0; t_len < t_frame.size(); t_len += 101)
+			CHECK(lg::internal::lz_frame_decompress(t_frame.data(), t_len, t_result) == 0);
+			
+		// Invalid magic number
+		::std::string t_garbage{ t_frame };
+		t_garbage[0] = 'x';
+		CHECK_THROWS(::std::runtime_error, lg::internal::lz_frame_decompress(t_garbage.data(), t_garbage.size(), t_result));
+		
+		// Corrupted header, detected by the header checksum
+		t_garbage = t_frame;
+		t_garbage[5] = static_cast<char>(t_garbage[5] ^ 0x1);
+		CHECK_THROWS(::std::runtime_error, lg::internal::lz_frame_decompress(t_garbage.data(), t_garbage.size(), t_result));
+		
+		// Block larger than the block size of the frame. The first block size follows the
+		// magic number, the descriptor flags, the content size and the header checksum.
+		t_garbage = t_frame;
+		t_garbage[4 + 2 + 8 + 1 + 3] = '\x7F';
+		CHECK_THROWS(::std::runtime_error, lg::internal::lz_frame_decompress(t_garbage.data(), t_garbage.size(), t_result));
+	}
+	
+	// Entries covering everything the protocol transmits
+	class sample_entries
+	{
+		public:
+			sample_entries()
+			{
+				for(int t_i = 0; t_i < 500; ++t_i)
+				{
+					auto t_entry = lg::log_entry(LOG_SITE_BASE(warning, bright_white, false)) << "Message " << t_i;
+					
+					if(t_i % 3 == 0)
+						::std::move(t_entry) << lg::tag((t_i % 2 == 0) ? "even" : "odd");
+						
+					if(t_i % 5 == 0)
+						::std::move(t_entry) << lg::kv("index", t_i) << lg::kv("name", "value") << lg::kv("ratio", 0.5);
+						
+					m_Entries.push_back(::std::move(t_entry));
+					m_Entries.back().prepare();
+				}
+				
+				for(const auto& t_entry : m_Entries)
+					m_Pointers.push_back(&t_entry);
+			}
+			
+		public:
+			auto span() const
+				-> lg::entry_span
+			{
+				return { m_Pointers.data(), m_Pointers.size() };
+			}
+			
+			auto entries() const
+				-> const ::std::vector<lg::log_entry>&
+			{
+				return m_Entries;
+			}
+			
+		private:
+			::std::vector<lg::log_entry> m_Entries;
+			::std::vector<const lg::log_entry*> m_Pointers;
+	};
+	
+	auto encode(const sample_entries& p_entries, lg::protocol_version p_version, bool p_compress)
+		-> ::std::string
+	{
+		lg::protocol_options t_options{ };
+		t_options.m_Version = p_version;
+		t_options.m_Compress = p_compress;
+		t_options.m_MaxFrameSize = 4096;
+		
+		lg::internal::protocol_encoder t_encoder{ "source", t_options };
+		
+		::std::string t_data{ };
+		::std::vector<lg::internal::frame_info> t_frames{ };
+		t_encoder.encode(t_data, p_entries.span(), t_frames);
+		
+		return t_data;
+	}
+	
+	auto test_protocol_round_trip(const sample_entries& p_entries, lg::protocol_version p_version, bool p_compress)
+		-> void
+	{
+		const auto t_data = encode(p_entries, p_version, p_compress);
+		
+		// Data arrives in arbitrary pieces
+		lg::protocol_decoder t_decoder{ p_version };
+		::std::vector<lg::decoded_record> t_records{ };
+		lg::decoded_record t_record{ };
+		
+		for(::std::size_t t_pos = 0; t_pos < t_data.size(); t_pos += 777)
+		{
+			t_decoder.feed(t_data.data() + t_pos, ::std::min<::std::size_t>(777, t_data.size() - t_pos));
+			
+			while(t_decoder.next(t_record))
+				t_records.push_back(t_record);
+		}
+		
+		CHECK(t_decoder.pending() == 0);
+		CHECK(t_records.size() == p_entries.entries().size());
+		
+		if(t_records.size() != p_entries.entries().size())
+			return;
+			
+		for(::std::size_t t_i = 0; t_i < t_records.size(); ++t_i)
+		{
+			const auto& t_entry = p_entries.entries()[t_i];
+			const auto& t_decoded = t_records[t_i];
+			
+			CHECK(t_decoded.m_Level == lg::severity_level::warning);
+			CHECK(t_decoded.m_Message == t_entry.message_view().to_string());
+			CHECK(t_decoded.m_Source == "source");
+			CHECK(t_decoded.m_Tag == t_entry.tag());
+			
+			// Everything else is only transmitted by v2
+			if(p_version == lg::protocol_version::v1)
+				continue;
+				
+			CHECK(t_decoded.m_Time.nanoseconds() == t_entry.time_point().nanoseconds());
+			CHECK(t_decoded.m_Fields.size() == t_entry.fields().size());
+			
+			if(!t_decoded.m_Fields.empty())
+			{
+				CHECK(t_decoded.m_Fields.size() == 3);
+				CHECK(t_decoded.m_Fields[0].m_Key == "index" && t_decoded.m_Fields[0].m_Signed == static_cast<::std::int64_t>(t_i));
+				CHECK(t_decoded.m_Fields[1].m_Key == "name" && t_decoded.m_Fields[1].m_String == "value");
+				CHECK(t_decoded.m_Fields[2].m_Key == "ratio" && t_decoded.m_Fields[2].m_Double == 0.5);
+			}
+		}
+	}
+	
+	// Decode given data, expecting an error before any record was returned
+	auto decode_malformed(const ::std::string& p_data)
+		-> bool
+	{
+		lg::protocol_decoder t_decoder{ lg::protocol_version::v2 };
+		lg::decoded_record t_record{ };
+		
+		t_decoder.feed(p_data.data(), p_data.size());
+		
+		try
+		{
+			while(t_decoder.next(t_record))
+				return false;
+		}
+		catch(const ::std::runtime_error&)
+		{
+			return true;
+		}
+		
+		return false;
+	}
+	
+	auto test_protocol_malformed(const sample_entries& p_entries)
+		-> void
+	{
+		const auto t_data = encode(p_entries, lg::protocol_version::v2, false);
+		const auto t_compressed = encode(p_entries, lg::protocol_version::v2, true);
+		
+		// A truncated frame is not an error, more data might follow
+		{
+			lg::protocol_decoder t_decoder{ lg::protocol_version::v2 };
+			lg::decoded_record t_record{ };
+			
+			t_decoder.feed(t_data.data(), 100);
+			CHECK(!t_decoder.next(t_record));
+			CHECK(t_decoder.pending() == 100);
+		}
+		
+		// Invalid magic and version
+		::std::string t_garbage{ t_data };
+		t_garbage[0] = 'x';
+		CHECK(decode_malformed(t_garbage));
+		
+		t_garbage = t_data;
+		t_garbage[2] = 9;
+		CHECK(decode_malformed(t_garbage));
+		
+		// More records announced than the payload holds. None of them may be returned.
+		t_garbage = t_data;
+		CHECK(static_cast<unsigned char>(t_garbage[lg::internal::frame_header_size]) < 0x7F);
+		++t_garbage[lg::internal::frame_header_size];
+		CHECK(decode_malformed(t_garbage));
+		
+		// Corrupted compressed payload
+		t_garbage = t_compressed;
+		
+		for(::std::size_t t_i = 20; t_i < 60; ++t_i)
+			t_garbage[t_i] = static_cast<char>(0xFF);
+			
+		CHECK(decode_malformed(t_garbage));
+		
+		// Huge frame length, which must not be waited for
+		const char t_huge[] = { 'L', 'G', 2, 0, '\x7F', '\xFF', '\xFF', '\xFF' };
+		CHECK(decode_malformed(::std::string(t_huge, sizeof(t_huge))));
+		
+		// Compressed frame claiming an uncompressed size of about 8 GB, which must not be allocated
+		const char t_bomb[] = { 'L', 'G', 2, 1, 0, 0, 0, 12, 1, '\xFF', '\xFF', '\xFF', '\xFF', '\x1D', 0, 1, 2, 3, 4, 5 };
+		CHECK(decode_malformed(::std::string(t_bomb, sizeof(t_bomb))));
+		
+		// Random garbage after a valid frame
+		::std::mt19937 t_rng{ 3 };
+		
+		for(int t_i = 0; t_i < 200; ++t_i)
+		{
+			t_garbage = t_compressed;
+			
+			for(int t_j = 0; t_j < 8; ++t_j)
+				t_garbage[t_rng() % t_garbage.size()] = static_cast<char>(t_rng());
+				
+			lg::protocol_decoder t_decoder{ lg::protocol_version::v2 };
+			lg::decoded_record t_record{ };
+			t_decoder.feed(t_garbage.data(), t_garbage.size());
+			
+			try
+			{
+				while(t_decoder.next(t_record));
+			}
+			catch(const ::std::runtime_error&)
+			{
+			}
+		}
+	}
+}
+
+int main()
+{
+	test_block_round_trip();
+	test_block_malformed();
+	test_frame_round_trip();
+	test_frame_malformed();
+	
+	const sample_entries t_entries{ };
+	
+	test_protocol_round_trip(t_entries, lg::protocol_version::v1, false);
+	test_protocol_round_trip(t_entries, lg::protocol_version::v2, false);
+	test_protocol_round_trip(t_entries, lg::protocol_version::v2, true);
+	test_protocol_malformed(t_entries);
+	
+	return test::result();
+}
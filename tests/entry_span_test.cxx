@@ -0,0 +1,62 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// The iterator of entry_span claims to be random access, so standard algorithms have
+// to work with it.
+
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <log.hxx>
+
+#include "check.hxx"
+#include "fixtures.hxx"
+
+int main()
+{
+	const test::prepared_entries t_entries{ 100, "" };
+	const auto t_span = t_entries.span(0, t_entries.size());
+	
+	const auto t_begin = t_span.begin();
+	const auto t_end = t_span.end();
+	
+	CHECK(::std::distance(t_begin, t_end) == 100);
+	CHECK(::std::next(t_begin, 42)->message() == "Entry 42");
+	CHECK(::std::prev(t_end)->message() == "Entry 99");
+	CHECK((3 + t_begin)->message() == "Entry 3");
+	CHECK(t_begin[7].message() == "Entry 7");
+	
+	auto t_it = t_end;
+	t_it -= 10;
+	CHECK((t_it--)->message() == "Entry 90" && t_it->message() == "Entry 89");
+	
+	::std::advance(t_it, -89);
+	CHECK(t_it == t_begin && t_it < t_end && t_it <= t_begin && t_end > t_it && t_end >= t_end);
+	
+	// Entries are in dispatch order, so their timestamps do not decrease
+	const auto t_earlier = [](const lg::log_entry& p_lhs, const lg::log_entry& p_rhs)
+	{
+		return p_lhs.time_point().nanoseconds() < p_rhs.time_point().nanoseconds();
+	};
+	
+	CHECK(::std::is_sorted(t_begin, t_end, t_earlier));
+	
+	// Reverse iteration
+	const ::std::reverse_iterator<lg::entry_span::iterator> t_rbegin{ t_end };
+	CHECK(t_rbegin->message() == "Entry 99");
+	CHECK(t_rbegin[99].message() == "Entry 0");
+	
+	return test::result();
+}
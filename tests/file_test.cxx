@@ -0,0 +1,115 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Flushing a file target has to sync the file that is actually written, even if its path
+// was renamed in the meantime, and failures have to be reported.
+
+#include <string>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <log.hxx>
+
+#include "check.hxx"
+
+namespace
+{
+	auto read_file(const ::std::string& p_path)
+		-> ::std::string
+	{
+		::std::ifstream t_in{ p_path, ::std::ios_base::binary };
+		return ::std::string{ ::std::istreambuf_iterator<char>{ t_in }, ::std::istreambuf_iterator<char>{ } };
+	}
+	
+	template< typename T >
+	auto write_entry(T& p_target, const char* p_text)
+		-> void
+	{
+		auto t_entry = lg::log_entry(LOG_SITE_BASE(info, bright_white, false)) << p_text;
+		t_entry.prepare();
+		p_target.write(t_entry);
+	}
+	
+	// Write to a target, rename its file, and write some more. Returns the contents of the renamed file.
+	template< typename T, typename... Ts >
+	auto write_renamed(const ::std::string& p_path, Ts&&... p_args)
+		-> ::std::string
+	{
+		const auto t_renamed = p_path + ".renamed";
+		::std::remove(p_path.c_str());
+		::std::remove(t_renamed.c_str());
+	
+		{
+			T t_target{ lg::severity_level::debug, p_path, ::std::forward<Ts>(p_args)... };
+			
+			write_entry(t_target, "before rename");
+			t_target.flush();
+			
+			CHECK(::std::rename(p_path.c_str(), t_renamed.c_str()) == 0);
+			
+			write_entry(t_target, "after rename");
+			t_target.flush();
+			
+			CHECK(t_target.sync_failures() == 0);
+		}
+		
+		// Nothing may have been created at the old path
+		CHECK(!::std::ifstream{ p_path }.is_open());
+		
+		const auto t_contents = read_file(t_renamed);
+		::std::remove(t_renamed.c_str());
+		return t_contents;
+	}
+}
+
+int main()
+{
+	const auto t_text = write_renamed<lg::file_target<>>("file_test.log", true);
+	CHECK(t_text.find("before rename") != ::std::string::npos);
+	CHECK(t_text.find("after rename") != ::std::string::npos);
+	
+	// Both entries were flushed as separate frames
+	const auto t_compressed = write_renamed<lg::compressed_file_target<>>("file_test.lz4");
+	::std::string t_unpacked{ };
+	
+	for(::std::size_t t_pos = 0, t_size = 0; t_pos < t_compressed.size(); t_pos += t_size)
+	{
+		t_size = lg::internal::lz_frame_decompress(t_compressed.data() + t_pos, t_compressed.size() - t_pos, t_unpacked);
+		
+		if(t_size == 0)
+			break;
+	}
+		
+	CHECK(t_unpacked.find("before rename") != ::std::string::npos);
+	CHECK(t_unpacked.find("after rename") != ::std::string::npos);
+	
+	const auto t_binary = write_renamed<lg::binary_file_target>("file_test.bin");
+	CHECK(!t_binary.empty());
+	::std::remove("file_test.bin.idx");
+	
+#if defined(__linux__)
+	// Every write to this device fails
+	{
+		lg::file_target<> t_target{ lg::severity_level::debug, "/dev/full", true };
+		
+		write_entry(t_target, "lost");
+		t_target.flush();
+		
+		CHECK(t_target.sync_failures() == 1);
+	}
+#endif
+	
+	return test::result();
+}
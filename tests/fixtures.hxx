@@ -0,0 +1,95 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Fixtures shared by the test executables
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <log.hxx>
+
+namespace test
+{
+	// Discards all entries
+	class null_target
+		: public lg::log_target
+	{
+		public:
+			null_target()
+				: log_target(lg::severity_level::debug)
+			{
+			}
+			
+		public:
+			virtual void write(const lg::log_entry&) override
+			{
+			}
+	};
+	
+	// Log entries that are ready to be written, like the ones a dispatch lane receives.
+	// Their messages read "Entry <index>". An empty tag leaves the entries untagged.
+	class prepared_entries
+	{
+		public:
+			prepared_entries(::std::size_t p_count, const ::std::string& p_tag)
+			{
+				m_Entries.reserve(p_count);
+				
+				for(::std::size_t t_i = 0; t_i < p_count; ++t_i)
+				{
+					lg::log_entry t_entry{ LOG_SITE_BASE(info, bright_white, false) };
+					
+					if(!p_tag.empty())
+						::std::move(t_entry) << lg::tag(p_tag);
+						
+					::std::move(t_entry) << "Entry " << t_i;
+					t_entry.prepare();
+					
+					m_Entries.push_back(::std::move(t_entry));
+				}
+				
+				for(const auto& t_entry : m_Entries)
+					m_Pointers.push_back(&t_entry);
+			}
+			
+		public:
+			auto size() const
+				-> ::std::size_t
+			{
+				return m_Entries.size();
+			}
+			
+			auto span(::std::size_t p_offset, ::std::size_t p_count) const
+				-> lg::entry_span
+			{
+				return { m_Pointers.data() + p_offset, ::std::min(p_count, m_Pointers.size() - p_offset) };
+			}
+			
+			// Write all entries to given target in batches of given size
+			auto feed(lg::log_target& p_target, ::std::size_t p_batchSize) const
+				-> void
+			{
+				for(::std::size_t t_i = 0; t_i < size(); t_i += p_batchSize)
+					p_target.write_batch(span(t_i, p_batchSize));
+			}
+			
+		private:
+			::std::vector<lg::log_entry> m_Entries;
+			::std::vector<const lg::log_entry*> m_Pointers;
+	};
+}
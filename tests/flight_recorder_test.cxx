@@ -0,0 +1,147 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// The crash handler of the flight recorder has to dump it even if the crashing thread
+// overflowed its stack, which requires an alternate signal stack.
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <thread>
+#include <fstream>
+#include <iterator>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <log.hxx>
+
+#include "check.hxx"
+
+namespace
+{
+	const char* const g_dump = "flight_recorder_test.dump";
+	
+	// Far more than any stack can hold. Being volatile, the compiler can not prove the
+	// recursion below to be infinite.
+	volatile ::std::size_t g_depth = ~::std::size_t{0};
+	
+	// Overflows the stack. The volatile buffer keeps the compiler from turning this into a loop.
+	auto overflow(::std::size_t p_depth)
+		-> ::std::size_t
+	{
+		volatile char t_buffer[1024];
+		t_buffer[0] = static_cast<char>(p_depth);
+		
+		if(p_depth >= g_depth)
+			return t_buffer[0];
+		
+		return overflow(p_depth + 1) + t_buffer[0];
+	}
+	
+	// Record an entry and install the crash handler in a child process, which is then crashed
+	// by given function. Returns the wait status of the child.
+	template< typename F >
+	auto crash(F&& p_crash)
+		-> int
+	{
+		::std::remove(g_dump);
+		
+		const auto t_pid = ::fork();
+		
+		if(t_pid == 0)
+		{
+			lg::flight_recorder_target t_recorder{ 4096, g_dump };
+			
+			auto t_entry = lg::log_entry(LOG_SITE_BASE(info, bright_white, false)) << "last words";
+			t_entry.prepare();
+			t_recorder.record(t_entry);
+			
+			t_recorder.install_crash_handler();
+			p_crash();
+			::_exit(0);
+		}
+		
+		int t_status{ };
+		::waitpid(t_pid, &t_status, 0);
+		return t_status;
+	}
+	
+	auto dumped_messages()
+		-> ::std::vector<::std::string>
+	{
+		::std::ifstream t_in{ g_dump, ::std::ios_base::binary };
+		const ::std::string t_data{ ::std::istreambuf_iterator<char>{ t_in }, ::std::istreambuf_iterator<char>{ } };
+		::std::remove(g_dump);
+		
+		::std::vector<lg::decoded_record> t_records{ };
+		lg::read_flight_records(t_data.data(), t_data.size(), t_records);
+		
+		::std::vector<::std::string> t_messages{ };
+		
+		for(const auto& t_record : t_records)
+			t_messages.push_back(t_record.m_Message);
+			
+		return t_messages;
+	}
+}
+
+int main()
+{
+	// Records with overlong strings have to be truncated to fit into a small buffer
+	{
+		const ::std::string t_file(0x10000, 'f');
+		const ::std::string t_tag(0x10000, 't');
+		const ::std::string t_message(0x10000, 'm');
+		const lg::call_site t_site{ t_file.c_str(), 1, lg::severity_level::info, ut::console_color::bright_white, false };
+		
+		lg::flight_recorder_target t_recorder{ 4096, g_dump };
+		
+		for(::std::size_t t_i = 0; t_i < 16; ++t_i)
+		{
+			auto t_entry = lg::log_entry{ &t_site } << lg::tag(t_tag) << t_message;
+			t_entry.prepare();
+			t_recorder.record(t_entry);
+		}
+		
+		CHECK(t_recorder.dump());
+		
+		const auto t_messages = dumped_messages();
+		CHECK(t_messages.size() >= 3);
+		
+		for(const auto& t_msg : t_messages)
+			CHECK(!t_msg.empty() && t_msg.size() < 4096 / 4 && t_msg.find_first_not_of('m') == ::std::string::npos);
+	}
+	
+	// The default action takes place after dumping
+	const auto t_status = crash([]() { overflow(0); });
+	
+	CHECK(WIFSIGNALED(t_status) && WTERMSIG(t_status) == SIGSEGV);
+	CHECK(dumped_messages() == ::std::vector<::std::string>{ "last words" });
+	
+	// Other threads have to register their own alternate stack
+	const auto t_thread = crash([]()
+	{
+		::std::thread{ []()
+		{
+			lg::flight_recorder_target::install_signal_stack();
+			overflow(0);
+		} }.join();
+	});
+	
+	CHECK(WIFSIGNALED(t_thread) && WTERMSIG(t_thread) == SIGSEGV);
+	CHECK(dumped_messages() == ::std::vector<::std::string>{ "last words" });
+	
+	return test::result();
+}
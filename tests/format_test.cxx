@@ -0,0 +1,112 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Deferred formatting has to produce the same text as formatting right away, no matter
+// how long the format string and the arguments live after the call.
+
+#include <mutex>
+#include <vector>
+#include <string>
+#include <log.hxx>
+
+#include "check.hxx"
+
+namespace
+{
+	// Records the messages of all entries
+	class collecting_target
+		: public lg::log_target
+	{
+		public:
+			collecting_target()
+				: log_target(lg::severity_level::debug)
+			{
+			}
+			
+		public:
+			virtual void write(const lg::log_entry& p_entry) override
+			{
+				::std::lock_guard<::std::mutex> t_lock{ m_Mutex };
+				m_Messages.push_back(p_entry.message());
+			}
+			
+			auto messages()
+				-> ::std::vector<::std::string>
+			{
+				::std::lock_guard<::std::mutex> t_lock{ m_Mutex };
+				return m_Messages;
+			}
+			
+		private:
+			::std::mutex m_Mutex;
+			::std::vector<::std::string> m_Messages;
+	};
+	
+	// Format with a local format string that is overwritten as soon as the call returns
+	auto local_format()
+		-> lg::deferred_format
+	{
+		char t_fmt[] = "Local %s and %s";
+		const char (&t_const)[sizeof(t_fmt)] = t_fmt;
+		
+		auto t_result = lg::format(t_const, 42, "text");
+		
+		t_fmt[0] = 'X';
+		return t_result;
+	}
+	
+	auto string_format()
+		-> lg::deferred_format
+	{
+		::std::string t_fmt{ "String %s" };
+		::std::string t_arg{ "argument" };
+		
+		auto t_result = lg::format(t_fmt, t_arg);
+		
+		t_fmt.assign(t_fmt.length(), 'X');
+		t_arg.assign(t_arg.length(), 'X');
+		return t_result;
+	}
+}
+
+int main()
+{
+	const auto t_local = local_format();
+	CHECK(t_local.deferred());
+	CHECK(t_local.str() == "Local 42 and text");
+	
+	const auto t_string = string_format();
+	CHECK(t_string.deferred());
+	CHECK(t_string.str() == "String argument");
+	
+	// Does not fit into the capture buffer and thus is formatted right away
+	const ::std::string t_long(LIBLOG_DEFERRED_BUFFER_SIZE, 'x');
+	const auto t_overflow = lg::format("Long %s", t_long);
+	CHECK(!t_overflow.deferred());
+	CHECK(t_overflow.str() == "Long " + t_long);
+	
+	// Entries are rendered on the worker thread
+	static collecting_target t_target{ };
+	lg::logger::add_target(&t_target);
+	
+	LOG_I() << local_format() << " and " << lg::format("%s", 3);
+	lg::logger::flush();
+	
+	const auto t_messages = t_target.messages();
+	CHECK(t_messages.size() == 1 && t_messages.front() == "Local 42 and text and 3");
+	
+	lg::logger::shutdown();
+	return test::result();
+}
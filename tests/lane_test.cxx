@@ -0,0 +1,53 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Anonymous lanes of a dispatch pool must never be handed out for two targets at once,
+// even if the first target was not added yet.
+
+#include <log.hxx>
+#include <log/dispatch_lane.hxx>
+
+#include "check.hxx"
+#include "fixtures.hxx"
+
+int main()
+{
+	// Lanes keep using their targets until the pool is destroyed
+	test::null_target t_target{ };
+	lg::dispatch_pool t_pool{ };
+	const lg::lane_options t_options{ };
+	
+	// Neither target was added yet, like with two loggers adding targets concurrently
+	auto& t_first = t_pool.lane("", t_options);
+	auto& t_second = t_pool.lane("", t_options);
+	
+	CHECK(&t_first != &t_second);
+	CHECK(t_first.target_count() == 1 && t_second.target_count() == 1);
+	
+	t_first.add_target(&t_target, 1);
+	t_second.add_target(&t_target, 2);
+	
+	// Idle lanes are reused
+	CHECK(t_first.remove_target(&t_target, 1));
+	CHECK(&t_pool.lane("", t_options) == &t_first);
+	t_first.add_target(&t_target, 1);
+	
+	// Named lanes are shared
+	auto& t_named = t_pool.lane("named", t_options);
+	CHECK(&t_pool.lane("named", t_options) == &t_named);
+	CHECK(t_named.target_count() == 2);
+	
+	return test::result();
+}
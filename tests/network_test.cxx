@@ -0,0 +1,257 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Entries sent by network_target and async_network_target to a loopback collector
+// have to arrive completely and in order, using every protocol version.
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <log.hxx>
+#include <log/protocol_decoder.hxx>
+
+#include "check.hxx"
+#include "fixtures.hxx"
+
+namespace
+{
+	const ::std::size_t g_entries = 20000;
+	const ::std::size_t g_batchSize = 256;
+	
+	// Loopback server that accepts one connection and decodes everything it receives
+	class loopback_collector
+	{
+		public:
+			loopback_collector(lg::protocol_version p_version)
+				: m_Decoder{p_version}
+			{
+				m_Listener = ::socket(AF_INET, SOCK_STREAM, 0);
+				
+				sockaddr_in t_addr{ };
+				t_addr.sin_family = AF_INET;
+				t_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+				t_addr.sin_port = 0;
+				
+				socklen_t t_len = sizeof(t_addr);
+				::bind(m_Listener, reinterpret_cast<sockaddr*>(&t_addr), sizeof(t_addr));
+				::listen(m_Listener, 1);
+				::getsockname(m_Listener, reinterpret_cast<sockaddr*>(&t_addr), &t_len);
+				
+				m_Port = ::std::to_string(ntohs(t_addr.sin_port));
+				
+				m_Thread = ::std::thread{ [this]()
+				{
+					const int t_conn = ::accept(m_Listener, nullptr, nullptr);
+					char t_buffer[64 * 1024];
+					lg::decoded_record t_record{ };
+					
+					while(true)
+					{
+						const auto t_read = ::read(t_conn, t_buffer, sizeof(t_buffer));
+						
+						if(t_read <= 0)
+							break;
+							
+						try
+						{
+							m_Decoder.feed(t_buffer, static_cast<::std::size_t>(t_read));
+							
+							while(m_Decoder.next(t_record))
+								m_Messages.push_back(t_record.m_Message);
+						}
+						catch(const ::std::exception&)
+						{
+							m_Malformed = true;
+							break;
+						}
+					}
+					
+					::close(t_conn);
+				}};
+			}
+			
+			~loopback_collector()
+			{
+				if(m_Thread.joinable())
+					m_Thread.join();
+					
+				::close(m_Listener);
+			}
+			
+		public:
+			auto port() const
+				-> const ::std::string&
+			{
+				return m_Port;
+			}
+			
+			// Wait until the connection was closed and check the received messages
+			auto check()
+				-> void
+			{
+				m_Thread.join();
+				
+				CHECK(!m_Malformed);
+				CHECK(m_Decoder.pending() == 0);
+				CHECK(m_Messages.size() == g_entries);
+				
+				bool t_ordered{true};
+				
+				for(::std::size_t t_i = 0; t_i < m_Messages.size(); ++t_i)
+					t_ordered = t_ordered && m_Messages[t_i] == "Entry " + ::std::to_string(t_i);
+					
+				CHECK(t_ordered);
+			}
+			
+		private:
+			int m_Listener{-1};
+			::std::string m_Port;
+			lg::protocol_decoder m_Decoder;
+			::std::vector<::std::string> m_Messages;
+			bool m_Malformed{false};
+			::std::thread m_Thread;
+	};
+	
+	auto protocol(lg::protocol_version p_version, bool p_compress)
+		-> lg::protocol_options
+	{
+		lg::protocol_options t_options{ };
+		t_options.m_Version = p_version;
+		t_options.m_Compress = p_compress;
+		return t_options;
+	}
+	
+	auto test_blocking(const test::prepared_entries& p_entries, const lg::protocol_options& p_protocol)
+		-> void
+	{
+		loopback_collector t_collector{ p_protocol.m_Version };
+		
+		{
+			lg::network_target t_target{ lg::severity_level::debug, "127.0.0.1", t_collector.port(), "test", p_protocol };
+			p_entries.feed(t_target, g_batchSize);
+		}
+		
+		t_collector.check();
+	}
+	
+	auto test_async(const test::prepared_entries& p_entries, const lg::protocol_options& p_protocol)
+		-> void
+	{
+		loopback_collector t_collector{ p_protocol.m_Version };
+		
+		lg::async_network_options t_options{ };
+		t_options.m_Protocol = p_protocol;
+		t_options.m_MaxBufferedBytes = 64u << 20;
+		t_options.m_ShutdownTimeout = ::std::chrono::seconds{10};
+		
+		{
+			lg::async_network_target t_target{ lg::severity_level::debug, "127.0.0.1", t_collector.port(), "test", t_options };
+			
+			// Flushing does not wait while there is no connection
+			while(!t_target.connected())
+				::std::this_thread::yield();
+				
+			p_entries.feed(t_target, g_batchSize);
+			t_target.flush();
+			
+			CHECK(t_target.dropped() == 0);
+			CHECK(t_target.buffered() == 0);
+		}
+		
+		t_collector.check();
+	}
+	
+	// Entries logged through the logger, which hands them to the target on a dispatch lane
+	auto test_logger()
+		-> void
+	{
+		loopback_collector t_collector{ lg::protocol_version::v2 };
+		
+		{
+			lg::network_target t_target{ lg::severity_level::debug, "127.0.0.1", t_collector.port(), "test", protocol(lg::protocol_version::v2, true) };
+			lg::logger::add_target(&t_target);
+			
+			for(::std::size_t t_i = 0; t_i < g_entries; ++t_i)
+				LOG_I() << "Entry " << t_i;
+				
+			lg::logger::flush();
+			CHECK(lg::logger::remove_target(&t_target));
+		}
+		
+		t_collector.check();
+	}
+	
+	// Port on the loopback interface nobody listens on
+	auto unused_port()
+		-> ::std::string
+	{
+		const int t_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+		
+		sockaddr_in t_addr{ };
+		t_addr.sin_family = AF_INET;
+		t_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		t_addr.sin_port = 0;
+		
+		socklen_t t_len = sizeof(t_addr);
+		::bind(t_socket, reinterpret_cast<sockaddr*>(&t_addr), sizeof(t_addr));
+		::getsockname(t_socket, reinterpret_cast<sockaddr*>(&t_addr), &t_len);
+		::close(t_socket);
+		
+		return ::std::to_string(ntohs(t_addr.sin_port));
+	}
+	
+	// Without a server, an asynchronous target drops what exceeds its buffer and counts it
+	auto test_unreachable(const test::prepared_entries& p_entries)
+		-> void
+	{
+		const auto t_port = unused_port();
+		
+		lg::async_network_options t_options{ };
+		t_options.m_MaxBufferedBytes = 64u << 10;
+		t_options.m_ChunkSize = 16u << 10;
+		t_options.m_ShutdownTimeout = ::std::chrono::milliseconds{0};
+		
+		lg::async_network_target t_target{ lg::severity_level::debug, "127.0.0.1", t_port, "test", t_options };
+		p_entries.feed(t_target, g_batchSize);
+		
+		CHECK(!t_target.connected());
+		CHECK(t_target.dropped() > 0);
+		CHECK(t_target.buffered() <= t_options.m_MaxBufferedBytes);
+	}
+}
+
+int main()
+{
+	const test::prepared_entries t_entries{ g_entries, "test" };
+	
+	test_blocking(t_entries, protocol(lg::protocol_version::v1, false));
+	test_blocking(t_entries, protocol(lg::protocol_version::v2, false));
+	test_blocking(t_entries, protocol(lg::protocol_version::v2, true));
+	
+	test_async(t_entries, protocol(lg::protocol_version::v1, false));
+	test_async(t_entries, protocol(lg::protocol_version::v2, false));
+	test_async(t_entries, protocol(lg::protocol_version::v2, true));
+	
+	test_logger();
+	test_unreachable(t_entries);
+	
+	lg::logger::shutdown();
+	return test::result();
+}
@@ -0,0 +1,275 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Datagrams sent by unix_datagram_target to a local receiver have to arrive in order,
+// and every entry that did not arrive has to be counted as dropped.
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/socket.h>
+#include <log.hxx>
+#include <log/protocol_decoder.hxx>
+
+#include "check.hxx"
+#include "fixtures.hxx"
+
+namespace
+{
+	// More entries than a single sendmmsg call takes
+	const ::std::size_t g_entries = 5000;
+	
+	const char* const g_path = "unix_datagram_test.sock";
+	
+	// Receiver bound to a UNIX datagram socket. Every datagram is decoded on its own.
+	class local_receiver
+	{
+		public:
+			local_receiver(lg::protocol_version p_version)
+				: m_Version{p_version}
+			{
+				::unlink(g_path);
+				m_Socket = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+				
+				sockaddr_un t_addr{ };
+				t_addr.sun_family = AF_UNIX;
+				::std::strncpy(t_addr.sun_path, g_path, sizeof(t_addr.sun_path) - 1);
+				
+				::bind(m_Socket, reinterpret_cast<sockaddr*>(&t_addr), sizeof(t_addr));
+			}
+			
+			~local_receiver()
+			{
+				stop();
+				::close(m_Socket);
+				::unlink(g_path);
+			}
+			
+		public:
+			// Receive on a background thread
+			auto start()
+				-> void
+			{
+				m_Thread = ::std::thread{ [this](){ receive(0); } };
+			}
+			
+			// Wait until given number of datagrams arrived
+			auto wait(::std::uint64_t p_datagrams)
+				-> void
+			{
+				const auto t_deadline = ::std::chrono::steady_clock::now() + ::std::chrono::seconds{10};
+			
+				while(m_Datagrams.load() < p_datagrams && ::std::chrono::steady_clock::now() < t_deadline)
+					::std::this_thread::yield();
+			}
+			
+			// Stop the background thread, if any
+			auto stop()
+				-> void
+			{
+				if(m_Thread.joinable())
+				{
+					::shutdown(m_Socket, SHUT_RDWR);
+					m_Thread.join();
+				}
+			}
+			
+			// Take all datagrams that are still queued, without waiting
+			auto drain()
+				-> void
+			{
+				receive(MSG_DONTWAIT);
+			}
+			
+			auto datagrams() const
+				-> ::std::uint64_t
+			{
+				return m_Datagrams.load();
+			}
+			
+			// Numbers of the received entries
+			auto received() const
+				-> const ::std::vector<::std::size_t>&
+			{
+				return m_Received;
+			}
+			
+			auto malformed() const
+				-> bool
+			{
+				return m_Malformed;
+			}
+			
+		private:
+			auto receive(int p_flags)
+				-> void
+			{
+				::std::vector<char> t_buffer(1u << 20);
+				lg::decoded_record t_record{ };
+				
+				while(true)
+				{
+					const auto t_read = ::recv(m_Socket, t_buffer.data(), t_buffer.size(), p_flags);
+					
+					if(t_read <= 0)
+						break;
+						
+					lg::protocol_decoder t_decoder{m_Version};
+					
+					try
+					{
+						t_decoder.feed(t_buffer.data(), static_cast<::std::size_t>(t_read));
+						
+						while(t_decoder.next(t_record))
+							m_Received.push_back(::std::strtoul(t_record.m_Message.c_str() + 6, nullptr, 10));
+					}
+					catch(const ::std::exception&)
+					{
+						m_Malformed = true;
+					}
+					
+					m_Malformed = m_Malformed || t_decoder.pending() > 0;
+					++m_Datagrams;
+				}
+			}
+			
+		private:
+			lg::protocol_version m_Version;
+			int m_Socket{-1};
+			::std::vector<::std::size_t> m_Received;
+			::std::atomic<::std::uint64_t> m_Datagrams{0};
+			bool m_Malformed{false};
+			::std::thread m_Thread;
+	};
+	
+	auto options(lg::protocol_version p_version, bool p_nonBlocking)
+		-> lg::unix_datagram_options
+	{
+		lg::unix_datagram_options t_options{ };
+		t_options.m_Protocol.m_Version = p_version;
+		t_options.m_NonBlocking = p_nonBlocking;
+		
+		// Small frames, so that v2 needs many datagrams as well
+		t_options.m_Protocol.m_MaxFrameSize = 512;
+		return t_options;
+	}
+	
+	auto ordered(const ::std::vector<::std::size_t>& p_received)
+		-> bool
+	{
+		for(::std::size_t t_i = 1; t_i < p_received.size(); ++t_i)
+		{
+			if(p_received[t_i] <= p_received[t_i - 1])
+				return false;
+		}
+		
+		return true;
+	}
+	
+	// A blocking target waits for the receiver, so nothing is lost
+	auto test_blocking(const test::prepared_entries& p_entries, lg::protocol_version p_version)
+		-> void
+	{
+		local_receiver t_receiver{ p_version };
+		t_receiver.start();
+		
+		lg::unix_datagram_target t_target{ lg::severity_level::debug, g_path, "test", options(p_version, false) };
+		CHECK(t_target.connected());
+		
+		// A single batch, which takes multiple sendmmsg calls
+		t_target.write_batch(p_entries.span(0, g_entries));
+		
+		t_receiver.wait(t_target.sent());
+		t_receiver.stop();
+		
+		CHECK(t_target.dropped() == 0);
+		CHECK(t_receiver.datagrams() == t_target.sent());
+		CHECK(!t_receiver.malformed());
+		CHECK(t_receiver.received().size() == g_entries);
+		CHECK(ordered(t_receiver.received()));
+	}
+	
+	// A non-blocking target drops what a stalled receiver has no room for
+	auto test_stalled(const test::prepared_entries& p_entries, lg::protocol_version p_version)
+		-> void
+	{
+		local_receiver t_receiver{ p_version };
+		
+		lg::unix_datagram_target t_target{ lg::severity_level::debug, g_path, "test", options(p_version, true) };
+		
+		for(::std::size_t t_i = 0; t_i < g_entries; t_i += 256)
+			t_target.write_batch(p_entries.span(t_i, 256));
+			
+		t_receiver.drain();
+		
+		// A full receive queue does not close the connection
+		CHECK(t_target.connected());
+		CHECK(t_target.dropped() > 0);
+		CHECK(t_receiver.datagrams() == t_target.sent());
+		CHECK(!t_receiver.malformed());
+		CHECK(t_receiver.received().size() + t_target.dropped() == g_entries);
+		CHECK(ordered(t_receiver.received()));
+	}
+	
+	// Entries are dropped while the receiver is absent, and delivered once it appeared
+	auto test_absent(const test::prepared_entries& p_entries)
+		-> void
+	{
+		::unlink(g_path);
+		
+		auto t_options = options(lg::protocol_version::v1, true);
+		t_options.m_RetryInterval = ::std::chrono::milliseconds{50};
+		
+		lg::unix_datagram_target t_target{ lg::severity_level::debug, g_path, "test", t_options };
+		
+		CHECK(!t_target.connected());
+		t_target.write_batch(p_entries.span(0, 10));
+		CHECK(t_target.dropped() == 10);
+		
+		local_receiver t_receiver{ lg::protocol_version::v1 };
+		::std::this_thread::sleep_for(::std::chrono::milliseconds{100});
+		
+		t_target.write_batch(p_entries.span(10, 10));
+		t_receiver.drain();
+		
+		CHECK(t_target.connected());
+		CHECK(t_target.dropped() == 10);
+		CHECK(t_receiver.received().size() == 10);
+	}
+}
+
+int main()
+{
+	const test::prepared_entries t_entries{ g_entries, "" };
+	
+	test_blocking(t_entries, lg::protocol_version::v1);
+	test_blocking(t_entries, lg::protocol_version::v2);
+	
+	test_stalled(t_entries, lg::protocol_version::v1);
+	test_stalled(t_entries, lg::protocol_version::v2);
+	
+	test_absent(t_entries);
+	
+	// Construction only fails because of an invalid path, never because of an absent receiver
+	CHECK_THROWS(::std::runtime_error, lg::unix_datagram_target(lg::severity_level::debug, ::std::string(200, 'x')));
+	
+	return test::result();
+}
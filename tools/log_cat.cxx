@@ -0,0 +1,227 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// log_cat: Prints the records of a binary log written by binary_file_target. Only the blocks
+// whose index record says they could contain matching records are read.
+// Usage: log_cat [--level <level>] [--tag <tag>]... [--since <time>] [--until <time>]
+//                [--format default|clang|json] [--stats] <file>
+// Times are either seconds since epoch or local time given as "YYYY-MM-DD HH:MM:SS".
+// Records are rendered using the formatters of the library, at microsecond precision.
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <iostream>
+#include <stdexcept>
+#include <log/binary_log_reader.hxx>
+#include <log/default_formatter.hxx>
+#include <log/clang_formatter.hxx>
+#include <log/json_formatter.hxx>
+#include <log/log_entry.hxx>
+
+namespace
+{
+	const char* const g_Levels[] = { "fatal", "error", "warning", "info", "debug" };
+	
+	// Colors the LOG_* macros use for each level
+	const ut::console_color g_Colors[] = {
+		ut::console_color::bright_red,
+		ut::console_color::bright_red,
+		ut::console_color::bright_yellow,
+		ut::console_color::bright_white,
+		ut::console_color::bright_cyan
+	};
+	
+	auto parse_level(const char* p_str, lg::severity_level& p_lvl)
+		-> bool
+	{
+		for(int t_i = 0; t_i < 5; ++t_i)
+		{
+			if(::std::strcmp(p_str, g_Levels[t_i]) == 0)
+			{
+				p_lvl = static_cast<lg::severity_level>(t_i);
+				return true;
+			}
+		}
+		
+		return false;
+	}
+	
+	auto parse_time(const char* p_str, lg::timestamp& p_time)
+		-> bool
+	{
+		std::tm t_tm{ };
+		double t_seconds{ };
+		
+		if(::std::sscanf(p_str, "%d-%d-%d %d:%d:%lf", &t_tm.tm_year, &t_tm.tm_mon, &t_tm.tm_mday, &t_tm.tm_hour, &t_tm.tm_min, &t_seconds) == 6)
+		{
+			t_tm.tm_year -= 1900;
+			t_tm.tm_mon -= 1;
+			t_tm.tm_isdst = -1;
+			
+			const auto t_second = ::std::mktime(&t_tm);
+			
+			if(t_second == static_cast<::std::time_t>(-1))
+				return false;
+				
+			p_time = lg::timestamp{ static_cast<::std::int64_t>(t_second) * 1000000000 + static_cast<::std::int64_t>(t_seconds * 1e9) };
+			return true;
+		}
+		
+		char* t_end{nullptr};
+		t_seconds = ::std::strtod(p_str, &t_end);
+		
+		if(t_end == p_str || *t_end != '\0')
+			return false;
+			
+		p_time = lg::timestamp{ static_cast<::std::int64_t>(t_seconds * 1e9) };
+		return true;
+	}
+	
+	// Convert decoded record back into a log entry, which the formatters can handle
+	template< typename Tformat >
+	auto print(Tformat& p_format, const lg::decoded_record& p_record)
+		-> void
+	{
+		const auto t_lvl = static_cast<int>(p_record.m_Level);
+		const lg::call_site t_site{ p_record.m_File.c_str(), static_cast<::std::size_t>(p_record.m_Line), p_record.m_Level, g_Colors[t_lvl], p_record.m_Bare };
+		
+		lg::log_entry t_entry{ &t_site, p_record.m_Time, p_record.m_ThreadId };
+		
+		if(!p_record.m_Tag.empty())
+			::std::move(t_entry) << lg::tag(p_record.m_Tag);
+			
+		::std::move(t_entry) << p_record.m_Message;
+		
+		for(const auto& t_field : p_record.m_Fields)
+		{
+			const auto* t_key = t_field.m_Key.c_str();
+		
+			switch(t_field.m_Type)
+			{
+				case lg::field_type::boolean:
+					::std::move(t_entry) << lg::kv(t_key, t_field.m_Bool);
+					break;
+					
+				case lg::field_type::signed_integer:
+					::std::move(t_entry) << lg::kv(t_key, t_field.m_Signed);
+					break;
+					
+				case lg::field_type::unsigned_integer:
+					::std::move(t_entry) << lg::kv(t_key, t_field.m_Unsigned);
+					break;
+					
+				case lg::field_type::floating_point:
+					::std::move(t_entry) << lg::kv(t_key, t_field.m_Double);
+					break;
+					
+				case lg::field_type::string:
+					::std::move(t_entry) << lg::kv(t_key, t_field.m_String);
+					break;
+			}
+		}
+		
+		p_format(::std::cout, t_entry);
+	}
+	
+	template< typename Tformat >
+	auto run(lg::binary_log_reader& p_reader, const lg::log_query& p_query, Tformat p_format)
+		-> lg::query_stats
+	{
+		return p_reader.query(p_query, [&p_format](const lg::decoded_record& p_record)
+		{
+			print(p_format, p_record);
+		});
+	}
+	
+	auto usage()
+		-> int
+	{
+		::std::fprintf(stderr, "Usage: log_cat [--level <level>] [--tag <tag>]... [--since <time>] [--until <time>] [--format default|clang|json] [--stats] <file>\n");
+		return 1;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	lg::log_query t_query{ };
+	::std::string t_format{"default"};
+	const char* t_path{nullptr};
+	bool t_stats{false};
+	
+	for(int t_i = 1; t_i < argc; ++t_i)
+	{
+		const bool t_hasValue = (t_i + 1 < argc);
+	
+		if(::std::strcmp(argv[t_i], "--level") == 0 && t_hasValue)
+		{
+			if(!parse_level(argv[++t_i], t_query.m_Level))
+				return usage();
+		}
+		else if(::std::strcmp(argv[t_i], "--tag") == 0 && t_hasValue)
+			t_query.m_Tags.push_back(argv[++t_i]);
+		else if(::std::strcmp(argv[t_i], "--since") == 0 && t_hasValue)
+		{
+			if(!parse_time(argv[++t_i], t_query.m_Since))
+				return usage();
+		}
+		else if(::std::strcmp(argv[t_i], "--until") == 0 && t_hasValue)
+		{
+			if(!parse_time(argv[++t_i], t_query.m_Until))
+				return usage();
+		}
+		else if(::std::strcmp(argv[t_i], "--format") == 0 && t_hasValue)
+			t_format = argv[++t_i];
+		else if(::std::strcmp(argv[t_i], "--stats") == 0)
+			t_stats = true;
+		else if(argv[t_i][0] != '-' && t_path == nullptr)
+			t_path = argv[t_i];
+		else return usage();
+	}
+	
+	if(t_path == nullptr)
+		return usage();
+	
+	try
+	{
+		lg::binary_log_reader t_reader{ t_path };
+		lg::query_stats t_result{ };
+		
+		if(t_format == "default")
+			t_result = run(t_reader, t_query, lg::default_formatter{ lg::time_precision::microseconds });
+		else if(t_format == "clang")
+			t_result = run(t_reader, t_query, lg::clang_formatter{ });
+		else if(t_format == "json")
+			t_result = run(t_reader, t_query, lg::json_formatter{ });
+		else return usage();
+		
+		::std::cout.flush();
+		
+		if(t_stats)
+		{
+			::std::fprintf(stderr, "log_cat: %zu matches, read %zu of %zu blocks, %llu bytes (%llu unindexed)\n",
+				static_cast<::std::size_t>(t_result.m_Matches), t_result.m_BlocksRead, t_result.m_Blocks,
+				static_cast<unsigned long long>(t_result.m_BytesRead), static_cast<unsigned long long>(t_result.m_Unindexed));
+		}
+	}
+	catch(const ::std::exception& p_ex)
+	{
+		::std::fprintf(stderr, "log_cat: %s\n", p_ex.what());
+		return 1;
+	}
+	
+	return 0;
+}
@@ -0,0 +1,232 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// log_decode: Prints log records captured from a network target connection.
+// Usage: log_decode [--v1] [file]
+//        log_decode [--v1] [--seqpacket] --unix <path>
+// Reads from standard input if no file is given. With --unix, a socket is created at
+// given path and the datagrams sent by a unix_datagram_target are printed as they arrive.
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <log/protocol_decoder.hxx>
+
+#if !defined(_WIN32)
+#	include <vector>
+#	include <unistd.h>
+#	include <sys/un.h>
+#	include <sys/socket.h>
+#endif
+
+namespace
+{
+	const char* const g_Levels[] = { "Fatal", "Error", "Warning", "Info", "Debug" };
+
+	auto print(const lg::decoded_record& p_record)
+		-> void
+	{
+		char t_time[lg::time_buffer_size];
+		lg::format_time(p_record.m_Time, lg::time_precision::microseconds, t_time);
+		
+		::std::printf("[%s] [%u] [%s]", t_time, p_record.m_ThreadId, g_Levels[static_cast<int>(p_record.m_Level)]);
+		
+		if(!p_record.m_File.empty())
+			::std::printf(" (%s:%llu)", p_record.m_File.c_str(), static_cast<unsigned long long>(p_record.m_Line));
+			
+		if(!p_record.m_Source.empty())
+			::std::printf(" %s", p_record.m_Source.c_str());
+			
+		if(!p_record.m_Tag.empty())
+			::std::printf(" <%s>", p_record.m_Tag.c_str());
+			
+		::std::printf(" %s", p_record.m_Message.c_str());
+		
+		for(const auto& t_field : p_record.m_Fields)
+		{
+			::std::printf(" %s=", t_field.m_Key.c_str());
+			
+			switch(t_field.m_Type)
+			{
+				case lg::field_type::boolean:
+					::std::printf("%s", t_field.m_Bool ? "true" : "false");
+					break;
+					
+				case lg::field_type::signed_integer:
+					::std::printf("%lld", static_cast<long long>(t_field.m_Signed));
+					break;
+					
+				case lg::field_type::unsigned_integer:
+					::std::printf("%llu", static_cast<unsigned long long>(t_field.m_Unsigned));
+					break;
+					
+				case lg::field_type::floating_point:
+					::std::printf("%g", t_field.m_Double);
+					break;
+					
+				case lg::field_type::string:
+					::std::printf("%s", t_field.m_String.c_str());
+					break;
+			}
+		}
+		
+		::std::printf("\n");
+	}
+	
+#if !defined(_WIN32)
+	// Receive datagrams on a socket bound to given path until interrupted. Every datagram
+	// contains complete packets or frames, so a lost one does not affect the others.
+	auto receive(const char* p_path, bool p_seqPacket, lg::protocol_version p_version)
+		-> int
+	{
+		::sockaddr_un t_addr{ };
+		
+		if(::std::strlen(p_path) >= sizeof(t_addr.sun_path))
+		{
+			::std::fprintf(stderr, "log_decode: Socket path too long\n");
+			return 1;
+		}
+		
+		t_addr.sun_family = AF_UNIX;
+		::std::strcpy(t_addr.sun_path, p_path);
+		::unlink(p_path);
+		
+		const int t_socket = ::socket(AF_UNIX, p_seqPacket ? SOCK_SEQPACKET : SOCK_DGRAM, 0);
+		
+		if(t_socket < 0
+			|| ::bind(t_socket, reinterpret_cast<const ::sockaddr*>(&t_addr), sizeof(t_addr)) != 0
+			|| (p_seqPacket && ::listen(t_socket, 1) != 0))
+		{
+			::std::fprintf(stderr, "log_decode: Failed to bind \"%s\": %s\n", p_path, ::std::strerror(errno));
+			return 1;
+		}
+		
+		lg::decoded_record t_record{ };
+		::std::vector<char> t_buffer(1u << 20);
+		
+		while(true)
+		{
+			// A sequenced packet socket serves one sender at a time
+			const int t_conn = p_seqPacket ? ::accept(t_socket, nullptr, nullptr) : t_socket;
+			
+			if(t_conn < 0)
+				continue;
+				
+			while(true)
+			{
+				const auto t_read = ::recv(t_conn, t_buffer.data(), t_buffer.size(), 0);
+				
+				if(t_read < 0 && errno == EINTR)
+					continue;
+					
+				if(t_read <= 0)
+					break;
+					
+				// Decoding starts over with every datagram
+				lg::protocol_decoder t_decoder{p_version};
+				
+				try
+				{
+					t_decoder.feed(t_buffer.data(), static_cast<::std::size_t>(t_read));
+					
+					while(t_decoder.next(t_record))
+						print(t_record);
+				}
+				catch(const ::std::exception& p_ex)
+				{
+					::std::fprintf(stderr, "log_decode: %s\n", p_ex.what());
+				}
+				
+				if(t_decoder.pending() > 0)
+					::std::fprintf(stderr, "log_decode: Datagram ends with %zu bytes of incomplete data\n", t_decoder.pending());
+					
+				::std::fflush(stdout);
+			}
+			
+			if(!p_seqPacket)
+				break;
+				
+			::close(t_conn);
+		}
+		
+		::close(t_socket);
+		return 1;
+	}
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+	lg::protocol_version t_version{lg::protocol_version::v2};
+	const char* t_path{nullptr};
+	const char* t_socket{nullptr};
+	bool t_seqPacket{false};
+	
+	for(int t_i = 1; t_i < argc; ++t_i)
+	{
+		if(::std::strcmp(argv[t_i], "--v1") == 0)
+			t_version = lg::protocol_version::v1;
+		else if(::std::strcmp(argv[t_i], "--seqpacket") == 0)
+			t_seqPacket = true;
+		else if(::std::strcmp(argv[t_i], "--unix") == 0 && t_i + 1 < argc)
+			t_socket = argv[++t_i];
+		else t_path = argv[t_i];
+	}
+	
+	if(t_socket != nullptr)
+	{
+#if !defined(_WIN32)
+		return receive(t_socket, t_seqPacket, t_version);
+#else
+		::std::fprintf(stderr, "log_decode: UNIX sockets are not supported on this platform\n");
+		return 1;
+#endif
+	}
+	
+	::std::FILE* t_file = (t_path == nullptr) ? stdin : ::std::fopen(t_path, "rb");
+	
+	if(t_file == nullptr)
+	{
+		::std::fprintf(stderr, "log_decode: Failed to open \"%s\"\n", t_path);
+		return 1;
+	}
+	
+	lg::protocol_decoder t_decoder{t_version};
+	lg::decoded_record t_record{ };
+	char t_buffer[64 * 1024];
+	
+	try
+	{
+		while(const auto t_read = ::std::fread(t_buffer, 1, sizeof(t_buffer), t_file))
+		{
+			t_decoder.feed(t_buffer, t_read);
+			
+			while(t_decoder.next(t_record))
+				print(t_record);
+		}
+	}
+	catch(const ::std::exception& p_ex)
+	{
+		::std::fprintf(stderr, "log_decode: %s\n", p_ex.what());
+		return 1;
+	}
+	
+	if(t_decoder.pending() > 0)
+		::std::fprintf(stderr, "log_decode: Stream ends with %zu bytes of incomplete data\n", t_decoder.pending());
+	
+	return 0;
+}
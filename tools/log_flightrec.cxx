@@ -0,0 +1,81 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// log_flightrec: Prints the records of all flight recorders contained in a dump or core file.
+// Usage: log_flightrec <file>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <log/flight_recorder_target.hxx>
+
+namespace
+{
+	const char* const g_Levels[] = { "Fatal", "Error", "Warning", "Info", "Debug" };
+
+	auto print(const lg::decoded_record& p_record)
+		-> void
+	{
+		char t_time[lg::time_buffer_size];
+		lg::format_time(p_record.m_Time, lg::time_precision::microseconds, t_time);
+		
+		::std::printf("[%s] [%u] [%s] (%s:%llu)", t_time, p_record.m_ThreadId, g_Levels[static_cast<int>(p_record.m_Level)],
+			p_record.m_File.c_str(), static_cast<unsigned long long>(p_record.m_Line));
+			
+		if(!p_record.m_Tag.empty())
+			::std::printf(" <%s>", p_record.m_Tag.c_str());
+			
+		::std::printf(" %s\n", p_record.m_Message.c_str());
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc != 2)
+	{
+		::std::fprintf(stderr, "Usage: log_flightrec <file>\n");
+		return 1;
+	}
+
+	::std::FILE* t_file = ::std::fopen(argv[1], "rb");
+	
+	if(t_file == nullptr)
+	{
+		::std::fprintf(stderr, "log_flightrec: Failed to open \"%s\"\n", argv[1]);
+		return 1;
+	}
+	
+	::std::string t_data{ };
+	char t_buffer[64 * 1024];
+	
+	while(const auto t_read = ::std::fread(t_buffer, 1, sizeof(t_buffer), t_file))
+		t_data.append(t_buffer, t_read);
+		
+	::std::fclose(t_file);
+	
+	::std::vector<lg::decoded_record> t_records{ };
+	const auto t_found = lg::read_flight_records(t_data.data(), t_data.size(), t_records);
+	
+	if(t_found == 0)
+	{
+		::std::fprintf(stderr, "log_flightrec: No flight recorder found in \"%s\"\n", argv[1]);
+		return 1;
+	}
+	
+	for(const auto& t_record : t_records)
+		print(t_record);
+		
+	return 0;
+}
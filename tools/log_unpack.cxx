@@ -0,0 +1,155 @@
+/*
+	Copyright (c) 2016 nshcat
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute,
+	sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// log_unpack: Decompresses files written by compressed_file_target. Blocks before the
+// first requested one are skipped by only reading their headers.
+// Usage: log_unpack [--list] [--from <block>] [--count <blocks>] <file>
+// --list prints offset, compressed and uncompressed size of every block instead of its contents.
+// A block that is cut off, e.g. because the writer is still running, ends the output.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <log/lz_codec.hxx>
+
+namespace
+{
+	auto parse_count(const char* p_str, ::std::size_t& p_count)
+		-> bool
+	{
+		char* t_end{nullptr};
+		const auto t_value = ::std::strtoull(p_str, &t_end, 10);
+		
+		if(t_end == p_str || *t_end != '\0')
+			return false;
+			
+		p_count = static_cast<::std::size_t>(t_value);
+		return true;
+	}
+	
+	auto usage()
+		-> int
+	{
+		::std::fprintf(stderr, "Usage: log_unpack [--list] [--from <block>] [--count <blocks>] <file>\n");
+		return 1;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	::std::size_t t_from{0};
+	::std::size_t t_count{static_cast<::std::size_t>(-1)};
+	const char* t_path{nullptr};
+	bool t_list{false};
+	
+	for(int t_i = 1; t_i < argc; ++t_i)
+	{
+		const bool t_hasValue = (t_i + 1 < argc);
+	
+		if(::std::strcmp(argv[t_i], "--list") == 0)
+			t_list = true;
+		else if(::std::strcmp(argv[t_i], "--from") == 0 && t_hasValue)
+		{
+			if(!parse_count(argv[++t_i], t_from))
+				return usage();
+		}
+		else if(::std::strcmp(argv[t_i], "--count") == 0 && t_hasValue)
+		{
+			if(!parse_count(argv[++t_i], t_count))
+				return usage();
+		}
+		else if(argv[t_i][0] != '-' && t_path == nullptr)
+			t_path = argv[t_i];
+		else return usage();
+	}
+	
+	if(t_path == nullptr)
+		return usage();
+		
+	::std::ifstream t_file{ t_path, ::std::ios_base::in | ::std::ios_base::binary };
+	
+	if(!t_file)
+	{
+		::std::fprintf(stderr, "log_unpack: Could not open \"%s\"\n", t_path);
+		return 1;
+	}
+	
+	::std::stringstream t_contents{ };
+	t_contents << t_file.rdbuf();
+	const auto t_data = t_contents.str();
+	
+	try
+	{
+		::std::size_t t_offset{0};
+		::std::size_t t_block{0};
+		::std::string t_out{ };
+		
+		// Index of the first block after the requested ones
+		const auto t_last = (t_count > static_cast<::std::size_t>(-1) - t_from) ? static_cast<::std::size_t>(-1) : t_from + t_count;
+		
+		while(t_offset < t_data.size() && t_block < t_last)
+		{
+			const auto* t_ptr = t_data.data() + t_offset;
+			const auto t_len = t_data.size() - t_offset;
+			
+			lg::internal::lz_frame_info t_info{ };
+			
+			if(!lg::internal::lz_frame_inspect(t_ptr, t_len, t_info))
+			{
+				::std::fprintf(stderr, "log_unpack: Incomplete block at offset %zu\n", t_offset);
+				break;
+			}
+			
+			// Skippable frames do not count as blocks
+			if(!t_info.m_Skippable)
+			{
+				if(t_block >= t_from)
+				{
+					if(t_list)
+					{
+						::std::printf("%zu\t%zu\t%zu\t", t_block, t_offset, t_info.m_Size);
+						
+						if(t_info.m_HasContentSize)
+							::std::printf("%llu\n", static_cast<unsigned long long>(t_info.m_ContentSize));
+						else ::std::printf("?\n");
+					}
+					else
+					{
+						t_out.clear();
+						lg::internal::lz_frame_decompress(t_ptr, t_len, t_out);
+						::std::cout.write(t_out.data(), t_out.size());
+					}
+				}
+				
+				++t_block;
+			}
+			
+			t_offset += t_info.m_Size;
+		}
+	}
+	catch(const ::std::exception& p_ex)
+	{
+		::std::cout.flush();
+		::std::fprintf(stderr, "log_unpack: %s\n", p_ex.what());
+		return 1;
+	}
+	
+	return 0;
+}